@@ -11,6 +11,9 @@ SOURCES += ../libQtSpotify/qspotifysession.cpp \
     ../libQtSpotify/qspotifyplaylistcontainer.cpp \
     ../libQtSpotify/qspotifyplaylistsearchentry.cpp \
     ../libQtSpotify/qspotifytracklist.cpp \
+    ../libQtSpotify/qspotifytrackrecords.cpp \
+    ../libQtSpotify/qspotifystringpool.cpp \
+    ../libQtSpotify/qspotifyid.cpp \
     ../libQtSpotify/qspotifyartist.cpp \
     ../libQtSpotify/qspotifyalbum.cpp \
     ../libQtSpotify/qspotifyimageprovider.cpp \
@@ -23,9 +26,20 @@ SOURCES += ../libQtSpotify/qspotifysession.cpp \
     ../libQtSpotify/listmodels/tracklistfiltermodel.cpp \
     ../libQtSpotify/qspotifyaudiothreadworker.cpp \
     ../libQtSpotify/qspotifyevents.cpp \
+    ../libQtSpotify/qspotifyeventwatchdog.cpp \
+    ../libQtSpotify/qspotifytrace.cpp \
+    ../libQtSpotify/qspotifylogsink.cpp \
+    ../libQtSpotify/qspotifymetrics.cpp \
+    ../libQtSpotify/qspotifymemory.cpp \
+    ../libQtSpotify/qspotifystartuptimeline.cpp \
+    ../libQtSpotify/qspotifymetadatastore.cpp \
+    ../libQtSpotify/qspotifyplaylistsnapshot.cpp \
     ../libQtSpotify/listmodels/qspotifyartistlist.cpp \
     ../libQtSpotify/listmodels/qspotifyalbumlist.cpp \
     ../libQtSpotify/listmodels/qspotifyplaylistsearchlist.cpp \
+    ../libQtSpotify/listmodels/qspotifyplaylisttreemodel.cpp \
+    ../libQtSpotify/listmodels/qspotifyplaylistflatmodel.cpp \
+    ../libQtSpotify/listmodels/qspotifyplaylistfiltermodel.cpp \
     ../libQtSpotify/qspotifycachemanager.cpp \
     ../libQtSpotify/qspotifyringbuffer.cpp \
     ../libQtSpotify/mpris/mprismediaplayerplayer.cpp \
@@ -40,6 +54,9 @@ HEADERS += ../libQtSpotify/qspotifysession.h \
     ../libQtSpotify/qspotifyplaylistcontainer.h \
     ../libQtSpotify/qspotifyplaylistsearchentry.h \
     ../libQtSpotify/qspotifytracklist.h \
+    ../libQtSpotify/qspotifytrackrecords.h \
+    ../libQtSpotify/qspotifystringpool.h \
+    ../libQtSpotify/qspotifyid.h \
     ../libQtSpotify/QtSpotify \
     ../libQtSpotify/qspotify_qmlplugin.h \
     ../libQtSpotify/qspotifyartist.h \
@@ -51,12 +68,25 @@ HEADERS += ../libQtSpotify/qspotifysession.h \
     ../libQtSpotify/qspotifyartistbrowse.h \
     ../libQtSpotify/qspotifytoplist.h \
     ../libQtSpotify/qspotifyevents.h \
+    ../libQtSpotify/qspotifyeventwatchdog.h \
+    ../libQtSpotify/qspotifytrace.h \
+    ../libQtSpotify/qspotifylogsink.h \
+    ../libQtSpotify/qspotifymetrics.h \
+    ../libQtSpotify/qspotifymemory.h \
+    ../libQtSpotify/qspotifymetricsadaptor.h \
+    ../libQtSpotify/qspotifyobjectpool.h \
+    ../libQtSpotify/qspotifystartuptimeline.h \
+    ../libQtSpotify/qspotifymetadatastore.h \
+    ../libQtSpotify/qspotifyplaylistsnapshot.h \
     ../libQtSpotify/listmodels/listmodelbase.h \
     ../libQtSpotify/listmodels/tracklistfiltermodel.h \
     ../libQtSpotify/qspotifyaudiothreadworker.h \
     ../libQtSpotify/listmodels/qspotifyartistlist.h \
     ../libQtSpotify/listmodels/qspotifyalbumlist.h \
     ../libQtSpotify/listmodels/qspotifyplaylistsearchlist.h \
+    ../libQtSpotify/listmodels/qspotifyplaylisttreemodel.h \
+    ../libQtSpotify/listmodels/qspotifyplaylistflatmodel.h \
+    ../libQtSpotify/listmodels/qspotifyplaylistfiltermodel.h \
     ../libQtSpotify/qspotifycachemanager.h \
     ../libQtSpotify/qspotifyringbuffer.h \
     ../libQtSpotify/mpris/mprismediaplayer.h \
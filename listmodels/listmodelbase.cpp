@@ -13,7 +13,30 @@ int ListModelBase<ItemType>::rowCount(const QModelIndex &parent) const
 template <class ItemType>
 ListModelBase<ItemType>::~ListModelBase()
 {
+    m_destroying = true;
     clear();
+    if (m_memoryAccount) {
+        m_memoryAccount->update(-1, -m_accountedBytes);
+        QSpotifyMemory::instance().untrack(this);
+    }
+}
+
+template <class ItemType>
+void ListModelBase<ItemType>::accountMemory()
+{
+    // Neither the class name nor estimatedSize() are the subclass' anymore
+    if (m_destroying)
+        return;
+    QSpotifyMemory &memory = QSpotifyMemory::instance();
+    int size = estimatedSize();
+    if (!m_memoryAccount) {
+        m_memoryAccount = memory.account(QLatin1String("models.") + QLatin1String(metaObject()->className()));
+        m_memoryAccount->update(1, size);
+        memory.track(this, m_memoryAccount);
+    } else if (size != m_accountedBytes) {
+        m_memoryAccount->update(0, size - m_accountedBytes);
+    }
+    m_accountedBytes = size;
 }
 
 template <class ItemType>
@@ -22,7 +45,9 @@ void ListModelBase<ItemType>::appendRow(ItemType *item)
     beginInsertRows(QModelIndex(), rowCount(), rowCount());
     connect(item, &QSpotifyObject::dataChanged, this, &ListModelBase<ItemType>::itemDataChanged);
     m_dataList.append(item);
+    rowInserted(m_dataList.size() - 1);
     endInsertRows();
+    accountMemory();
 }
 
 template <class ItemType>
@@ -33,8 +58,10 @@ void ListModelBase<ItemType>::appendRows(const QList<ItemType *> &items)
     for(auto item : items) {
         connect(item, &QSpotifyObject::dataChanged, this, &ListModelBase<ItemType>::itemDataChanged);
         m_dataList.append(item);
+        rowInserted(m_dataList.size() - 1);
     }
     endInsertRows();
+    accountMemory();
 }
 
 template <class ItemType>
@@ -43,14 +70,35 @@ void ListModelBase<ItemType>::insertRow(int row, ItemType *item)
     beginInsertRows(QModelIndex(),row,row);
     connect(item, &QSpotifyObject::dataChanged, this, &ListModelBase<ItemType>::itemDataChanged);
     m_dataList.insert(row,item);
+    rowInserted(row);
     endInsertRows();
+    accountMemory();
+}
+
+template <class ItemType>
+void ListModelBase<ItemType>::insertRows(int row, const QList<ItemType *> &items)
+{
+    if (items.isEmpty()) return;
+    beginInsertRows(QModelIndex(), row, row + items.size() - 1);
+    QList<ItemType *> rows;
+    rows.reserve(m_dataList.size() + items.size());
+    rows.append(m_dataList.mid(0, row));
+    rows.append(items);
+    rows.append(m_dataList.mid(row));
+    m_dataList.swap(rows);
+    for (int i = 0; i < items.size(); ++i) {
+        connect(items.at(i), &QSpotifyObject::dataChanged, this, &ListModelBase<ItemType>::itemDataChanged);
+        rowInserted(row + i);
+    }
+    endInsertRows();
+    accountMemory();
 }
 
 template <class ItemType>
 ItemType *ListModelBase<ItemType>::find(const QString &id) const
 {
     for(auto item : m_dataList)
-        if(item->getId() == id) return item;
+        if(item && item->getId() == id) return item;
     return 0;
 }
 
@@ -71,21 +119,45 @@ void ListModelBase<ItemType>::clear()
     beginRemoveRows(QModelIndex(),0, m_dataList.size()-1);
     while(!m_dataList.isEmpty()) {
         auto i = m_dataList.takeFirst();
+        // Rows of some models get their object on first use only
+        if (!i) continue;
         disconnect(i, &QSpotifyObject::dataChanged, this, &ListModelBase<ItemType>::itemDataChanged);
         i->release();
     }
+    rowsCleared();
     endRemoveRows();
+    accountMemory();
 }
 
 template <class ItemType>
 ItemType *ListModelBase<ItemType>::takeRow(int row){
     beginRemoveRows(QModelIndex(),row,row);
     auto item = m_dataList.takeAt(row);
-    disconnect(item, &QSpotifyObject::dataChanged, this, &ListModelBase<ItemType>::itemDataChanged);
+    if (item)
+        disconnect(item, &QSpotifyObject::dataChanged, this, &ListModelBase<ItemType>::itemDataChanged);
+    rowsRemoved(row, 1);
     endRemoveRows();
+    accountMemory();
     return item;
 }
 
+template <class ItemType>
+QList<ItemType *> ListModelBase<ItemType>::takeRows(int row, int count)
+{
+    if (count <= 0) return QList<ItemType *>();
+    beginRemoveRows(QModelIndex(), row, row + count - 1);
+    QList<ItemType *> items = m_dataList.mid(row, count);
+    m_dataList.erase(m_dataList.begin() + row, m_dataList.begin() + row + count);
+    for (auto item : items) {
+        if (item)
+            disconnect(item, &QSpotifyObject::dataChanged, this, &ListModelBase<ItemType>::itemDataChanged);
+    }
+    rowsRemoved(row, count);
+    endRemoveRows();
+    accountMemory();
+    return items;
+}
+
 template <class ItemType>
 void ListModelBase<ItemType>::replaceData(const QList<ItemType *> &newData)
 {
@@ -98,8 +170,9 @@ void ListModelBase<ItemType>::itemDataChanged()
 {
     auto sndr = dynamic_cast<ItemType *>(sender());
     if(sndr) {
-        int idx = m_dataList.indexOf(sndr);
+        int idx = rowOf(sndr);
         if (idx > -1 && idx < count()) {
+            rowChanged(idx);
             auto modelIdx = index(idx);
             emit dataChanged(modelIdx, modelIdx);
         }
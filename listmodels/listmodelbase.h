@@ -5,6 +5,8 @@
 #include <QtCore/QList>
 #include <QtCore/QVariant>
 
+#include "../qspotifymemory.h"
+
 /***
  Abstract list model class, uses std::shared_pointer to objects it stores.
 
@@ -25,8 +27,12 @@ public:
     void appendRow(ItemType * item);
     void appendRows(const QList<ItemType *> &items);
     void insertRow(int row, ItemType *item);
+    // One beginInsertRows() for all items, in that order from row on.
+    void insertRows(int row, const QList<ItemType *> &items);
     void replaceData(const QList<ItemType *> &newData);
     ItemType *takeRow(int row);
+    // One beginRemoveRows() for the range, the caller owns the items.
+    QList<ItemType *> takeRows(int row, int count);
     ItemType *find(const QString &id) const;
     QModelIndex indexFromItem(const ItemType *item) const;
     virtual void clear();
@@ -48,8 +54,27 @@ public:
     const_iterator cend() const { return m_dataList.cend(); }
 
 protected:
+    // Rows and whatever the subclass keeps per row, see accountMemory().
+    virtual int estimatedSize() const { return int(sizeof(*this)) + m_dataList.size() * int(sizeof(ItemType *)); }
+    // Updates the model's QSpotifyMemory account, call after changing the
+    // row count. Models are accounted from their first change on.
+    void accountMemory();
+
+    // Called after m_dataList changed, before the views are notified.
+    virtual void rowInserted(int row) { Q_UNUSED(row) }
+    virtual void rowsRemoved(int row, int count) { Q_UNUSED(row) Q_UNUSED(count) }
+    virtual void rowsCleared() {}
+    virtual void rowChanged(int row) { Q_UNUSED(row) }
+    // Row of item, -1 if not in the model.
+    virtual int rowOf(ItemType *item) const { return m_dataList.indexOf(item); }
+
     QList<ItemType *> m_dataList;
 
+private:
+    QSpotifyMemory::Account *m_memoryAccount{};
+    int m_accountedBytes{};
+    bool m_destroying{};
+
 protected slots:
     void itemDataChanged();
 };
@@ -0,0 +1,20 @@
+#include "qspotifyplaylistfiltermodel.h"
+
+#include "qspotifyplaylisttreemodel.h"
+#include "../qspotifyplaylist.h"
+#include "../qspotifysession.h"
+
+QSpotifyPlaylistFilterModel::QSpotifyPlaylistFilterModel(QObject *parent)
+    : QSortFilterProxyModel(parent)
+{
+    setDynamicSortFilter(true);
+    connect(QSpotifySession::instance(), SIGNAL(offlineModeChanged()), this, SLOT(invalidate()));
+}
+
+bool QSpotifyPlaylistFilterModel::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const
+{
+    QModelIndex idx = sourceModel()->index(source_row, 0, source_parent);
+    if (idx.data(QSpotifyPlaylistTreeModel::TypeRole).toInt() == QSpotifyPlaylist::Folder)
+        return true;
+    return !QSpotifySession::instance()->offlineMode() || idx.data(QSpotifyPlaylistTreeModel::AvailableOfflineRole).toBool();
+}
@@ -0,0 +1,24 @@
+#ifndef QSPOTIFYPLAYLISTFILTERMODEL_H
+#define QSPOTIFYPLAYLISTFILTERMODEL_H
+
+#include <QtCore/QSortFilterProxyModel>
+
+/**
+ * Hides the playlists that can't be played while the session is in offline
+ * mode, like the playlists of QSpotifyUser::playlists() are split into
+ * available and unavailable ones. Folders are always shown. Works on top of
+ * QSpotifyPlaylistTreeModel and QSpotifyPlaylistFlatModel.
+ */
+class QSpotifyPlaylistFilterModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+public:
+    explicit QSpotifyPlaylistFilterModel(QObject *parent = nullptr);
+
+protected:
+    bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const;
+    // We only care about filtering
+    bool lessThan(const QModelIndex &, const QModelIndex &) const { return false; }
+};
+
+#endif // QSPOTIFYPLAYLISTFILTERMODEL_H
@@ -0,0 +1,126 @@
+#include "qspotifyplaylistflatmodel.h"
+
+#include <QtCore/QSet>
+
+#include "qspotifyplaylisttreemodel.h"
+#include "../qspotifyplaylist.h"
+
+QSpotifyPlaylistFlatModel::QSpotifyPlaylistFlatModel(QSpotifyPlaylistTreeModel *tree, QObject *parent)
+    : QAbstractProxyModel(parent)
+    , m_tree(tree)
+{
+    setSourceModel(tree);
+    collect(QModelIndex(), &m_rows);
+    // The tree changes one row at a time, sync() finds the same change here
+    connect(tree, SIGNAL(rowsInserted(QModelIndex,int,int)), this, SLOT(sync()));
+    connect(tree, SIGNAL(rowsRemoved(QModelIndex,int,int)), this, SLOT(sync()));
+    connect(tree, SIGNAL(rowsMoved(QModelIndex,int,int,QModelIndex,int)), this, SLOT(sync()));
+    connect(tree, SIGNAL(modelReset()), this, SLOT(onSourceReset()));
+    connect(tree, SIGNAL(dataChanged(QModelIndex,QModelIndex)), this, SLOT(onSourceDataChanged(QModelIndex,QModelIndex)));
+}
+
+QModelIndex QSpotifyPlaylistFlatModel::mapToSource(const QModelIndex &proxyIndex) const
+{
+    if (!proxyIndex.isValid())
+        return QModelIndex();
+    return m_rows.at(proxyIndex.row());
+}
+
+QModelIndex QSpotifyPlaylistFlatModel::mapFromSource(const QModelIndex &sourceIndex) const
+{
+    int row = sourceIndex.isValid() ? rowOf(sourceIndex.internalPointer()) : -1;
+    return row < 0 ? QModelIndex() : createIndex(row, 0);
+}
+
+QModelIndex QSpotifyPlaylistFlatModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (parent.isValid() || column != 0 || row < 0 || row >= m_rows.count())
+        return QModelIndex();
+    return createIndex(row, 0);
+}
+
+QModelIndex QSpotifyPlaylistFlatModel::parent(const QModelIndex &child) const
+{
+    Q_UNUSED(child)
+    return QModelIndex();
+}
+
+int QSpotifyPlaylistFlatModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rows.count();
+}
+
+int QSpotifyPlaylistFlatModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : 1;
+}
+
+void QSpotifyPlaylistFlatModel::collect(const QModelIndex &parent, QList<QPersistentModelIndex> *rows) const
+{
+    for (int row = 0; row < m_tree->rowCount(parent); ++row) {
+        QModelIndex idx = m_tree->index(row, 0, parent);
+        if (idx.data(QSpotifyPlaylistTreeModel::TypeRole).toInt() == QSpotifyPlaylist::Folder)
+            collect(idx, rows);
+        else
+            rows->append(idx);
+    }
+}
+
+int QSpotifyPlaylistFlatModel::rowOf(const void *node, int from) const
+{
+    for (int row = from; row < m_rows.count(); ++row) {
+        if (m_rows.at(row).internalPointer() == node)
+            return row;
+    }
+    return -1;
+}
+
+void QSpotifyPlaylistFlatModel::sync()
+{
+    QList<QPersistentModelIndex> rows;
+    collect(QModelIndex(), &rows);
+
+    QSet<void *> remaining;
+    for (const QPersistentModelIndex &idx : rows)
+        remaining.insert(idx.internalPointer());
+    for (int row = m_rows.count() - 1; row >= 0; --row) {
+        // Removed rows are invalid before their node can be reused
+        if (m_rows.at(row).isValid() && remaining.contains(m_rows.at(row).internalPointer()))
+            continue;
+        beginRemoveRows(QModelIndex(), row, row);
+        m_rows.removeAt(row);
+        endRemoveRows();
+    }
+
+    for (int row = 0; row < rows.count(); ++row) {
+        if (row < m_rows.count() && m_rows.at(row).internalPointer() == rows.at(row).internalPointer())
+            continue;
+        int from = rowOf(rows.at(row).internalPointer(), row + 1);
+        if (from < 0) {
+            beginInsertRows(QModelIndex(), row, row);
+            m_rows.insert(row, rows.at(row));
+            endInsertRows();
+        } else {
+            beginMoveRows(QModelIndex(), from, from, QModelIndex(), row);
+            m_rows.move(from, row);
+            endMoveRows();
+        }
+    }
+}
+
+void QSpotifyPlaylistFlatModel::onSourceReset()
+{
+    beginResetModel();
+    m_rows.clear();
+    collect(QModelIndex(), &m_rows);
+    endResetModel();
+}
+
+void QSpotifyPlaylistFlatModel::onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        QModelIndex idx = mapFromSource(topLeft.sibling(row, 0));
+        if (idx.isValid())
+            emit dataChanged(idx, idx);
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef QSPOTIFYPLAYLISTFLATMODEL_H
+#define QSPOTIFYPLAYLISTFLATMODEL_H
+
+#include <QtCore/QAbstractProxyModel>
+#include <QtCore/QList>
+#include <QtCore/QPersistentModelIndex>
+
+class QSpotifyPlaylistTreeModel;
+
+/**
+ * The playlists of a QSpotifyPlaylistTreeModel as a list, in tree order and
+ * without the folders. Changes of the tree are passed on as the row
+ * inserts, removes and moves they amount to in the list.
+ */
+class QSpotifyPlaylistFlatModel : public QAbstractProxyModel
+{
+    Q_OBJECT
+public:
+    explicit QSpotifyPlaylistFlatModel(QSpotifyPlaylistTreeModel *tree, QObject *parent = nullptr);
+
+    QModelIndex mapToSource(const QModelIndex &proxyIndex) const;
+    QModelIndex mapFromSource(const QModelIndex &sourceIndex) const;
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const;
+    QModelIndex parent(const QModelIndex &child) const;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+
+private Q_SLOTS:
+    void sync();
+    void onSourceReset();
+    void onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+
+private:
+    void collect(const QModelIndex &parent, QList<QPersistentModelIndex> *rows) const;
+    // Rows are told apart by their tree node, snapshot rows have no playlist
+    int rowOf(const void *node, int from = 0) const;
+
+    QSpotifyPlaylistTreeModel *m_tree;
+    QList<QPersistentModelIndex> m_rows;
+};
+
+#endif // QSPOTIFYPLAYLISTFLATMODEL_H
@@ -0,0 +1,444 @@
+#include "qspotifyplaylisttreemodel.h"
+
+#include <QtCore/QVector>
+
+#include "../qspotifyplaylist.h"
+
+QSpotifyPlaylistTreeModel::QSpotifyPlaylistTreeModel(QObject *parent)
+    : QAbstractItemModel(parent)
+{
+    m_roles[PlaylistRole] = "playlist";
+    m_roles[NameRole] = "name";
+    m_roles[TypeRole] = "type";
+    m_roles[AvailableOfflineRole] = "availableOffline";
+    m_roles[OwnerRole] = "owner";
+    m_roles[ImageIdRole] = "imageId";
+    m_roles[TrackCountRole] = "trackCount";
+    m_roles[DurationRole] = "duration";
+    m_roles[CoverImagesRole] = "coverImages";
+}
+
+QSpotifyPlaylistTreeModel::~QSpotifyPlaylistTreeModel()
+{
+    qDeleteAll(m_nodes);
+}
+
+QModelIndex QSpotifyPlaylistTreeModel::index(int row, int column, const QModelIndex &parent) const
+{
+    const Node *p = parent.isValid() ? static_cast<Node *>(parent.internalPointer()) : &m_root;
+    if (column != 0 || row < 0 || row >= p->children.count())
+        return QModelIndex();
+    return createIndex(row, 0, p->children.at(row));
+}
+
+QModelIndex QSpotifyPlaylistTreeModel::parent(const QModelIndex &child) const
+{
+    if (!child.isValid())
+        return QModelIndex();
+    return indexOf(static_cast<Node *>(child.internalPointer())->parent);
+}
+
+int QSpotifyPlaylistTreeModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.column() > 0)
+        return 0;
+    const Node *p = parent.isValid() ? static_cast<Node *>(parent.internalPointer()) : &m_root;
+    return p->children.count();
+}
+
+int QSpotifyPlaylistTreeModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    return 1;
+}
+
+QVariant QSpotifyPlaylistTreeModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid())
+        return QVariant();
+    const Node *node = static_cast<Node *>(index.internalPointer());
+    if (role == PlaylistRole)
+        return QVariant::fromValue<QObject *>(node->playlist);
+
+    if (showsSnapshot(node)) {
+        const QSpotifyPlaylistSnapshot::Entry &entry = node->snapshot;
+        switch (role) {
+        case NameRole:
+            return entry.name;
+        case TypeRole:
+            return entry.type;
+        case AvailableOfflineRole:
+            return entry.availableOffline;
+        case OwnerRole:
+            return entry.owner;
+        case ImageIdRole:
+            return entry.imageId;
+        case TrackCountRole:
+            return entry.trackCount;
+        case DurationRole:
+            return entry.duration;
+        case CoverImagesRole:
+            return entry.coverImages;
+        default:
+            return QVariant();
+        }
+    }
+
+    QSpotifyPlaylist *playlist = node->playlist;
+    switch (role) {
+    case NameRole:
+        return playlist->name();
+    case TypeRole:
+        return playlist->type();
+    case AvailableOfflineRole:
+        return playlist->availableOffline();
+    case OwnerRole:
+        return playlist->owner();
+    case ImageIdRole:
+        return playlist->imageId();
+    case TrackCountRole:
+        return playlist->trackCount();
+    case DurationRole:
+        return playlist->totalDuration();
+    case CoverImagesRole:
+        return playlist->coverImages();
+    default:
+        return QVariant();
+    }
+}
+
+bool QSpotifyPlaylistTreeModel::showsSnapshot(const Node *node) const
+{
+    if (!node->hasSnapshot)
+        return false;
+    // Folders get their name from the container right away
+    return !node->playlist || (node->playlist->type() != QSpotifyPlaylist::Folder && !node->playlist->isLoaded());
+}
+
+QSpotifyPlaylistSnapshot::Entry QSpotifyPlaylistTreeModel::entryOf(const Node *node) const
+{
+    if (showsSnapshot(node))
+        return node->snapshot;
+
+    // The key is left to snapshot()
+    QSpotifyPlaylist *playlist = node->playlist;
+    QSpotifyPlaylistSnapshot::Entry entry;
+    entry.type = playlist->type();
+    entry.name = playlist->name();
+    entry.owner = playlist->owner();
+    entry.imageId = playlist->imageId();
+    entry.trackCount = playlist->trackCount();
+    entry.duration = playlist->totalDuration();
+    entry.availableOffline = playlist->availableOffline();
+    entry.coverImages = playlist->coverImages();
+    return entry;
+}
+
+QModelIndex QSpotifyPlaylistTreeModel::indexOf(QSpotifyPlaylist *playlist) const
+{
+    return indexOf(m_nodes.value(playlist));
+}
+
+QModelIndex QSpotifyPlaylistTreeModel::indexOf(Node *node) const
+{
+    if (!node || node == &m_root)
+        return QModelIndex();
+    return createIndex(node->parent->children.indexOf(node), 0, node);
+}
+
+bool QSpotifyPlaylistTreeModel::isNode(const QSpotifyPlaylist *playlist)
+{
+    return isNode(playlist->type());
+}
+
+bool QSpotifyPlaylistTreeModel::isNode(int type)
+{
+    return type == QSpotifyPlaylist::Playlist || type == QSpotifyPlaylist::Folder;
+}
+
+void QSpotifyPlaylistTreeModel::locate(const QList<QSpotifyPlaylist *> &entries, int pos, Node **parent, int *row) const
+{
+    // Same nesting as reset(): unmatched folder ends are ignored
+    QVector<Node *> folders;
+    QVector<int> rows;
+    folders.append(const_cast<Node *>(&m_root));
+    rows.append(0);
+    for (int i = 0; i < pos; ++i) {
+        QSpotifyPlaylist *playlist = entries.at(i);
+        switch (playlist->type()) {
+        case QSpotifyPlaylist::Playlist:
+            ++rows.last();
+            break;
+        case QSpotifyPlaylist::Folder:
+            ++rows.last();
+            folders.append(m_nodes.value(playlist));
+            rows.append(0);
+            break;
+        case QSpotifyPlaylist::FolderEnd:
+            if (folders.count() > 1) {
+                folders.removeLast();
+                rows.removeLast();
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    *parent = folders.last();
+    *row = rows.last();
+}
+
+QSpotifyPlaylistTreeModel::Node *QSpotifyPlaylistTreeModel::createNode(QSpotifyPlaylist *playlist, Node *parent, int row)
+{
+    Node *node = new Node(nullptr, parent);
+    parent->children.insert(row, node);
+    adoptNode(node, playlist);
+    return node;
+}
+
+void QSpotifyPlaylistTreeModel::adoptNode(Node *node, QSpotifyPlaylist *playlist)
+{
+    node->playlist = playlist;
+    m_nodes.insert(playlist, node);
+    connect(playlist, SIGNAL(nameChanged()), this, SLOT(onPlaylistChanged()));
+    connect(playlist, SIGNAL(playlistDataChanged()), this, SLOT(onPlaylistChanged()));
+    connect(playlist, SIGNAL(availableOfflineChanged()), this, SLOT(onPlaylistChanged()));
+    connect(playlist, SIGNAL(thisIsLoadedChanged()), this, SLOT(onPlaylistChanged()));
+}
+
+void QSpotifyPlaylistTreeModel::deleteNode(Node *node)
+{
+    for (Node *child : node->children)
+        deleteNode(child);
+    if (node->playlist) {
+        m_nodes.remove(node->playlist);
+        disconnect(node->playlist, nullptr, this, nullptr);
+    }
+    delete node;
+}
+
+void QSpotifyPlaylistTreeModel::entryInserted(const QList<QSpotifyPlaylist *> &entries, int pos)
+{
+    // Reconciled with all entries once the container is loaded
+    if (m_snapshot)
+        return;
+    QSpotifyPlaylist *playlist = entries.at(pos);
+    if (playlist->type() != QSpotifyPlaylist::Playlist) {
+        if (playlist->type() == QSpotifyPlaylist::Folder || playlist->type() == QSpotifyPlaylist::FolderEnd)
+            reset(entries);
+        return;
+    }
+    Node *parent;
+    int row;
+    locate(entries, pos, &parent, &row);
+    beginInsertRows(indexOf(parent), row, row);
+    createNode(playlist, parent, row);
+    endInsertRows();
+}
+
+void QSpotifyPlaylistTreeModel::entryRemoved(const QList<QSpotifyPlaylist *> &entries, QSpotifyPlaylist *playlist)
+{
+    // Reconciled with all entries once the container is loaded
+    if (m_snapshot)
+        return;
+    if (playlist->type() != QSpotifyPlaylist::Playlist) {
+        if (playlist->type() == QSpotifyPlaylist::Folder || playlist->type() == QSpotifyPlaylist::FolderEnd)
+            reset(entries);
+        return;
+    }
+    Node *node = m_nodes.value(playlist);
+    if (!node)
+        return;
+    int row = node->parent->children.indexOf(node);
+    beginRemoveRows(indexOf(node->parent), row, row);
+    node->parent->children.removeAt(row);
+    deleteNode(node);
+    endRemoveRows();
+}
+
+void QSpotifyPlaylistTreeModel::entryMoved(const QList<QSpotifyPlaylist *> &entries, int pos)
+{
+    // Reconciled with all entries once the container is loaded
+    if (m_snapshot)
+        return;
+    QSpotifyPlaylist *playlist = entries.at(pos);
+    Node *node = m_nodes.value(playlist);
+    if (playlist->type() != QSpotifyPlaylist::Playlist || !node) {
+        if (isNode(playlist) || playlist->type() == QSpotifyPlaylist::FolderEnd)
+            reset(entries);
+        return;
+    }
+
+    Node *oldParent = node->parent;
+    int oldRow = oldParent->children.indexOf(node);
+    Node *newParent;
+    int newRow;
+    locate(entries, pos, &newParent, &newRow);
+    // Before the move, the rows after the old one are one further down
+    int destination = (newParent == oldParent && newRow > oldRow) ? newRow + 1 : newRow;
+    if (!beginMoveRows(indexOf(oldParent), oldRow, oldRow, indexOf(newParent), destination))
+        return;
+    oldParent->children.removeAt(oldRow);
+    newParent->children.insert(newRow, node);
+    node->parent = newParent;
+    endMoveRows();
+}
+
+void QSpotifyPlaylistTreeModel::reset(const QList<QSpotifyPlaylist *> &entries)
+{
+    if (m_snapshot) {
+        m_snapshot = false;
+        int pos = 0;
+        reconcile(&m_root, entries, &pos);
+        return;
+    }
+
+    beginResetModel();
+    for (Node *child : m_root.children)
+        deleteNode(child);
+    m_root.children.clear();
+
+    QVector<Node *> folders;
+    folders.append(&m_root);
+    for (QSpotifyPlaylist *playlist : entries) {
+        Node *parent = folders.last();
+        switch (playlist->type()) {
+        case QSpotifyPlaylist::Playlist:
+            createNode(playlist, parent, parent->children.count());
+            break;
+        case QSpotifyPlaylist::Folder:
+            folders.append(createNode(playlist, parent, parent->children.count()));
+            break;
+        case QSpotifyPlaylist::FolderEnd:
+            if (folders.count() > 1)
+                folders.removeLast();
+            break;
+        default:
+            break;
+        }
+    }
+    endResetModel();
+}
+
+void QSpotifyPlaylistTreeModel::reconcile(Node *parent, const QList<QSpotifyPlaylist *> &entries, int *pos)
+{
+    QModelIndex parentIndex = indexOf(parent);
+    int row = 0;
+    while (*pos < entries.count()) {
+        QSpotifyPlaylist *playlist = entries.at((*pos)++);
+        if (playlist->type() == QSpotifyPlaylist::FolderEnd) {
+            // Same nesting as reset(): unmatched folder ends are ignored
+            if (parent != &m_root)
+                break;
+            continue;
+        }
+        if (!isNode(playlist))
+            continue;
+
+        Node *node;
+        int from = matchingRow(parent, row, playlist);
+        if (from < 0) {
+            beginInsertRows(parentIndex, row, row);
+            node = createNode(playlist, parent, row);
+            endInsertRows();
+        } else {
+            if (from != row) {
+                beginMoveRows(parentIndex, from, from, parentIndex, row);
+                parent->children.move(from, row);
+                endMoveRows();
+            }
+            node = parent->children.at(row);
+            adoptNode(node, playlist);
+            QModelIndex idx = indexOf(node);
+            emit dataChanged(idx, idx);
+        }
+        if (playlist->type() == QSpotifyPlaylist::Folder)
+            reconcile(node, entries, pos);
+        ++row;
+    }
+
+    // Rows from the snapshot that are gone
+    if (row < parent->children.count()) {
+        beginRemoveRows(parentIndex, row, parent->children.count() - 1);
+        while (parent->children.count() > row)
+            deleteNode(parent->children.takeLast());
+        endRemoveRows();
+    }
+}
+
+int QSpotifyPlaylistTreeModel::matchingRow(const Node *parent, int row, const QSpotifyPlaylist *playlist) const
+{
+    // The rows before row are matched already, the others are all from the
+    // snapshot. Without a key the playlist gets a row of its own, taking one
+    // by position could show another playlist's name until it is loaded.
+    QByteArray key = QSpotifyPlaylistSnapshot::key(playlist);
+    if (key.isEmpty())
+        return -1;
+    for (int i = row; i < parent->children.count(); ++i) {
+        const Node *node = parent->children.at(i);
+        if (node->snapshot.type == playlist->type() && node->snapshot.key == key)
+            return i;
+    }
+    return -1;
+}
+
+void QSpotifyPlaylistTreeModel::showSnapshot(const QList<QSpotifyPlaylistSnapshot::Entry> &entries)
+{
+    beginResetModel();
+    for (Node *child : m_root.children)
+        deleteNode(child);
+    m_root.children.clear();
+
+    QVector<Node *> folders;
+    folders.append(&m_root);
+    for (const QSpotifyPlaylistSnapshot::Entry &entry : entries) {
+        if (entry.type == QSpotifyPlaylist::FolderEnd) {
+            if (folders.count() > 1)
+                folders.removeLast();
+            continue;
+        }
+        if (!isNode(entry.type))
+            continue;
+        Node *node = new Node(nullptr, folders.last());
+        node->snapshot = entry;
+        node->hasSnapshot = true;
+        folders.last()->children.append(node);
+        if (entry.type == QSpotifyPlaylist::Folder)
+            folders.append(node);
+    }
+    m_snapshot = !m_root.children.isEmpty();
+    endResetModel();
+}
+
+QList<QSpotifyPlaylistSnapshot::Entry> QSpotifyPlaylistTreeModel::snapshot() const
+{
+    QList<QSpotifyPlaylistSnapshot::Entry> entries;
+    appendEntries(&m_root, &entries);
+    return entries;
+}
+
+void QSpotifyPlaylistTreeModel::appendEntries(const Node *node, QList<QSpotifyPlaylistSnapshot::Entry> *entries) const
+{
+    for (const Node *child : node->children) {
+        QSpotifyPlaylistSnapshot::Entry entry = entryOf(child);
+        // Left empty for playlists without a key, those are not matched
+        if (child->playlist)
+            entry.key = QSpotifyPlaylistSnapshot::key(child->playlist);
+        entries->append(entry);
+
+        if (entry.type == QSpotifyPlaylist::Folder) {
+            appendEntries(child, entries);
+            QSpotifyPlaylistSnapshot::Entry end;
+            end.key = entry.key;
+            end.type = QSpotifyPlaylist::FolderEnd;
+            entries->append(end);
+        }
+    }
+}
+
+void QSpotifyPlaylistTreeModel::onPlaylistChanged()
+{
+    QModelIndex idx = indexOf(qobject_cast<QSpotifyPlaylist *>(sender()));
+    if (idx.isValid())
+        emit dataChanged(idx, idx);
+}
@@ -0,0 +1,110 @@
+#ifndef QSPOTIFYPLAYLISTTREEMODEL_H
+#define QSPOTIFYPLAYLISTTREEMODEL_H
+
+#include <QtCore/QAbstractItemModel>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+
+#include "../qspotifyplaylistsnapshot.h"
+
+class QSpotifyPlaylist;
+
+/**
+ * Folders and playlists of a QSpotifyPlaylistContainer as a tree, folders
+ * having their playlists and subfolders as children.
+ *
+ * The container passes on its entries, folder start and end markers
+ * included, after each change. Adding, removing and moving playlists is
+ * applied as single row operations; libspotify reports folder changes one
+ * marker at a time, those reset the model.
+ *
+ * Until the container is loaded the model can show a snapshot of an earlier
+ * run. Changes passed on meanwhile are ignored; the reset() once the
+ * container is loaded matches the entries against the snapshot by key, so
+ * only what changed since is inserted, removed or moved. Matched rows keep
+ * showing the snapshot until their playlist is loaded.
+ *
+ * PlaylistRole is null for snapshot rows until they are matched, delegates
+ * using model.playlist have to check for that.
+ */
+class QSpotifyPlaylistTreeModel : public QAbstractItemModel
+{
+    Q_OBJECT
+public:
+    enum Roles {
+        PlaylistRole = Qt::UserRole + 1,
+        NameRole,
+        TypeRole,
+        AvailableOfflineRole,
+        OwnerRole,
+        ImageIdRole,
+        TrackCountRole,
+        DurationRole,
+        CoverImagesRole
+    };
+
+    explicit QSpotifyPlaylistTreeModel(QObject *parent = nullptr);
+    ~QSpotifyPlaylistTreeModel();
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const;
+    QModelIndex parent(const QModelIndex &child) const;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role) const;
+    QHash<int, QByteArray> roleNames() const { return m_roles; }
+
+    QModelIndex indexOf(QSpotifyPlaylist *playlist) const;
+
+    // entries is the container's list after the change.
+    void entryInserted(const QList<QSpotifyPlaylist *> &entries, int pos);
+    void entryRemoved(const QList<QSpotifyPlaylist *> &entries, QSpotifyPlaylist *playlist);
+    // pos is where the entry is now.
+    void entryMoved(const QList<QSpotifyPlaylist *> &entries, int pos);
+    void reset(const QList<QSpotifyPlaylist *> &entries);
+
+    // Shown until the next reset(), which reconciles instead. Call that only
+    // with the entries of a loaded container.
+    void showSnapshot(const QList<QSpotifyPlaylistSnapshot::Entry> &entries);
+    bool isSnapshot() const { return m_snapshot; }
+    // What the model shows, in container order.
+    QList<QSpotifyPlaylistSnapshot::Entry> snapshot() const;
+
+private Q_SLOTS:
+    void onPlaylistChanged();
+
+private:
+    struct Node {
+        Node(QSpotifyPlaylist *playlist = nullptr, Node *parent = nullptr)
+            : playlist(playlist), parent(parent), hasSnapshot(false) { }
+
+        // Null for snapshot rows not matched yet
+        QSpotifyPlaylist *playlist;
+        Node *parent;
+        QList<Node *> children;
+        QSpotifyPlaylistSnapshot::Entry snapshot;
+        bool hasSnapshot;
+    };
+
+    // Where the entry at pos goes in the tree, from the entries before it
+    void locate(const QList<QSpotifyPlaylist *> &entries, int pos, Node **parent, int *row) const;
+    Node *createNode(QSpotifyPlaylist *playlist, Node *parent, int row);
+    void adoptNode(Node *node, QSpotifyPlaylist *playlist);
+    void deleteNode(Node *node);
+    QModelIndex indexOf(Node *node) const;
+    static bool isNode(const QSpotifyPlaylist *playlist);
+    static bool isNode(int type);
+    bool showsSnapshot(const Node *node) const;
+    QSpotifyPlaylistSnapshot::Entry entryOf(const Node *node) const;
+    void appendEntries(const Node *node, QList<QSpotifyPlaylistSnapshot::Entry> *entries) const;
+    // Makes the children of parent match the entries from pos up to the
+    // end of the folder, pos is left after its end marker.
+    void reconcile(Node *parent, const QList<QSpotifyPlaylist *> &entries, int *pos);
+    int matchingRow(const Node *parent, int row, const QSpotifyPlaylist *playlist) const;
+
+    Node m_root;
+    QHash<QSpotifyPlaylist *, Node *> m_nodes;
+    QHash<int, QByteArray> m_roles;
+    bool m_snapshot{};
+};
+
+#endif // QSPOTIFYPLAYLISTTREEMODEL_H
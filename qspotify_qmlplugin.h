@@ -59,6 +59,9 @@ void registerQmlTypes()
     qmlRegisterUncreatableType<QSpotifyArtistList>("QtSpotify", 1, 0, "QSpotifyArtistList", QLatin1String("Retrieve it from the SpotifySession"));
     qmlRegisterUncreatableType<QSpotifyAlbumList>("QtSpotify", 1, 0, "QSpotifyAlbumList", QLatin1String("Retrieve it from the SpotifySession"));
     qmlRegisterUncreatableType<QSpotifyPlaylistSearchList>("QtSpotify", 1, 0, "QSpotifyPlaylistSearchList", QLatin1String("Retrieve it from the SpotifySession"));
+    qmlRegisterUncreatableType<QSpotifyPlaylistTreeModel>("QtSpotify", 1, 0, "QSpotifyPlaylistTreeModel", QLatin1String("Retrieve it from the SpotifyUser"));
+    qmlRegisterUncreatableType<QSpotifyPlaylistFlatModel>("QtSpotify", 1, 0, "QSpotifyPlaylistFlatModel", QLatin1String("Retrieve it from the SpotifyUser"));
+    qmlRegisterUncreatableType<QSpotifyPlaylistFilterModel>("QtSpotify", 1, 0, "QSpotifyPlaylistFilterModel", QLatin1String("Retrieve it from the SpotifyUser"));
 
     qmlRegisterType<QSpotifySearch>("QtSpotify", 1, 0, "SpotifySearch");
     qmlRegisterType<QSpotifyAlbumBrowse>("QtSpotify", 1, 0, "SpotifyAlbumBrowse");
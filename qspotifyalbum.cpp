@@ -45,7 +45,8 @@
 
 #include "qspotifyalbumbrowse.h"
 #include "qspotifyartist.h"
-#include "qspotifyutil.h"
+#include "qspotifycachemanager.h"
+#include "qspotifymetadatastore.h"
 
 QSpotifyAlbum::QSpotifyAlbum(sp_album *album)
     : QSpotifyObject(true)
@@ -67,6 +68,18 @@ bool QSpotifyAlbum::isLoaded()
     return sp_album_is_loaded(m_sp_album);
 }
 
+void QSpotifyAlbum::destroy()
+{
+    QSpotifyCacheManager::instance().scheduleDestroy(this);
+}
+
+int QSpotifyAlbum::estimatedSize() const
+{
+    // Interned names are shared and not counted here
+    return int(sizeof(QSpotifyAlbum))
+            + m_sectionType.size() * int(sizeof(QChar));
+}
+
 QSpotifyAlbumBrowse *QSpotifyAlbum::browse()
 {
     auto browse = new QSpotifyAlbumBrowse();
@@ -78,23 +91,25 @@ bool QSpotifyAlbum::updateData()
 {
     bool updated = false;
 
+    if (!isLoaded()) {
+        if (m_name.isEmpty())
+            updated = loadStoredMetadata();
+        return updated;
+    }
+
     bool isAvailable = sp_album_is_available(m_sp_album);
     sp_artist *a = sp_album_artist((m_sp_album));
-    QString artist;
-    if (a)
-        artist = QString::fromUtf8(sp_artist_name(a));
-    QString name = QString::fromUtf8(sp_album_name(m_sp_album));
+    QSpotifyInternedString artist(a ? sp_artist_name(a) : nullptr);
+    QSpotifyInternedString name(sp_album_name(m_sp_album));
     int year = sp_album_year(m_sp_album);
     Type type = Type(sp_album_type(m_sp_album));
 
     // Get cover
-    const byte *album_cover_id = sp_album_cover(m_sp_album, SP_IMAGE_SIZE_NORMAL);
-    if (album_cover_id != nullptr && m_coverId.isEmpty()) {
-        sp_link *link = sp_link_create_from_album_cover(m_sp_album, SP_IMAGE_SIZE_NORMAL);
-        QSpotifyUtil::spLinkToQString(link, [this, &updated] (const QString &coverId) {
-            m_coverId = coverId;
+    if (!m_coverId.isValid()) {
+        if (const byte *album_cover_id = sp_album_cover(m_sp_album, SP_IMAGE_SIZE_NORMAL)) {
+            m_coverId = QSpotifyId::fromImageId(album_cover_id);
             updated = true;
-        });
+        }
     }
 
     if (isAvailable != m_isAvailable) {
@@ -118,5 +133,44 @@ bool QSpotifyAlbum::updateData()
         updated = true;
     }
 
+    if (updated)
+        storeMetadata();
+
     return updated;
 }
+
+bool QSpotifyAlbum::loadStoredMetadata()
+{
+    QSpotifyMetadataStore &store = QSpotifyMetadataStore::instance();
+    if (!store.isOpen())
+        return false;
+
+    QSpotifyMetadataStore::Record r;
+    if (!store.lookup(uri(), &r))
+        return false;
+
+    m_name = QSpotifyInternedString(r.name);
+    m_artist = QSpotifyInternedString(r.artists);
+    m_coverId = QSpotifyId::fromUri(r.coverId.toLatin1());
+    m_year = r.year;
+    m_isAvailable = r.available;
+    return true;
+}
+
+void QSpotifyAlbum::storeMetadata()
+{
+    QSpotifyMetadataStore::Record r;
+    r.name = m_name.toString();
+    r.artists = m_artist.toString();
+    r.coverId = m_coverId.toString();
+    r.year = m_year;
+    r.available = m_isAvailable;
+    QSpotifyMetadataStore::instance().store(uri(), QSpotifyMetadataStore::Album, r);
+}
+
+QByteArray QSpotifyAlbum::uri()
+{
+    if (!m_id.isValid())
+        m_id = QSpotifyId::fromLink(sp_link_create_from_album(m_sp_album));
+    return m_id.toUri();
+}
@@ -42,7 +42,10 @@
 #ifndef QSPOTIFYALBUM_H
 #define QSPOTIFYALBUM_H
 
+#include "qspotifyid.h"
 #include "qspotifyobject.h"
+#include "qspotifyobjectpool.h"
+#include "qspotifystringpool.h"
 
 class QSpotifyAlbumBrowse;
 class QSpotifyArtist;
@@ -52,6 +55,7 @@ struct sp_artist;
 class QSpotifyAlbum : public QSpotifyObject
 {
     Q_OBJECT
+    QSPOTIFY_DECLARE_POOLED(QSpotifyAlbum)
 
     Q_PROPERTY(bool isAvailable READ isAvailable NOTIFY albumDataChanged)
     Q_PROPERTY(QString artist READ artist NOTIFY albumDataChanged)
@@ -73,14 +77,17 @@ public:
 
     bool isLoaded();
 
+    void destroy();
+    int estimatedSize() const;
+
     bool isAvailable() const { return m_isAvailable; }
-    QString artist() const { return m_artist; }
-    QString name() const { return m_name; }
+    QString artist() const { return m_artist.toString(); }
+    QString name() const { return m_name.toString(); }
     int year() const { return m_year; }
     Type type() const { return m_type; }
     void setSectionType(const QString &t) { m_sectionType = t; }
     QString sectionType() const { return m_sectionType; }
-    QString coverId() const { return m_coverId; }
+    QString coverId() const { return m_coverId.toString(); }
 
     sp_album *spalbum() const { return m_sp_album; }
 
@@ -95,15 +102,20 @@ protected:
 private:
     QSpotifyAlbum(sp_album *album);
 
+    bool loadStoredMetadata();
+    void storeMetadata();
+    QByteArray uri();
+
     sp_album *m_sp_album;
+    QSpotifyId m_id;
 
     bool m_isAvailable{};
-    QString m_artist;
-    QString m_name;
+    QSpotifyInternedString m_artist;
+    QSpotifyInternedString m_name;
     int m_year{};
     Type m_type{Unknown};
     QString m_sectionType;
-    QString m_coverId;
+    QSpotifyId m_coverId;
 
     friend class QSpotifySession;
     friend class QSpotifyTrack;
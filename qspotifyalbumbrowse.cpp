@@ -58,6 +58,8 @@
 #include "qspotifytracklist.h"
 #include "qspotifyuser.h"
 #include "qspotifycachemanager.h"
+#include "qspotifymemory.h"
+#include "qspotifymetrics.h"
 
 static QHash<sp_albumbrowse*, QSpotifyAlbumBrowse*> g_albumBrowseObjects;
 static QMutex g_mutex;
@@ -84,6 +86,8 @@ QSpotifyAlbumBrowse::~QSpotifyAlbumBrowse()
 bool QSpotifyAlbumBrowse::event(QEvent *e)
 {
     if (e->type() == QEvent::User) {
+        static QSpotifyMetrics::Histogram *latency = QSpotifyMetrics::instance().histogram(QLatin1String("albumBrowse.latencyMs"));
+        latency->observe(m_requestTimer);
         processData();
         e->accept();
         return true;
@@ -106,6 +110,7 @@ void QSpotifyAlbumBrowse::setAlbum(QSpotifyAlbum *album)
     emit busyChanged();
 
     QMutexLocker lock(&g_mutex);
+    m_requestTimer.start();
     m_sp_albumbrowse = sp_albumbrowse_create(QSpotifySession::instance()->spsession(), m_album->spalbum(), callback_albumbrowse_complete, nullptr);
     Q_ASSERT(m_sp_albumbrowse);
     g_albumBrowseObjects.insert(m_sp_albumbrowse, this);
@@ -134,6 +139,7 @@ void QSpotifyAlbumBrowse::clearData()
 
 void QSpotifyAlbumBrowse::processData()
 {
+    QSpotifyMemoryTag memoryTag("albumBrowse");
     if (m_sp_albumbrowse) {
         if (sp_albumbrowse_error(m_sp_albumbrowse) != SP_ERROR_OK)
             return;
@@ -147,8 +153,6 @@ void QSpotifyAlbumBrowse::processData()
 
                 m_albumTracks->appendRow(qtrack);
                 connect(qtrack, SIGNAL(isStarredChanged()), this, SIGNAL(isStarredChanged()));
-                connect(QSpotifySession::instance()->user()->starredList(), SIGNAL(tracksAdded(QVector<sp_track*>)), qtrack, SLOT(onStarredListTracksAdded(QVector<sp_track*>)));
-                connect(QSpotifySession::instance()->user()->starredList(), SIGNAL(tracksRemoved(QVector<sp_track*>)), qtrack, SLOT(onStarredListTracksRemoved(QVector<sp_track*>)));
                 if (qtrack->artists() != m_album->artist())
                     m_hasMultipleArtists = true;
                 if (i == 0) {
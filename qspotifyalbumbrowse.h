@@ -42,6 +42,7 @@
 #ifndef QSPOTIFYALBUMBROWSE_H
 #define QSPOTIFYALBUMBROWSE_H
 
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QStringList>
 #include <QtCore/QObject>
 
@@ -106,6 +107,7 @@ private:
     bool m_hasMultipleArtists{};
 
     bool m_busy{};
+    QElapsedTimer m_requestTimer;
 
     friend class QSpotifyPlaylist;
     friend class QSpotifyUser;
@@ -46,7 +46,8 @@
 #include <libspotify/api.h>
 
 #include "qspotifyartistbrowse.h"
-#include "qspotifyutil.h"
+#include "qspotifycachemanager.h"
+#include "qspotifymetadatastore.h"
 
 QSpotifyArtist::QSpotifyArtist(sp_artist *artist)
     : QSpotifyObject(true)
@@ -69,6 +70,17 @@ bool QSpotifyArtist::isLoaded()
     return sp_artist_is_loaded(m_sp_artist);
 }
 
+void QSpotifyArtist::destroy()
+{
+    QSpotifyCacheManager::instance().scheduleDestroy(this);
+}
+
+int QSpotifyArtist::estimatedSize() const
+{
+    return int(sizeof(QSpotifyArtist))
+            + m_name.size() * int(sizeof(QChar));
+}
+
 QSpotifyArtistBrowse *QSpotifyArtist::browse()
 {
     auto browse = new QSpotifyArtistBrowse();
@@ -80,19 +92,57 @@ bool QSpotifyArtist::updateData()
 {
     bool updated = false;
 
+    if (!isLoaded()) {
+        if (m_name.isEmpty())
+            updated = loadStoredMetadata();
+        return updated;
+    }
+
     QString name = QString::fromUtf8(sp_artist_name(m_sp_artist));
     if (m_name != name) {
         m_name = name;
         updated = true;
     }
 
-    if (m_pictureId.isEmpty()) {
-        sp_link *link = sp_link_create_from_artist_portrait(m_sp_artist, SP_IMAGE_SIZE_NORMAL);
-        QSpotifyUtil::spLinkToQString(link, [this, &updated](const QString &picId) {
-            m_pictureId = picId;
+    if (!m_pictureId.isValid()) {
+        if (const byte *portrait = sp_artist_portrait(m_sp_artist, SP_IMAGE_SIZE_NORMAL)) {
+            m_pictureId = QSpotifyId::fromImageId(portrait);
             updated = true;
-        });
+        }
     }
 
+    if (updated)
+        storeMetadata();
+
     return updated;
 }
+
+bool QSpotifyArtist::loadStoredMetadata()
+{
+    QSpotifyMetadataStore &store = QSpotifyMetadataStore::instance();
+    if (!store.isOpen())
+        return false;
+
+    QSpotifyMetadataStore::Record r;
+    if (!store.lookup(uri(), &r))
+        return false;
+
+    m_name = r.name;
+    m_pictureId = QSpotifyId::fromUri(r.coverId.toLatin1());
+    return true;
+}
+
+void QSpotifyArtist::storeMetadata()
+{
+    QSpotifyMetadataStore::Record r;
+    r.name = m_name;
+    r.coverId = m_pictureId.toString();
+    QSpotifyMetadataStore::instance().store(uri(), QSpotifyMetadataStore::Artist, r);
+}
+
+QByteArray QSpotifyArtist::uri()
+{
+    if (!m_id.isValid())
+        m_id = QSpotifyId::fromLink(sp_link_create_from_artist(m_sp_artist));
+    return m_id.toUri();
+}
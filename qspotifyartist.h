@@ -42,7 +42,9 @@
 #ifndef QSPOTIFYARTIST_H
 #define QSPOTIFYARTIST_H
 
+#include "qspotifyid.h"
 #include "qspotifyobject.h"
+#include "qspotifyobjectpool.h"
 
 class QSpotifyArtistBrowse;
 struct sp_artist;
@@ -50,6 +52,7 @@ struct sp_artist;
 class QSpotifyArtist : public QSpotifyObject
 {
     Q_OBJECT
+    QSPOTIFY_DECLARE_POOLED(QSpotifyArtist)
     Q_PROPERTY(QString name READ name NOTIFY artistDataChanged)
     Q_PROPERTY(QString pictureId READ pictureId NOTIFY artistDataChanged)
 public:
@@ -57,8 +60,11 @@ public:
 
     bool isLoaded();
 
+    void destroy();
+    int estimatedSize() const;
+
     QString name() const { return m_name; }
-    QString pictureId() const { return m_pictureId; }
+    QString pictureId() const { return m_pictureId.toString(); }
 
     sp_artist *spartist() const { return m_sp_artist; }
 
@@ -73,10 +79,15 @@ protected:
 private:
     QSpotifyArtist(sp_artist *artist);
 
+    bool loadStoredMetadata();
+    void storeMetadata();
+    QByteArray uri();
+
     sp_artist *m_sp_artist;
+    QSpotifyId m_id;
 
     QString m_name;
-    QString m_pictureId;
+    QSpotifyId m_pictureId;
 
     friend class QSpotifySession;
     friend class QSpotifyTrack;
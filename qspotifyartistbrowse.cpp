@@ -56,6 +56,8 @@
 #include "qspotifytracklist.h"
 #include "qspotifyuser.h"
 #include "qspotifycachemanager.h"
+#include "qspotifymemory.h"
+#include "qspotifymetrics.h"
 #include "qspotifyutil.h"
 
 #include "listmodels/qspotifyartistlist.h"
@@ -105,6 +107,7 @@ void QSpotifyArtistBrowse::setArtist(QSpotifyArtist *artist)
     emit busyChanged();
 
     QMutexLocker lock(&g_mutex);
+    m_requestTimer.start();
     m_sp_artistbrowse = sp_artistbrowse_create(QSpotifySession::instance()->spsession(),
                                                m_artist->spartist(),
                                                SP_ARTISTBROWSE_NO_TRACKS,
@@ -122,6 +125,8 @@ bool QSpotifyArtistBrowse::event(QEvent *e)
         g_mutex.lock();
         g_artistBrowseObjects.remove(m_sp_artistbrowse);
         g_mutex.unlock();
+        static QSpotifyMetrics::Histogram *latency = QSpotifyMetrics::instance().histogram(QLatin1String("artistBrowse.latencyMs"));
+        latency->observe(m_requestTimer);
         processData();
         e->accept();
         return true;
@@ -149,6 +154,7 @@ void QSpotifyArtistBrowse::clearData()
 
 void QSpotifyArtistBrowse::processData()
 {
+    QSpotifyMemoryTag memoryTag("artistBrowse");
     if (m_sp_artistbrowse) {
         m_dataReady = true;
 
@@ -209,14 +215,16 @@ void QSpotifyArtistBrowse::processData()
 
 void QSpotifyArtistBrowse::processTopHits()
 {
+    QSpotifyMemoryTag memoryTag("artistBrowse");
     m_topHitsReady = true;
     m_topTracks->clear();
-    int c = m_topHitsSearch->trackResults()->count();
+    auto results = m_topHitsSearch->trackResults();
+    int c = results->count();
     for (int i = 0; i < c && m_topTracks->count() < 10; ++i) {
-        auto t = m_topHitsSearch->trackResults()->at(i);
-        t->addRef();
-        QStringList artists = t->artists().split(", ");
+        QStringList artists = results->records().artists(i).split(", ");
         if (artists.contains(m_artist->name())) {
+            auto t = results->at(i);
+            t->addRef();
             m_topTracks->appendRow(t);
         }
     }
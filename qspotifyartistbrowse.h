@@ -42,6 +42,7 @@
 #ifndef QSPOTIFYARTISTBROWSE_H
 #define QSPOTIFYARTISTBROWSE_H
 
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QStringList>
 
 #include "qspotifysearch.h"
@@ -113,6 +114,7 @@ private:
     QStringList m_biography;
     QSpotifyArtistList *m_similarArtists;
     bool m_busy{};
+    QElapsedTimer m_requestTimer;
     QSpotifySearch *m_topHitsSearch;
 
     bool m_topHitsReady{};
@@ -8,9 +8,12 @@
 
 #include "qspotifysession.h"
 #include "qspotifyevents.h"
+#include "qspotifyeventwatchdog.h"
+#include "qspotifytrace.h"
 
 QSpotifyRingbuffer g_buffer;
 QMutex g_mutex;
+QSpotifyMetrics::Gauge *g_audioBufferFill = QSpotifyMetrics::instance().gauge(QLatin1String("audio.bufferFillBytes"));
 
 QMutex g_imageRequestMutex;
 QHash<QString, QWaitCondition *> g_imageRequestConditions;
@@ -25,7 +28,7 @@ bool QSpotifyAudioThreadWorker::event(QEvent *e)
 {
     // Ignore timer events to have less log trashing
     if(e->type() != QEvent::Timer)
-        qDebug() << "QSpotifyAudioThreadWorker::event" << e->type();
+        qCDebug(lcPlayback) << "QSpotifyAudioThreadWorker::event" << e->type();
     if (e->type() == StreamingStartedEventType) {
         QMutexLocker lock(&g_mutex);
         QSpotifyStreamingStartedEvent *ev = static_cast<QSpotifyStreamingStartedEvent *>(e);
@@ -52,6 +55,7 @@ bool QSpotifyAudioThreadWorker::event(QEvent *e)
         QMutexLocker lock(&g_mutex);
         killTimer(m_audioTimerID);
         g_buffer.close();
+        g_audioBufferFill->set(0);
         if (m_audioOutput) {
             m_audioOutput->stop();
             m_audioOutput->deleteLater();
@@ -66,6 +70,7 @@ bool QSpotifyAudioThreadWorker::event(QEvent *e)
             killTimer(m_audioTimerID);
             m_audioOutput->reset();
             g_buffer.reset();
+            g_audioBufferFill->set(0);
             startAudioOutput();
         }
         e->accept();
@@ -83,7 +88,7 @@ bool QSpotifyAudioThreadWorker::event(QEvent *e)
 
 void QSpotifyAudioThreadWorker::startStreaming(int channels, int sampleRate)
 {
-    qDebug() << "QSpotifyAudioThreadWorker::startStreaming";
+    qCDebug(lcPlayback) << "QSpotifyAudioThreadWorker::startStreaming";
     if (!m_audioOutput) {
         QAudioFormat af;
         af.setChannelCount(channels);
@@ -99,7 +104,7 @@ void QSpotifyAudioThreadWorker::startStreaming(int channels, int sampleRate)
                 QAudioDeviceInfo dev = devices[i];
                 qWarning() << dev.deviceName();
             }
-            QCoreApplication::postEvent(QSpotifySession::instance(), new QEvent(QEvent::Type(StopEventType)));
+            QSpotifyEventWatchdog::postEvent(QSpotifySession::instance(), new QEvent(QEvent::Type(StopEventType)));
             return;
         }
 
@@ -121,6 +126,7 @@ void QSpotifyAudioThreadWorker::updateAudioBuffer()
     int toRead = qMin(g_buffer.filledBytes(), m_audioOutput->bytesFree());
     char data[toRead];
     int read =  g_buffer.read(&data[0], toRead);
+    g_audioBufferFill->set(g_buffer.filledBytes());
     g_mutex.unlock();
 
     m_iodevice->write(&data[0], read);
@@ -129,7 +135,7 @@ void QSpotifyAudioThreadWorker::updateAudioBuffer()
     if (m_timeCounter >= 1000) {
         m_timeCounter = 0;
         int elapsedTime = int(m_audioOutput->processedUSecs() / 1000);
-        QCoreApplication::postEvent(QSpotifySession::instance(), new QSpotifyTrackProgressEvent(elapsedTime - m_previousElapsedTime));
+        QSpotifyEventWatchdog::postEvent(QSpotifySession::instance(), new QSpotifyTrackProgressEvent(elapsedTime - m_previousElapsedTime));
         m_previousElapsedTime = elapsedTime;
     }
 }
@@ -9,12 +9,14 @@
 #include <QtGui/QImage>
 #include <libspotify/api.h>
 
+#include "qspotifymetrics.h"
 #include "qspotifyringbuffer.h"
 
 #define AUDIOSTREAM_UPDATE_INTERVAL 20
 
 extern QSpotifyRingbuffer g_buffer;
 extern QMutex g_mutex;
+extern QSpotifyMetrics::Gauge *g_audioBufferFill;
 
 extern QMutex g_imageRequestMutex;
 extern QHash<QString, QWaitCondition *> g_imageRequestConditions;
@@ -7,59 +7,267 @@
 #include <QtCore/QHash>
 #include <QtCore/QMutex>
 #include <QtCore/QMutexLocker>
+#include <QtCore/QSemaphore>
 #include <QtCore/QThread>
 
 #include <QtCore/QDebug>
 
 #include <libspotify/api.h>
 
+#include <functional>
+
 #include "qspotifytrack.h"
+#include "qspotifytrackrecords.h"
 #include "qspotifyplaylist.h"
 #include "qspotifyartist.h"
 #include "qspotifyalbum.h"
+#include "qspotifyevents.h"
+#include "qspotifyeventwatchdog.h"
+#include "qspotifysession.h"
+
+namespace {
+
+class CallEvent : public QEvent
+{
+public:
+    CallEvent(const std::function<void()> &call, QSemaphore *done)
+        : QEvent(QEvent::User)
+        , m_call(call)
+        , m_done(done)
+    { }
+    // Also when the event is discarded, the caller must not wait forever
+    ~CallEvent() { m_done->release(); }
+
+    void run() { m_call(); }
+
+private:
+    std::function<void()> m_call;
+    QSemaphore *m_done;
+};
+
+class SessionThreadInvoker : public QObject
+{
+protected:
+    bool event(QEvent *e)
+    {
+        if (e->type() == QEvent::User) {
+            static_cast<CallEvent *>(e)->run();
+            return true;
+        }
+        return QObject::event(e);
+    }
+};
+
+bool isSessionThread()
+{
+    return QThread::currentThread() == QSpotifySession::instance()->thread();
+}
+
+// Runs call on the session's thread and waits for it.
+void runOnSessionThread(const std::function<void()> &call)
+{
+    static SessionThreadInvoker *invoker = [] {
+        auto invoker = new SessionThreadInvoker;
+        invoker->moveToThread(QSpotifySession::instance()->thread());
+        return invoker;
+    }();
+    QSemaphore done;
+    QCoreApplication::postEvent(invoker, new CallEvent(call, &done));
+    done.acquire();
+}
+
+}
+
+static QSpotifyCacheManager::TypeStats registerStats(const QString &prefix)
+{
+    QSpotifyMetrics &metrics = QSpotifyMetrics::instance();
+    QSpotifyCacheManager::TypeStats stats;
+    stats.size = metrics.gauge(prefix + QLatin1String(".size"));
+    stats.hits = metrics.counter(prefix + QLatin1String(".hits"));
+    stats.misses = metrics.counter(prefix + QLatin1String(".misses"));
+    stats.revivals = metrics.counter(prefix + QLatin1String(".revivals"));
+    stats.evictions = metrics.counter(prefix + QLatin1String(".evictions"));
+    stats.poolChunks = metrics.gauge(prefix + QLatin1String(".poolChunks"));
+    return stats;
+}
+
+QSpotifyCacheManager::QSpotifyCacheManager()
+{
+    m_stats[QSpotifyObject::CachedTrack] = registerStats(QLatin1String("cache.tracks"));
+    m_stats[QSpotifyObject::CachedAlbum] = registerStats(QLatin1String("cache.albums"));
+    m_stats[QSpotifyObject::CachedArtist] = registerStats(QLatin1String("cache.artists"));
+}
 
 QSpotifyCacheManager &QSpotifyCacheManager::instance() {
     static QSpotifyCacheManager inst;
     return inst;
 }
 
+QMutex *QSpotifyCacheManager::shardMutex(QSpotifyObject *obj)
+{
+    switch (obj->cacheType()) {
+    case QSpotifyObject::CachedTrack:
+        return &m_tracks.shard(static_cast<QSpotifyTrack *>(obj)->sptrack()).mutex;
+    case QSpotifyObject::CachedAlbum:
+        return &m_albums.shard(static_cast<QSpotifyAlbum *>(obj)->spalbum()).mutex;
+    case QSpotifyObject::CachedArtist:
+        return &m_artists.shard(static_cast<QSpotifyArtist *>(obj)->spartist()).mutex;
+    default:
+        return nullptr;
+    }
+}
+
 void QSpotifyCacheManager::removeObject(QSpotifyObject *obj)
 {
-    if (auto track = dynamic_cast<QSpotifyTrack*>(obj)) {
-        auto it = m_tracks.find(track->sptrack());
-        if (it != m_tracks.end()) m_tracks.erase(it);
-    } else if (auto album = dynamic_cast<QSpotifyAlbum*>(obj)) {
-        auto it = m_albums.find(album->spalbum());
-        if (it != m_albums.end()) m_albums.erase(it);
-    } else if (auto artist = dynamic_cast<QSpotifyArtist*>(obj)) {
-        auto it = m_artists.find(artist->spartist());
-        if (it != m_artists.end()) m_artists.erase(it);
-    } else {
-        qDebug() << "Try to remove unknown object from cache";
+    switch (obj->cacheType()) {
+    case QSpotifyObject::CachedTrack: {
+        sp_track *t = static_cast<QSpotifyTrack *>(obj)->sptrack();
+        m_tracks.shard(t).objects.remove(t);
+        break;
+    }
+    case QSpotifyObject::CachedAlbum: {
+        sp_album *a = static_cast<QSpotifyAlbum *>(obj)->spalbum();
+        m_albums.shard(a).objects.remove(a);
+        break;
+    }
+    case QSpotifyObject::CachedArtist: {
+        sp_artist *a = static_cast<QSpotifyArtist *>(obj)->spartist();
+        m_artists.shard(a).objects.remove(a);
+        break;
+    }
+    default:
+        return;
+    }
+    m_stats[obj->cacheType()].size->add(-1);
+    obj->m_cacheType = QSpotifyObject::NotCached;
+}
+
+void QSpotifyCacheManager::releaseLast(QSpotifyObject *obj)
+{
+    // Lookups only hand out objects under the shard lock, so nobody can
+    // take a new reference between dropping the last one and retiring.
+    // The cache type only changes while nobody holds a reference.
+    QMutexLocker lock(shardMutex(obj));
+    bool last = !obj->m_refCount.deref();
+    Q_ASSERT(obj->m_refCount.load() >= 0);
+    if (!last)
+        return;
+
+    if (retain(obj)) {
+        lock.unlock();
+        evictRetained();
+        return;
+    }
+    removeObject(obj);
+    lock.unlock();
+    obj->retire();
+    obj->destroy();
+}
+
+template <typename Key, typename Object>
+Object *QSpotifyCacheManager::lookup(Shard<Key, Object> &shard, Key *key, bool *revived)
+{
+    Object *ptr = shard.objects.value(key);
+    *revived = false;
+    if (ptr) {
+        m_stats[ptr->cacheType()].hits->add();
+        if (ptr->refCount() == 0) {
+            takeRetained(ptr);
+            ptr->m_reviving = true;
+            *revived = true;
+        }
+        ptr->addRef();
+    }
+    return ptr;
+}
+
+template <typename Key, typename Object>
+Object *QSpotifyCacheManager::lookupLive(Shard<Key, Object> &shard, Key *key)
+{
+    QMutexLocker lock(&shard.mutex);
+    Object *ptr = shard.objects.value(key);
+    if (!ptr || ptr->refCount() == 0 || ptr->m_reviving)
+        return nullptr;
+    m_stats[ptr->cacheType()].hits->add();
+    ptr->addRef();
+    return ptr;
+}
+
+template <typename Key, typename Object>
+void QSpotifyCacheManager::finishRevive(Shard<Key, Object> &shard, Object *obj)
+{
+    obj->revive();
+    QMutexLocker lock(&shard.mutex);
+    obj->m_reviving = false;
+}
+
+template <typename Key, typename Object>
+Object *QSpotifyCacheManager::insert(Shard<Key, Object> &shard, Key *key, Object *obj, QSpotifyObject::CacheType type, bool *revived)
+{
+    *revived = false;
+    Object *&slot = shard.objects[key];
+    if (slot) {
+        // Another thread created one meanwhile, ours is still uncached
+        Object *existing = lookup(shard, key, revived);
+        obj->release();
+        return existing;
     }
+    slot = obj;
+    obj->m_cacheType = type;
+    m_stats[type].misses->add();
+    m_stats[type].size->add(1);
+    return obj;
+}
+
+// Objects are initialized outside of the shard locks since init() and
+// revive() call into libspotify and emit signals. Both only run on the
+// session's thread, which owns the objects and their libspotify calls.
+template <typename Object, typename... Args>
+Object *QSpotifyCacheManager::createObject(Args... args)
+{
+    Q_ASSERT(isSessionThread());
+    auto obj = new Object(args...);
+    obj->init();
+    return obj;
 }
 
 QSpotifyTrack *QSpotifyCacheManager::getTrack(sp_track *t, QSpotifyPlaylist *playlist)
 {
     Q_ASSERT(t);
-    auto iter = m_tracks.find(t);
-    if(iter != m_tracks.end()) {
-        if(auto ptr = iter.value()) {
-            ptr->addRef();
+    auto &shard = m_tracks.shard(t);
+    if (!isSessionThread()) {
+        if (auto ptr = lookupLive(shard, t))
             return ptr;
-        }
+        QSpotifyTrack *ptr = nullptr;
+        runOnSessionThread([&] { ptr = getTrack(t, playlist); });
+        return ptr;
     }
 
-    auto qtrack = new QSpotifyTrack(t, playlist);
-    qtrack->init();
-    // XXX: possibility to not display unavalaible tracks: if (!qtrack->isAvailable()) return nullptr;
+    bool revived = false;
+    QMutexLocker lock(&shard.mutex);
+    auto ptr = lookup(shard, t, &revived);
+    lock.unlock();
 
-    m_tracks.insert(t, qtrack);
-
-    if(playlist) {
-        playlist->registerTrackType(qtrack);
+    if (!ptr) {
+        auto qtrack = createObject<QSpotifyTrack>(t, playlist);
+        // XXX: possibility to not display unavalaible tracks: if (!qtrack->isAvailable()) return nullptr;
+        lock.relock();
+        ptr = insert(shard, t, qtrack, QSpotifyObject::CachedTrack, &revived);
+        lock.unlock();
+    }
+    if (revived) {
+        ptr->m_playlist = playlist;
+        finishRevive(shard, ptr);
     }
-    return qtrack;
+    return ptr;
+}
+
+QSpotifyTrack *QSpotifyCacheManager::findTrack(sp_track *t)
+{
+    // Objects are only deleted from the GUI thread's event loop
+    auto &shard = m_tracks.shard(t);
+    QMutexLocker lock(&shard.mutex);
+    return shard.objects.value(t);
 }
 
 QSpotifyArtist *QSpotifyCacheManager::getArtist(sp_artist *a)
@@ -69,20 +277,29 @@ QSpotifyArtist *QSpotifyCacheManager::getArtist(sp_artist *a)
         return nullptr;
     }
 
-    auto iter = m_artists.find(a);
-    if(iter != m_artists.end()) {
-        if(auto ptr = iter.value()) {
-            ptr->addRef();
+    auto &shard = m_artists.shard(a);
+    if (!isSessionThread()) {
+        if (auto ptr = lookupLive(shard, a))
             return ptr;
-        }
+        QSpotifyArtist *ptr = nullptr;
+        runOnSessionThread([&] { ptr = getArtist(a); });
+        return ptr;
     }
 
-    auto artPtr = new QSpotifyArtist(a);
-    artPtr->init();
+    bool revived = false;
+    QMutexLocker lock(&shard.mutex);
+    auto ptr = lookup(shard, a, &revived);
+    lock.unlock();
 
-    m_artists.insert(a, artPtr);
-
-    return artPtr;
+    if (!ptr) {
+        auto artPtr = createObject<QSpotifyArtist>(a);
+        lock.relock();
+        ptr = insert(shard, a, artPtr, QSpotifyObject::CachedArtist, &revived);
+        lock.unlock();
+    }
+    if (revived)
+        finishRevive(shard, ptr);
+    return ptr;
 }
 
 QSpotifyAlbum *QSpotifyCacheManager::getAlbum(sp_album *a)
@@ -92,23 +309,193 @@ QSpotifyAlbum *QSpotifyCacheManager::getAlbum(sp_album *a)
         return nullptr;
     }
 
-    auto iter = m_albums.find(a);
-    if(iter != m_albums.end()) {
-        if(auto ptr = iter.value()) {
-            ptr->addRef();
+    auto &shard = m_albums.shard(a);
+    if (!isSessionThread()) {
+        if (auto ptr = lookupLive(shard, a))
             return ptr;
+        QSpotifyAlbum *ptr = nullptr;
+        runOnSessionThread([&] { ptr = getAlbum(a); });
+        return ptr;
+    }
+
+    bool revived = false;
+    QMutexLocker lock(&shard.mutex);
+    auto ptr = lookup(shard, a, &revived);
+    lock.unlock();
+
+    if (!ptr) {
+        auto albPtr = createObject<QSpotifyAlbum>(a);
+        lock.relock();
+        ptr = insert(shard, a, albPtr, QSpotifyObject::CachedAlbum, &revived);
+        lock.unlock();
+    }
+    if (revived)
+        finishRevive(shard, ptr);
+    return ptr;
+}
+
+bool QSpotifyCacheManager::retain(QSpotifyObject *obj)
+{
+    QMutexLocker lock(&m_retainedMutex);
+    if (m_maxRetained <= 0 || obj->cacheType() == QSpotifyObject::NotCached)
+        return false;
+
+    obj->retire();
+    int size = obj->estimatedSize();
+    m_retained.push_front(qMakePair(obj, size));
+    m_retainedPos.insert(obj, m_retained.begin());
+    m_retainedBytes += size;
+    return true;
+}
+
+void QSpotifyCacheManager::takeRetained(QSpotifyObject *obj)
+{
+    QMutexLocker lock(&m_retainedMutex);
+    auto it = m_retainedPos.find(obj);
+    Q_ASSERT(it != m_retainedPos.end());
+    m_retainedBytes -= it.value()->second;
+    m_retained.erase(it.value());
+    m_retainedPos.erase(it);
+    m_stats[obj->cacheType()].revivals->add();
+}
+
+bool QSpotifyCacheManager::evictRetained()
+{
+    QList<QSpotifyObject *> evicted;
+    bool done = true;
+    {
+        QMutexLocker lock(&m_retainedMutex);
+        while (!m_retained.empty()
+               && (int(m_retainedPos.size()) > m_maxRetained || m_retainedBytes > m_maxRetainedBytes)) {
+            QSpotifyObject *obj = m_retained.back().first;
+            // Lookups take the shard lock before this one; waiting for the
+            // shard here could deadlock, so leave the rest for next time.
+            QMutex *shard = shardMutex(obj);
+            if (!shard->tryLock()) {
+                done = false;
+                break;
+            }
+            m_retainedBytes -= m_retained.back().second;
+            m_retained.pop_back();
+            m_retainedPos.remove(obj);
+            m_stats[obj->cacheType()].evictions->add();
+            removeObject(obj);
+            shard->unlock();
+            evicted.append(obj);
         }
     }
+    for (QSpotifyObject *obj : evicted)
+        obj->destroy();
+    return done;
+}
+
+void QSpotifyCacheManager::clearRetained()
+{
+    QMutexLocker lock(&m_retainedMutex);
+    int maxRetained = m_maxRetained;
+    m_maxRetained = 0;
+    lock.unlock();
+    while (!evictRetained())
+        QThread::yieldCurrentThread();
+    lock.relock();
+    m_maxRetained = maxRetained;
+}
+
+void QSpotifyCacheManager::setRetentionLimits(int maxObjects, int maxBytes)
+{
+    {
+        QMutexLocker lock(&m_retainedMutex);
+        m_maxRetained = maxObjects;
+        m_maxRetainedBytes = maxBytes;
+    }
+    evictRetained();
+}
+
+int QSpotifyCacheManager::retainedCount() const
+{
+    QMutexLocker lock(&m_retainedMutex);
+    return m_retainedPos.size();
+}
+
+int QSpotifyCacheManager::retainedBytes() const
+{
+    QMutexLocker lock(&m_retainedMutex);
+    return m_retainedBytes;
+}
 
-    auto albPtr = new QSpotifyAlbum(a);
-    albPtr->init();
+void QSpotifyCacheManager::scheduleDestroy(QSpotifyObject *obj)
+{
+    QMutexLocker lock(&m_destroyMutex);
+    m_pendingDestroy.append(obj);
+    if (!m_destroyEventPosted) {
+        m_destroyEventPosted = true;
+        QSpotifyEventWatchdog::postEvent(QSpotifySession::instance(), new QEvent(QEvent::Type(DestroyObjectsEventType)));
+    }
+}
 
-    m_albums.insert(a, albPtr);
+void QSpotifyCacheManager::destroyPending()
+{
+    // Destructors release albums and artists, which may schedule a new batch
+    QList<QSpotifyObject *> pending;
+    {
+        QMutexLocker lock(&m_destroyMutex);
+        pending.swap(m_pendingDestroy);
+        m_destroyEventPosted = false;
+    }
+    qDeleteAll(pending);
 
-    return albPtr;
+    QSpotifyObjectPool<QSpotifyTrack>::trim();
+    QSpotifyObjectPool<QSpotifyAlbum>::trim();
+    QSpotifyObjectPool<QSpotifyArtist>::trim();
+    updateGauges();
 }
 
-void QSpotifyCacheManager::cacheInfo()
+void QSpotifyCacheManager::updateGauges()
 {
-    qDebug() << "#Cache Info: Tracks" << m_tracks.size() << "Artists" << m_artists.size() << "Ablums" << m_albums.size();
+    m_stats[QSpotifyObject::CachedTrack].poolChunks->set(QSpotifyObjectPool<QSpotifyTrack>::stats().chunks);
+    m_stats[QSpotifyObject::CachedAlbum].poolChunks->set(QSpotifyObjectPool<QSpotifyAlbum>::stats().chunks);
+    m_stats[QSpotifyObject::CachedArtist].poolChunks->set(QSpotifyObjectPool<QSpotifyArtist>::stats().chunks);
+}
+
+template <typename T>
+static QVariantMap typeStatistics(const QSpotifyCacheManager::TypeStats &stats)
+{
+    typename QSpotifyObjectPool<T>::Stats pool = QSpotifyObjectPool<T>::stats();
+    QVariantMap map;
+    map.insert(QLatin1String("size"), stats.size->value());
+    map.insert(QLatin1String("hits"), stats.hits->value());
+    map.insert(QLatin1String("misses"), stats.misses->value());
+    map.insert(QLatin1String("revivals"), stats.revivals->value());
+    map.insert(QLatin1String("evictions"), stats.evictions->value());
+    map.insert(QLatin1String("poolLive"), pool.live);
+    map.insert(QLatin1String("poolPeak"), pool.peak);
+    map.insert(QLatin1String("poolChunks"), pool.chunks);
+    map.insert(QLatin1String("poolAllocations"), pool.allocations);
+    map.insert(QLatin1String("poolFragmentation"), pool.fragmentation);
+    return map;
+}
+
+QVariantMap QSpotifyCacheManager::statistics() const
+{
+    QVariantMap map;
+    QVariantMap tracks = typeStatistics<QSpotifyTrack>(m_stats[QSpotifyObject::CachedTrack]);
+    qint64 trackBytes = 0;
+    int trackCount = 0;
+    for (auto &shard : m_tracks.shards) {
+        QMutexLocker lock(&shard.mutex);
+        for (auto track : shard.objects)
+            trackBytes += track->estimatedSize();
+        trackCount += shard.objects.size();
+    }
+    tracks.insert(QLatin1String("bytesPerObject"), trackCount ? int(trackBytes / trackCount) : 0);
+    map.insert(QLatin1String("tracks"), tracks);
+    map.insert(QLatin1String("trackRecords"), QSpotifyTrackRecords::statistics());
+    map.insert(QLatin1String("strings"), QSpotifyInternedString::statistics());
+    map.insert(QLatin1String("albums"), typeStatistics<QSpotifyAlbum>(m_stats[QSpotifyObject::CachedAlbum]));
+    map.insert(QLatin1String("artists"), typeStatistics<QSpotifyArtist>(m_stats[QSpotifyObject::CachedArtist]));
+    map.insert(QLatin1String("retained"), retainedCount());
+    map.insert(QLatin1String("retainedBytes"), retainedBytes());
+    QMutexLocker lock(&m_destroyMutex);
+    map.insert(QLatin1String("pendingDestroy"), m_pendingDestroy.count());
+    return map;
 }
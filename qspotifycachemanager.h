@@ -2,6 +2,15 @@
 #define QSPOTIFYCACHEMANAGER_H
 
 #include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QPair>
+#include <QtCore/QVariantMap>
+
+#include <list>
+
+#include "qspotifymetrics.h"
+#include "qspotifyobject.h"
 
 class QSpotifyTrack;
 class QSpotifyPlaylist;
@@ -12,30 +21,130 @@ struct sp_track;
 struct sp_artist;
 struct sp_album;
 
-
-class QSpotifyObject;
-
+/**
+ * Owns the track, album and artist objects handed out for libspotify
+ * pointers, so that every sp_track etc. has at most one QSpotifyObject.
+ *
+ * Thread safe: the hashes are split into shards with a lock each, so
+ * worker threads building result lists can look up objects alongside the
+ * GUI thread. Objects are only created, initialized, revived and deleted
+ * on the session's thread; getters called elsewhere take live objects
+ * straight from the shards and leave everything else to a blocking call
+ * on the session's thread. Note that libspotify itself is not thread safe;
+ * workers still have to serialize their own libspotify calls.
+ */
 class QSpotifyCacheManager
 {
 public:
     static QSpotifyCacheManager& instance();
 
-    void removeObject(QSpotifyObject *obj);
+    enum {
+        DefaultMaxRetained = 1000,
+        DefaultMaxRetainedBytes = 2 * 1024 * 1024
+    };
+
+    enum { ShardCount = 16 };
+
+    // Objects whose last reference is released are kept in a bounded LRU
+    // pool and handed out again by the getters below instead of being
+    // recreated; releaseLast() is called by QSpotifyObject::release().
+    void releaseLast(QSpotifyObject *obj);
+    void clearRetained();
+    void setRetentionLimits(int maxObjects, int maxBytes);
+    int retainedCount() const;
+    int retainedBytes() const;
+
+    // Tracks, albums and artists are deleted in one batch from the session's
+    // event loop, like deleteLater() but with one posted event per batch.
+    // Unlike deleteLater() the batch is also deleted in nested event loops,
+    // so other objects keep using deleteLater().
+    void scheduleDestroy(QSpotifyObject *obj);
+    void destroyPending();
+
     QSpotifyTrack *getTrack(sp_track *t, QSpotifyPlaylist *playlist = nullptr);
+    // The object for t if there is one, including retained ones, without
+    // taking a reference. Only valid until control returns to the event
+    // loop; GUI thread only.
+    QSpotifyTrack *findTrack(sp_track *t);
     QSpotifyArtist *getArtist(sp_artist *a);
     QSpotifyAlbum *getAlbum(sp_album *a);
 
-    void cacheInfo();
+    struct TypeStats {
+        QSpotifyMetrics::Gauge *size;
+        QSpotifyMetrics::Counter *hits;
+        QSpotifyMetrics::Counter *misses;
+        QSpotifyMetrics::Counter *revivals;
+        QSpotifyMetrics::Counter *evictions;
+        QSpotifyMetrics::Gauge *poolChunks;
+    };
+
+    // Only for the cached types, NotCached has no statistics.
+    const TypeStats &stats(QSpotifyObject::CacheType type) const
+    { Q_ASSERT(type != QSpotifyObject::NotCached); return m_stats[type]; }
+    QVariantMap statistics() const;
+
 private:
-    QSpotifyCacheManager() = default;
+    QSpotifyCacheManager();
+
+    template <typename Key, typename Object>
+    struct Shard {
+        mutable QMutex mutex;
+        QHash<Key *, Object *> objects;
+    };
+
+    template <typename Key, typename Object>
+    struct ShardedHash {
+        Shard<Key, Object> shards[ShardCount];
+
+        Shard<Key, Object> &shard(const Key *key)
+        { return shards[(quintptr(key) / sizeof(void *)) % ShardCount]; }
+    };
+
+    // Both return the object with a new reference and must be called with
+    // the shard locked; if *revived is set the caller has to call
+    // finishRevive() on it after unlocking. Session thread only.
+    template <typename Key, typename Object>
+    Object *lookup(Shard<Key, Object> &shard, Key *key, bool *revived);
+    // Locks the shard; nullptr unless the object is referenced and not
+    // being revived, so it can be handed out on any thread.
+    template <typename Key, typename Object>
+    Object *lookupLive(Shard<Key, Object> &shard, Key *key);
+    template <typename Key, typename Object>
+    void finishRevive(Shard<Key, Object> &shard, Object *obj);
+    template <typename Object, typename... Args>
+    static Object *createObject(Args... args);
+    template <typename Key, typename Object>
+    Object *insert(Shard<Key, Object> &shard, Key *key, Object *obj, QSpotifyObject::CacheType type, bool *revived);
+
+    void updateGauges();
+    // Lock of the shard holding obj, nullptr if it is not cached.
+    QMutex *shardMutex(QSpotifyObject *obj);
+    // These must be called with the shard of obj locked.
+    void removeObject(QSpotifyObject *obj);
+    // Returns false if the object should be destroyed.
+    bool retain(QSpotifyObject *obj);
+    void takeRetained(QSpotifyObject *obj);
+    // Returns false if it had to stop early because a shard was busy.
+    bool evictRetained();
+
+    ShardedHash<sp_track, QSpotifyTrack> m_tracks;
+    ShardedHash<sp_artist, QSpotifyArtist> m_artists;
+    ShardedHash<sp_album, QSpotifyAlbum> m_albums;
+
+    // Locked after a shard lock, never before; see evictRetained().
+    mutable QMutex m_retainedMutex;
+    typedef std::list<QPair<QSpotifyObject *, int> > RetainedList;
+    RetainedList m_retained;
+    QHash<QSpotifyObject *, RetainedList::iterator> m_retainedPos;
+    int m_retainedBytes{};
+    int m_maxRetained{DefaultMaxRetained};
+    int m_maxRetainedBytes{DefaultMaxRetainedBytes};
 
-    int numTracks();
-    int numAlbums();
-    int numArtists();
+    mutable QMutex m_destroyMutex;
+    QList<QSpotifyObject *> m_pendingDestroy;
+    bool m_destroyEventPosted{};
 
-    QHash<sp_track *, QSpotifyTrack *> m_tracks;
-    QHash<sp_artist *, QSpotifyArtist *> m_artists;
-    QHash<sp_album *, QSpotifyAlbum *> m_albums;
+    TypeStats m_stats[QSpotifyObject::NumCacheTypes];
 };
 
 #endif // QSPOTIFYCACHEMANAGER_H
@@ -19,3 +19,4 @@ const QEvent::Type LoggedOutEventType = static_cast<QEvent::Type>(QEvent::regist
 const QEvent::Type OfflineErrorEventType = static_cast<QEvent::Type>(QEvent::registerEventType(QEvent::User + 16));
 const QEvent::Type ScrobbleLoginErrorEventType = static_cast<QEvent::Type>(QEvent::registerEventType(QEvent::User + 17));
 const QEvent::Type ConnectionStateUpdateEventType = static_cast<QEvent::Type>(QEvent::registerEventType(QEvent::User + 18));
+const QEvent::Type DestroyObjectsEventType = static_cast<QEvent::Type>(QEvent::registerEventType(QEvent::User + 19));
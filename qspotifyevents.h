@@ -25,6 +25,7 @@ extern const QEvent::Type LoggedOutEventType;
 extern const QEvent::Type OfflineErrorEventType;
 extern const QEvent::Type ScrobbleLoginErrorEventType;
 extern const QEvent::Type ConnectionStateUpdateEventType;
+extern const QEvent::Type DestroyObjectsEventType;
 
 class QSpotifyConnectionErrorEvent : public QEvent
 {
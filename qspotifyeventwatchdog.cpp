@@ -0,0 +1,186 @@
+#include "qspotifyeventwatchdog.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QObject>
+#include <QtCore/QStringList>
+
+#include <algorithm>
+
+#include "qspotifyevents.h"
+
+QAtomicInt QSpotifyEventWatchdog::s_enabled(!qgetenv("QTSPOTIFY_WATCHDOG").isEmpty());
+QAtomicInt QSpotifyEventWatchdog::s_queueDepth;
+
+static const char *sessionEventName(int type)
+{
+    if (type == QEvent::Timer) return "Timer";
+    if (type == NotifyMainThreadEventType) return "NotifyMainThread";
+    if (type == ConnectionErrorEventType) return "ConnectionError";
+    if (type == MetaDataEventType) return "MetaData";
+    if (type == EndOfTrackEventType) return "EndOfTrack";
+    if (type == StopEventType) return "Stop";
+    if (type == TrackProgressEventType) return "TrackProgress";
+    if (type == SendImageRequestEventType) return "SendImageRequest";
+    if (type == ReceiveImageRequestEventType) return "ReceiveImageRequest";
+    if (type == PlayTokenLostEventType) return "PlayTokenLost";
+    if (type == LoggedInEventType) return "LoggedIn";
+    if (type == LoggedOutEventType) return "LoggedOut";
+    if (type == OfflineErrorEventType) return "OfflineError";
+    if (type == ScrobbleLoginErrorEventType) return "ScrobbleLoginError";
+    if (type == ConnectionStateUpdateEventType) return "ConnectionStateUpdate";
+    if (type == DestroyObjectsEventType) return "DestroyObjects";
+    return nullptr;
+}
+
+static const char *playlistEventName(int type)
+{
+    switch (type - QEvent::User) {
+    case 0: return "StateChanged";
+    case 1: return "MetadataUpdated";
+    case 2: return "Renamed";
+    case 3: return "TracksAdded";
+    case 4: return "TracksRemoved";
+    case 5: return "TracksMoved";
+    case 6: return "TrackSeen";
+    case 7: return "Update";
+    default: return nullptr;
+    }
+}
+
+static const char *containerEventName(int type)
+{
+    switch (type - QEvent::User) {
+    case 0: return "Loaded";
+    case 1: return "PlaylistAdded";
+    case 2: return "PlaylistRemoved";
+    case 3: return "PlaylistMoved";
+    case 4: return "Update";
+    default: return nullptr;
+    }
+}
+
+QSpotifyEventWatchdog::QSpotifyEventWatchdog()
+{
+    bool ok = false;
+    m_thresholdMs = qgetenv("QTSPOTIFY_WATCHDOG").toInt(&ok);
+    if (!ok || m_thresholdMs <= 0)
+        m_thresholdMs = 16;
+}
+
+QSpotifyEventWatchdog &QSpotifyEventWatchdog::instance()
+{
+    static QSpotifyEventWatchdog inst;
+    return inst;
+}
+
+void QSpotifyEventWatchdog::setEnabled(bool enabled)
+{
+    if (isEnabled() == enabled)
+        return;
+
+    // Events posted while we were disabled were never counted.
+    s_queueDepth.store(0);
+    s_enabled.storeRelease(enabled);
+}
+
+void QSpotifyEventWatchdog::postEvent(QObject *receiver, QEvent *event)
+{
+    // Called from libspotify threads
+    if (s_enabled.loadAcquire())
+        s_queueDepth.ref();
+    QCoreApplication::postEvent(receiver, event);
+}
+
+void QSpotifyEventWatchdog::Scope::begin()
+{
+    m_className = m_receiver->metaObject()->className();
+    if (m_type >= QEvent::User) {
+        // Only custom events go through postEvent(), everything else
+        // (timers, queued calls) is not part of the tracked depth.
+        m_queueDepth = s_queueDepth.fetchAndAddRelaxed(-1);
+        if (m_queueDepth <= 0) {
+            s_queueDepth.testAndSetRelaxed(m_queueDepth - 1, 0);
+            m_queueDepth = 0;
+        }
+    } else {
+        m_queueDepth = s_queueDepth.load();
+    }
+    m_active = true;
+    m_timer.start();
+}
+
+void QSpotifyEventWatchdog::Scope::end()
+{
+    QSpotifyEventWatchdog::instance().record(m_className, m_type, m_timer.nsecsElapsed(), m_queueDepth);
+}
+
+void QSpotifyEventWatchdog::record(const char *className, int type, qint64 ns, int queueDepth)
+{
+    m_maxQueueDepth = qMax(m_maxQueueDepth, queueDepth);
+
+    Histogram &h = m_histograms[qMakePair(className, type)];
+    if (h.label.isEmpty())
+        h.label = eventLabel(className, type);
+    ++h.count;
+    h.totalNs += ns;
+    h.maxNs = qMax(h.maxNs, ns);
+
+    qint64 ms = ns / 1000000;
+    int bucket = 0;
+    while (bucket < NumBuckets - 1 && ms >= (qint64(1) << bucket))
+        ++bucket;
+    ++h.buckets[bucket];
+
+    if (ms >= m_thresholdMs) {
+        qWarning("QSpotifyEventWatchdog: %s took %.1f ms (threshold %d ms, queue depth %d)",
+                 qPrintable(h.label), ns / 1000000.0, m_thresholdMs, queueDepth);
+    }
+}
+
+QString QSpotifyEventWatchdog::eventLabel(const char *className, int type)
+{
+    const char *name = nullptr;
+    if (qstrcmp(className, "QSpotifySession") == 0)
+        name = sessionEventName(type);
+    else if (qstrcmp(className, "QSpotifyPlaylist") == 0)
+        name = playlistEventName(type);
+    else if (qstrcmp(className, "QSpotifyPlaylistContainer") == 0)
+        name = containerEventName(type);
+
+    QString label = QString::fromLatin1(className) + QLatin1Char('/');
+    if (name)
+        return label + QLatin1String(name);
+    return label + QString::number(type);
+}
+
+QString QSpotifyEventWatchdog::report() const
+{
+    QList<Histogram> hists = histograms();
+    std::sort(hists.begin(), hists.end(), [](const Histogram &a, const Histogram &b) {
+        return a.totalNs > b.totalNs;
+    });
+
+    QStringList lines;
+    lines << QString(QLatin1String("Event loop watchdog: threshold %1 ms, queue depth %2 (max %3)"))
+             .arg(m_thresholdMs).arg(queueDepth()).arg(m_maxQueueDepth);
+    for (const Histogram &h : hists) {
+        QStringList buckets;
+        for (int i = 0; i < NumBuckets; ++i)
+            buckets << QString::number(h.buckets[i]);
+        lines << QString(QLatin1String("  %1: count %2 avg %3 ms max %4 ms [%5]"))
+                 .arg(h.label)
+                 .arg(h.count)
+                 .arg(h.totalNs / 1000000.0 / qMax<quint64>(h.count, 1), 0, 'f', 2)
+                 .arg(h.maxNs / 1000000.0, 0, 'f', 2)
+                 .arg(buckets.join(QLatin1Char(' ')));
+    }
+    return lines.join(QLatin1Char('\n'));
+}
+
+void QSpotifyEventWatchdog::reset()
+{
+    m_histograms.clear();
+    m_maxQueueDepth = 0;
+    s_queueDepth.store(0);
+}
@@ -0,0 +1,103 @@
+#ifndef QSPOTIFYEVENTWATCHDOG_H
+#define QSPOTIFYEVENTWATCHDOG_H
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QEvent>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QPair>
+#include <QtCore/QString>
+
+class QObject;
+
+/**
+ * Measures how long the GUI thread spends in the custom event handlers of
+ * the session, the playlists and the playlist container.
+ *
+ * Disabled by default. Set QTSPOTIFY_WATCHDOG to the stall threshold in ms
+ * (e.g. QTSPOTIFY_WATCHDOG=16) or call setEnabled(). When disabled a Scope
+ * costs one branch on a static flag.
+ *
+ * Recording is not synchronized and must only happen on the GUI thread,
+ * postEvent() may be called from any thread.
+ */
+class QSpotifyEventWatchdog
+{
+public:
+    enum { NumBuckets = 12 };
+
+    struct Histogram {
+        QString label;
+        quint64 count{};
+        qint64 totalNs{};
+        qint64 maxNs{};
+        // Bucket i counts handlers that took less than 2^i ms, the last
+        // bucket collects everything slower.
+        quint64 buckets[NumBuckets]{};
+    };
+
+    class Scope
+    {
+    public:
+        Scope(const QObject *receiver, const QEvent *e)
+            : m_receiver(receiver), m_type(e->type())
+        {
+            if (QSpotifyEventWatchdog::isEnabled())
+                begin();
+        }
+        ~Scope()
+        {
+            if (m_active)
+                end();
+        }
+
+    private:
+        void begin();
+        void end();
+
+        const QObject *m_receiver;
+        const char *m_className{};
+        int m_type;
+        QElapsedTimer m_timer;
+        bool m_active{};
+        int m_queueDepth{};
+
+        Scope(const Scope &) = delete;
+    };
+
+    static QSpotifyEventWatchdog &instance();
+
+    static bool isEnabled() { return s_enabled.loadAcquire(); }
+    void setEnabled(bool enabled);
+
+    int threshold() const { return m_thresholdMs; }
+    void setThreshold(int ms) { m_thresholdMs = ms; }
+
+    // Use instead of QCoreApplication::postEvent() for events handled by
+    // a watched receiver so that the posted event queue depth is tracked.
+    static void postEvent(QObject *receiver, QEvent *event);
+
+    int queueDepth() const { return s_queueDepth.load(); }
+    int maxQueueDepth() const { return m_maxQueueDepth; }
+
+    QList<Histogram> histograms() const { return m_histograms.values(); }
+    QString report() const;
+    void reset();
+
+    static QString eventLabel(const char *className, int type);
+
+private:
+    QSpotifyEventWatchdog();
+
+    void record(const char *className, int type, qint64 ns, int queueDepth);
+
+    static QAtomicInt s_enabled;
+    static QAtomicInt s_queueDepth;
+
+    int m_thresholdMs;
+    int m_maxQueueDepth{};
+    QHash<QPair<const char *, int>, Histogram> m_histograms;
+};
+
+#endif // QSPOTIFYEVENTWATCHDOG_H
@@ -0,0 +1,131 @@
+#include "qspotifyid.h"
+
+#include <QtCore/QDebug>
+
+#include <libspotify/api.h>
+
+static const char g_base62[] = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+static const int g_base62Length = 22;
+
+static const struct {
+    QSpotifyId::Type type;
+    const char *prefix;
+} g_prefixes[] = {
+    { QSpotifyId::Track, "spotify:track:" },
+    { QSpotifyId::Album, "spotify:album:" },
+    { QSpotifyId::Artist, "spotify:artist:" },
+    { QSpotifyId::Image, "spotify:image:" }
+};
+
+static int base62Digit(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'Z') return c - 'A' + 36;
+    return -1;
+}
+
+// 128 bit big endian number from 22 base62 digits
+static bool decodeBase62(const char *s, unsigned char *out)
+{
+    std::memset(out, 0, 16);
+    for (int i = 0; i < g_base62Length; ++i) {
+        int digit = base62Digit(s[i]);
+        if (digit < 0)
+            return false;
+        uint carry = digit;
+        for (int j = 15; j >= 0; --j) {
+            carry += uint(out[j]) * 62;
+            out[j] = carry & 0xff;
+            carry >>= 8;
+        }
+        if (carry)
+            return false;
+    }
+    return true;
+}
+
+static void encodeBase62(const unsigned char *in, char *s)
+{
+    unsigned char n[16];
+    std::memcpy(n, in, sizeof(n));
+    for (int i = g_base62Length - 1; i >= 0; --i) {
+        uint remainder = 0;
+        for (int j = 0; j < 16; ++j) {
+            uint value = (remainder << 8) | n[j];
+            n[j] = value / 62;
+            remainder = value % 62;
+        }
+        s[i] = g_base62[remainder];
+    }
+}
+
+QSpotifyId QSpotifyId::fromImageId(const unsigned char *id)
+{
+    QSpotifyId result;
+    if (id) {
+        std::memcpy(result.m_data, id, 20);
+        result.m_type = Image;
+    }
+    return result;
+}
+
+QSpotifyId QSpotifyId::fromUri(const QByteArray &uri)
+{
+    QSpotifyId result;
+    if (uri.isEmpty())
+        return result;
+    for (const auto &p : g_prefixes) {
+        int prefixLength = int(qstrlen(p.prefix));
+        if (!uri.startsWith(p.prefix))
+            continue;
+        const char *id = uri.constData() + prefixLength;
+        int idLength = uri.size() - prefixLength;
+        if (p.type == Image) {
+            QByteArray bytes = QByteArray::fromHex(QByteArray::fromRawData(id, idLength));
+            if (idLength == 40 && bytes.size() == 20)
+                return fromImageId(reinterpret_cast<const unsigned char *>(bytes.constData()));
+        } else if (idLength == g_base62Length && decodeBase62(id, result.m_data)) {
+            result.m_type = p.type;
+            return result;
+        }
+        break;
+    }
+    // Deep copy, fromLink() passes a stack buffer
+    std::memset(result.m_data, 0, sizeof(result.m_data));
+    result.m_other = QByteArray(uri.constData(), uri.size());
+    result.m_type = Other;
+    return result;
+}
+
+QSpotifyId QSpotifyId::fromLink(sp_link *link)
+{
+    if (!link)
+        return QSpotifyId();
+    char buffer[200];
+    int uriSize = sp_link_as_string(link, &buffer[0], sizeof(buffer));
+    sp_link_release(link);
+    return fromUri(QByteArray::fromRawData(&buffer[0], qMin<int>(uriSize, sizeof(buffer) - 1)));
+}
+
+QByteArray QSpotifyId::toUri() const
+{
+    if (m_type == Invalid)
+        return QByteArray();
+    if (m_type == Other)
+        return m_other;
+
+    QByteArray uri;
+    for (const auto &p : g_prefixes) {
+        if (p.type == m_type)
+            uri = p.prefix;
+    }
+    if (m_type == Image) {
+        uri += QByteArray::fromRawData(reinterpret_cast<const char *>(m_data), 20).toHex();
+    } else {
+        char id[g_base62Length];
+        encodeBase62(m_data, id);
+        uri.append(id, g_base62Length);
+    }
+    return uri;
+}
@@ -0,0 +1,79 @@
+#ifndef QSPOTIFYID_H
+#define QSPOTIFYID_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QString>
+
+#include <cstring>
+
+struct sp_link;
+
+/**
+ * Binary Spotify id of a track, album, artist or image.
+ *
+ * Tracks, albums and artists have 16 byte ids, written base62 in their
+ * URIs; images have 20 byte ids, written as hex. The value is only
+ * formatted to a "spotify:<type>:<id>" URI when it is handed out, e.g.
+ * to QML or the metadata store.
+ *
+ * Other links, like "spotify:local:..." for local tracks, keep their URI
+ * as it is.
+ */
+class QSpotifyId
+{
+public:
+    enum Type : quint8 {
+        Invalid,
+        Track,
+        Album,
+        Artist,
+        Image,
+        // Any other URI, kept as a string
+        Other
+    };
+
+    enum { MaxSize = 20 };
+
+    QSpotifyId() { std::memset(m_data, 0, sizeof(m_data)); }
+
+    static QSpotifyId fromImageId(const unsigned char *id);
+    static QSpotifyId fromUri(const QByteArray &uri);
+    // Releases the link.
+    static QSpotifyId fromLink(sp_link *link);
+
+    Type type() const { return m_type; }
+    bool isValid() const { return m_type != Invalid; }
+    // Empty for Other
+    const unsigned char *data() const { return m_data; }
+    int size() const { return m_type == Image ? 20 : m_type == Invalid || m_type == Other ? 0 : 16; }
+
+    QByteArray toUri() const;
+    QString toString() const { return QString::fromLatin1(toUri()); }
+
+    bool operator==(const QSpotifyId &other) const
+    {
+        return m_type == other.m_type && std::memcmp(m_data, other.m_data, sizeof(m_data)) == 0
+                && m_other == other.m_other;
+    }
+    bool operator!=(const QSpotifyId &other) const { return !(*this == other); }
+
+private:
+    unsigned char m_data[MaxSize];
+    Type m_type{Invalid};
+    QByteArray m_other;
+
+    friend uint qHash(const QSpotifyId &id, uint seed);
+};
+
+inline uint qHash(const QSpotifyId &id, uint seed = 0)
+{
+    if (id.m_type == QSpotifyId::Other)
+        return qHash(id.m_other, seed);
+    // Ids are random already, the first bytes are as good as any hash
+    uint h;
+    std::memcpy(&h, id.data(), sizeof(h));
+    return h ^ id.type() ^ seed;
+}
+
+#endif // QSPOTIFYID_H
@@ -0,0 +1,159 @@
+#include "qspotifylogsink.h"
+
+#include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+
+#include <string.h>
+
+#include "qspotifytrace.h"
+
+static QSpotifyLogSink::Severity severityFromEnv()
+{
+    QByteArray level = qgetenv("QTSPOTIFY_LOG_LEVEL").toUpper();
+    if (level.startsWith('E'))
+        return QSpotifyLogSink::Error;
+    if (level.startsWith('W'))
+        return QSpotifyLogSink::Warning;
+    if (level.startsWith('I'))
+        return QSpotifyLogSink::Info;
+    return QSpotifyLogSink::Debug;
+}
+
+static QElapsedTimer startClock()
+{
+    QElapsedTimer t;
+    t.start();
+    return t;
+}
+
+static const QElapsedTimer g_logClock = startClock();
+
+QSpotifyLogSink::QSpotifyLogSink()
+    : QThread()
+    , m_minSeverity(severityFromEnv())
+{
+    for (int i = 0; i < QueueSize; ++i)
+        m_queue[i].seq.store(i);
+
+    bool ok = false;
+    int rate = qgetenv("QTSPOTIFY_LOG_RATE").toInt(&ok);
+    m_rateLimit = ok && rate >= 0 ? quint32(rate) : 200;
+}
+
+QSpotifyLogSink &QSpotifyLogSink::instance()
+{
+    static QSpotifyLogSink inst;
+    return inst;
+}
+
+QSpotifyLogSink::Severity QSpotifyLogSink::severity(const char *line)
+{
+    const char *space = strchr(line, ' ');
+    if (!space || !space[1] || (space[2] != ' ' && space[2] != '\0'))
+        return Info;
+    switch (space[1]) {
+    case 'E': return Error;
+    case 'W': return Warning;
+    case 'D': return Debug;
+    default: return Info;
+    }
+}
+
+void QSpotifyLogSink::post(const char *line)
+{
+    QSpotifyLogSink &sink = instance();
+    if (!sink.allowedByRate(severity(line)) || !sink.tryPost(line))
+        sink.m_dropped.ref();
+}
+
+bool QSpotifyLogSink::allowedByRate(Severity s)
+{
+    if (m_rateLimit == 0 || s >= Warning)
+        return true;
+
+    quint32 window = quint32(g_logClock.elapsed() / 1000);
+    quint32 current = m_rateWindow.loadAcquire();
+    if (current != window && m_rateWindow.testAndSetOrdered(current, window))
+        m_rateCount.store(0);
+    return m_rateCount.fetchAndAddRelaxed(1) < m_rateLimit;
+}
+
+bool QSpotifyLogSink::tryPost(const char *line)
+{
+    // Bounded multi producer queue: a slot is free for ticket n when its
+    // sequence is n and holds a line for the reader once it is n + 1.
+    quint32 pos = m_tail.loadAcquire();
+    Slot *slot;
+    forever {
+        slot = &m_queue[pos & (QueueSize - 1)];
+        qint32 diff = qint32(slot->seq.loadAcquire() - pos);
+        if (diff == 0) {
+            if (m_tail.testAndSetRelaxed(pos, pos + 1))
+                break;
+            pos = m_tail.loadAcquire();
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = m_tail.loadAcquire();
+        }
+    }
+
+    qstrncpy(slot->text, line, LineSize);
+    slot->seq.storeRelease(pos + 1);
+    return true;
+}
+
+bool QSpotifyLogSink::drain()
+{
+    bool any = false;
+    forever {
+        Slot &slot = m_queue[m_head & (QueueSize - 1)];
+        if (slot.seq.loadAcquire() != m_head + 1)
+            break;
+        write(slot.text);
+        slot.seq.storeRelease(m_head + QueueSize);
+        ++m_head;
+        any = true;
+    }
+
+    quint32 dropped = m_dropped.load();
+    if (dropped != m_reportedDropped) {
+        qCWarning(lcLibspotify, "%u log lines dropped", dropped - m_reportedDropped);
+        m_reportedDropped = dropped;
+    }
+    return any;
+}
+
+void QSpotifyLogSink::write(const char *line)
+{
+    Severity s = severity(line);
+    if (s < m_minSeverity)
+        return;
+
+    if (s == Error)
+        qCCritical(lcLibspotify, "%s", line);
+    else if (s == Warning)
+        qCWarning(lcLibspotify, "%s", line);
+    else if (s == Info)
+        qCInfo(lcLibspotify, "%s", line);
+    else
+        qCDebug(lcLibspotify, "%s", line);
+}
+
+void QSpotifyLogSink::run()
+{
+    while (!m_stop.load()) {
+        if (!drain())
+            msleep(20);
+    }
+    drain();
+}
+
+void QSpotifyLogSink::stop()
+{
+    if (!isRunning())
+        return;
+    m_stop.store(1);
+    wait();
+    m_stop.store(0);
+}
@@ -0,0 +1,79 @@
+#ifndef QSPOTIFYLOGSINK_H
+#define QSPOTIFYLOGSINK_H
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QThread>
+
+/**
+ * Takes libspotify log lines off the libspotify thread.
+ *
+ * post() copies the line into a bounded lock-free queue and returns, a
+ * background thread drains the queue and writes the lines to the
+ * qtspotify.libspotify logging category. When the queue is full or a
+ * burst exceeds the rate limit, lines are dropped and the number of
+ * dropped lines is reported by the writer instead. Error and warning
+ * lines are not rate limited.
+ *
+ * QTSPOTIFY_LOG_LEVEL (E, W, I or D, default D) sets the lowest severity
+ * that is written, QTSPOTIFY_LOG_RATE the number of lines per second let
+ * through (default 200, 0 disables the limit).
+ */
+class QSpotifyLogSink : public QThread
+{
+public:
+    enum Severity {
+        Debug,
+        Info,
+        Warning,
+        Error
+    };
+
+    enum {
+        QueueSize = 256,
+        LineSize = 512
+    };
+
+    static QSpotifyLogSink &instance();
+
+    // Safe to call from any thread, never blocks.
+    static void post(const char *line);
+
+    // libspotify lines look like "12:34:56.789 I [file.cpp:123] text".
+    static Severity severity(const char *line);
+
+    void stop();
+
+    quint32 droppedLines() const { return m_dropped.load(); }
+
+protected:
+    void run() override;
+
+private:
+    QSpotifyLogSink();
+
+    bool tryPost(const char *line);
+    bool allowedByRate(Severity s);
+    bool drain();
+    void write(const char *line);
+
+    struct Slot {
+        QAtomicInteger<quint32> seq;
+        char text[LineSize];
+    };
+
+    Slot m_queue[QueueSize];
+    QAtomicInteger<quint32> m_tail;
+    quint32 m_head{};
+
+    QAtomicInteger<quint32> m_rateWindow;
+    QAtomicInteger<quint32> m_rateCount;
+    quint32 m_rateLimit;
+
+    QAtomicInteger<quint32> m_dropped;
+    quint32 m_reportedDropped{};
+
+    Severity m_minSeverity;
+    QAtomicInt m_stop;
+};
+
+#endif // QSPOTIFYLOGSINK_H
@@ -0,0 +1,186 @@
+#include "qspotifymemory.h"
+
+#include <QtCore/QMutexLocker>
+#include <QtCore/QPair>
+
+#include <algorithm>
+
+#include "qspotifystringpool.h"
+
+#ifndef QT_NO_DEBUG
+namespace {
+enum { MaxTagDepth = 8 };
+thread_local const char *t_tags[MaxTagDepth];
+thread_local int t_tagDepth = 0;
+}
+#endif
+
+void QSpotifyMemory::Account::raise(QAtomicInt &peak, int value)
+{
+    int current = peak.load();
+    while (value > current && !peak.testAndSetRelaxed(current, value))
+        current = peak.load();
+}
+
+void QSpotifyMemory::Account::update(int liveDelta, int bytesDelta)
+{
+    raise(m_peakLive, m_live.fetchAndAddRelaxed(liveDelta) + liveDelta);
+    raise(m_peakBytes, m_bytes.fetchAndAddRelaxed(bytesDelta) + bytesDelta);
+
+    Account &total = QSpotifyMemory::instance().m_total;
+    if (this != &total)
+        total.update(liveDelta, bytesDelta);
+}
+
+QVariantMap QSpotifyMemory::Account::toVariantMap() const
+{
+    QVariantMap map;
+    map.insert(QLatin1String("live"), live());
+    map.insert(QLatin1String("bytes"), bytes());
+    map.insert(QLatin1String("peakLive"), peakLive());
+    map.insert(QLatin1String("peakBytes"), peakBytes());
+    return map;
+}
+
+QSpotifyMemory::QSpotifyMemory()
+{
+    m_clock.start();
+}
+
+QSpotifyMemory &QSpotifyMemory::instance()
+{
+    static QSpotifyMemory inst;
+    return inst;
+}
+
+QSpotifyMemory::Account *QSpotifyMemory::account(const QString &name)
+{
+    QMutexLocker lock(&m_mutex);
+    Account *&a = m_accounts[name];
+    if (!a)
+        a = new Account;
+    return a;
+}
+
+void QSpotifyMemory::track(const void *p, const Account *account)
+{
+#ifndef QT_NO_DEBUG
+    Allocation allocation = { account, QSpotifyMemoryTag::current(), m_clock.elapsed() };
+    QMutexLocker lock(&m_mutex);
+    m_allocations.insert(p, allocation);
+#else
+    Q_UNUSED(p)
+    Q_UNUSED(account)
+#endif
+}
+
+void QSpotifyMemory::untrack(const void *p)
+{
+#ifndef QT_NO_DEBUG
+    QMutexLocker lock(&m_mutex);
+    m_allocations.remove(p);
+#else
+    Q_UNUSED(p)
+#endif
+}
+
+QVariantMap QSpotifyMemory::snapshot() const
+{
+    QVariantMap accounts;
+    {
+        QMutexLocker lock(&m_mutex);
+        for (auto it = m_accounts.constBegin(); it != m_accounts.constEnd(); ++it)
+            accounts.insert(it.key(), it.value()->toVariantMap());
+    }
+
+    QVariantMap map;
+    map.insert(QLatin1String("accounts"), accounts);
+    map.insert(QLatin1String("total"), m_total.toVariantMap());
+    map.insert(QLatin1String("strings"), QSpotifyInternedString::statistics());
+    return map;
+}
+
+QVariantList QSpotifyMemory::longLived(int minAgeMs) const
+{
+    struct Group {
+        QString account;
+        QByteArray tag;
+        int count;
+        qint64 oldest;
+    };
+    QHash<QPair<const Account *, QByteArray>, Group> groups;
+    {
+        QMutexLocker lock(&m_mutex);
+        qint64 now = m_clock.elapsed();
+        for (const Allocation &a : m_allocations) {
+            qint64 age = now - a.created;
+            if (age < minAgeMs)
+                continue;
+            Group &g = groups[qMakePair(a.account, a.tag)];
+            if (g.count++ == 0) {
+                g.account = m_accounts.key(const_cast<Account *>(a.account));
+                g.tag = a.tag;
+            }
+            g.oldest = qMax(g.oldest, age);
+        }
+    }
+
+    QList<Group> sorted = groups.values();
+    std::sort(sorted.begin(), sorted.end(), [](const Group &a, const Group &b) {
+        return a.oldest > b.oldest;
+    });
+
+    QVariantList list;
+    for (const Group &g : sorted) {
+        QVariantMap map;
+        map.insert(QLatin1String("account"), g.account);
+        map.insert(QLatin1String("tag"), QString::fromLatin1(g.tag));
+        map.insert(QLatin1String("count"), g.count);
+        map.insert(QLatin1String("oldestMs"), g.oldest);
+        list.append(map);
+    }
+    return list;
+}
+
+void QSpotifyMemory::resetPeaks()
+{
+    QMutexLocker lock(&m_mutex);
+    for (Account *a : m_accounts) {
+        a->m_peakLive.store(a->live());
+        a->m_peakBytes.store(a->bytes());
+    }
+    m_total.m_peakLive.store(m_total.live());
+    m_total.m_peakBytes.store(m_total.bytes());
+}
+
+QSpotifyMemoryTag::QSpotifyMemoryTag(const char *tag)
+{
+#ifndef QT_NO_DEBUG
+    // Deeper tags are dropped but still counted so the destructor matches
+    if (t_tagDepth < MaxTagDepth)
+        t_tags[t_tagDepth] = tag;
+    ++t_tagDepth;
+#else
+    Q_UNUSED(tag)
+#endif
+}
+
+QSpotifyMemoryTag::~QSpotifyMemoryTag()
+{
+#ifndef QT_NO_DEBUG
+    --t_tagDepth;
+#endif
+}
+
+QByteArray QSpotifyMemoryTag::current()
+{
+    QByteArray tag;
+#ifndef QT_NO_DEBUG
+    for (int i = 0; i < qMin<int>(t_tagDepth, MaxTagDepth); ++i) {
+        if (i)
+            tag += '/';
+        tag += t_tags[i];
+    }
+#endif
+    return tag;
+}
@@ -0,0 +1,106 @@
+#ifndef QSPOTIFYMEMORY_H
+#define QSPOTIFYMEMORY_H
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QMap>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+#include <QtCore/QVariantList>
+#include <QtCore/QVariantMap>
+
+/**
+ * Estimated memory use of the library's object graph, one account per kind
+ * of allocation: "objects.<class>" for every QSpotifyObject subclass,
+ * "models.<class>" for ListModelBase instances and "images.pending" for
+ * decoded images waiting to be handed to QML. Each account keeps the live
+ * count and estimated bytes together with their high-water marks.
+ *
+ * Debug builds also remember every tracked allocation with the tags that
+ * were active when it was made (see QSpotifyMemoryTag), so long-lived
+ * objects can be traced back to the code path that created them.
+ *
+ * Accounts can be updated from any thread. The numbers are readable
+ * through QSpotifySession::memoryStatistics() and over D-Bus.
+ */
+class QSpotifyMemory
+{
+public:
+    class Account
+    {
+    public:
+        void update(int liveDelta, int bytesDelta);
+
+        int live() const { return m_live.load(); }
+        int bytes() const { return m_bytes.load(); }
+        int peakLive() const { return m_peakLive.load(); }
+        int peakBytes() const { return m_peakBytes.load(); }
+
+        QVariantMap toVariantMap() const;
+
+    private:
+        static void raise(QAtomicInt &peak, int value);
+
+        QAtomicInt m_live;
+        QAtomicInt m_bytes;
+        QAtomicInt m_peakLive;
+        QAtomicInt m_peakBytes;
+
+        friend class QSpotifyMemory;
+    };
+
+    static QSpotifyMemory &instance();
+
+    // Accounts are never deleted, keep the pointer.
+    Account *account(const QString &name);
+
+    // No-ops in release builds.
+    void track(const void *p, const Account *account);
+    void untrack(const void *p);
+
+    // Per account, plus the totals and the interned strings.
+    QVariantMap snapshot() const;
+    // Tracked allocations older than minAgeMs, grouped by account and tag,
+    // oldest first. Always empty in release builds.
+    QVariantList longLived(int minAgeMs) const;
+    // Lets a soak test start measuring high-water marks from now.
+    void resetPeaks();
+
+private:
+    QSpotifyMemory();
+
+    struct Allocation {
+        const Account *account;
+        QByteArray tag;
+        qint64 created;
+    };
+
+    mutable QMutex m_mutex;
+    QMap<QString, Account *> m_accounts;
+    Account m_total;
+    QElapsedTimer m_clock;
+    QHash<const void *, Allocation> m_allocations;
+
+    Q_DISABLE_COPY(QSpotifyMemory)
+};
+
+/**
+ * Names the code path allocations on this thread are made from while it is
+ * alive, e.g. QSpotifyMemoryTag tag("search"). Tags nest and are recorded
+ * as "search/tracks" in debug builds only.
+ */
+class QSpotifyMemoryTag
+{
+public:
+    explicit QSpotifyMemoryTag(const char *tag);
+    ~QSpotifyMemoryTag();
+
+    // The active tags of this thread, joined by '/'.
+    static QByteArray current();
+
+private:
+    Q_DISABLE_COPY(QSpotifyMemoryTag)
+};
+
+#endif // QSPOTIFYMEMORY_H
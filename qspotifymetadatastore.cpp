@@ -0,0 +1,263 @@
+#include "qspotifymetadatastore.h"
+
+#include <QtCore/QDataStream>
+#include <QtCore/QDebug>
+#include <QtCore/QList>
+#include <QtCore/QSaveFile>
+#include <QtCore/QtEndian>
+
+#include "qspotifytrace.h"
+
+static const char g_magic[4] = { 'Q', 'S', 'M', 'D' };
+static const int g_headerSize = 8;
+static const int g_recordHeaderSize = 5;
+static const int g_flushThreshold = 32 * 1024;
+static const qint64 g_compactThreshold = 256 * 1024;
+
+static QByteArray header()
+{
+    QByteArray h(g_magic, sizeof(g_magic));
+    uchar version[4];
+    qToBigEndian<quint32>(QSpotifyMetadataStore::FormatVersion, version);
+    h.append(reinterpret_cast<const char *>(version), sizeof(version));
+    return h;
+}
+
+static QByteArray encode(const QByteArray &uri, quint8 kind, const QSpotifyMetadataStore::Record &r)
+{
+    QByteArray payload;
+    QDataStream ds(&payload, QIODevice::WriteOnly);
+    ds.setVersion(QDataStream::Qt_5_0);
+    ds << uri << r.name << r.artists << r.album << r.coverId
+       << r.duration << r.popularity << r.year << r.available;
+
+    QByteArray record(g_recordHeaderSize, Qt::Uninitialized);
+    qToBigEndian<quint32>(payload.size(), reinterpret_cast<uchar *>(record.data()));
+    record[4] = char(kind);
+    return record + payload;
+}
+
+QSpotifyMetadataStore &QSpotifyMetadataStore::instance()
+{
+    static QSpotifyMetadataStore inst;
+    return inst;
+}
+
+bool QSpotifyMetadataStore::open(const QString &fileName)
+{
+    close();
+
+    m_fileName = fileName;
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        qCWarning(lcCache) << "Cannot open metadata store" << fileName << m_file.errorString();
+        return false;
+    }
+
+    qint64 size = m_file.size();
+    if (size < g_headerSize || m_file.read(g_headerSize) != header()) {
+        // Missing, corrupt or written by another format version
+        m_file.resize(0);
+        m_file.seek(0);
+        m_file.write(header());
+        size = g_headerSize;
+    }
+
+    if (size > g_headerSize)
+        m_map = m_file.map(0, size);
+
+    qint64 offset = g_headerSize;
+    if (m_map) {
+        m_mapSize = size;
+        while (offset + g_recordHeaderSize <= size) {
+            quint32 recordSize = g_recordHeaderSize + qFromBigEndian<quint32>(m_map + offset);
+            if (offset + recordSize > size)
+                break;
+
+            // The payload starts with the URI as a QDataStream QByteArray
+            if (recordSize < g_recordHeaderSize + 4)
+                break;
+            quint32 uriSize = qFromBigEndian<quint32>(m_map + offset + g_recordHeaderSize);
+            if (uriSize == 0xffffffff || g_recordHeaderSize + 4 + uriSize > recordSize)
+                break;
+            QByteArray uri(reinterpret_cast<const char *>(m_map + offset + g_recordHeaderSize + 4), uriSize);
+
+            auto it = m_index.find(uri);
+            if (it != m_index.end())
+                m_liveBytes -= it->size;
+            m_index.insert(uri, Entry{offset, recordSize, m_map[offset + 4]});
+            m_liveBytes += recordSize;
+            offset += recordSize;
+        }
+    }
+
+    if (offset < size) {
+        // Drop a record cut short by a crash
+        qCDebug(lcCache) << "Truncating metadata store at" << offset << "of" << size;
+        if (m_map)
+            m_file.unmap(m_map);
+        m_file.resize(offset);
+        m_map = offset > g_headerSize ? m_file.map(0, offset) : nullptr;
+        m_mapSize = m_map ? offset : 0;
+    }
+
+    m_fileBytes = offset;
+    m_liveBytes += g_headerSize;
+    qCDebug(lcCache) << "Metadata store" << fileName << "has" << m_index.size() << "records";
+
+    maybeCompact();
+    return true;
+}
+
+void QSpotifyMetadataStore::close()
+{
+    if (!m_file.isOpen())
+        return;
+
+    if (!m_writeBuffer.isEmpty()) {
+        m_file.seek(m_fileBytes);
+        m_file.write(m_writeBuffer);
+        m_writeBuffer.clear();
+    }
+    if (m_map)
+        m_file.unmap(m_map);
+    m_map = nullptr;
+    m_mapSize = 0;
+    m_file.close();
+
+    m_index.clear();
+    m_unmapped.clear();
+    m_fileBytes = 0;
+    m_liveBytes = 0;
+}
+
+bool QSpotifyMetadataStore::readMapped(qint64 offset, QByteArray *uri, quint8 *kind, Record *record) const
+{
+    if (!m_map || offset < 0 || offset + g_recordHeaderSize > m_mapSize)
+        return false;
+
+    quint32 payloadSize = qFromBigEndian<quint32>(m_map + offset);
+    if (offset + g_recordHeaderSize + payloadSize > m_mapSize)
+        return false;
+    *kind = m_map[offset + 4];
+
+    QByteArray payload = QByteArray::fromRawData(reinterpret_cast<const char *>(m_map + offset + g_recordHeaderSize), payloadSize);
+    QDataStream ds(payload);
+    ds.setVersion(QDataStream::Qt_5_0);
+    ds >> *uri >> record->name >> record->artists >> record->album >> record->coverId
+       >> record->duration >> record->popularity >> record->year >> record->available;
+    return ds.status() == QDataStream::Ok;
+}
+
+bool QSpotifyMetadataStore::lookup(const QByteArray &uri, Record *record) const
+{
+    auto unmapped = m_unmapped.constFind(uri);
+    if (unmapped != m_unmapped.constEnd()) {
+        *record = unmapped.value();
+        return true;
+    }
+
+    auto it = m_index.constFind(uri);
+    if (it == m_index.constEnd())
+        return false;
+
+    QByteArray storedUri;
+    quint8 kind;
+    return readMapped(it->offset, &storedUri, &kind, record) && storedUri == uri;
+}
+
+void QSpotifyMetadataStore::store(const QByteArray &uri, Kind kind, const Record &record)
+{
+    if (!m_file.isOpen() || uri.isEmpty())
+        return;
+
+    Record current;
+    if (lookup(uri, &current) && current == record)
+        return;
+
+    QByteArray encoded = encode(uri, kind, record);
+    auto it = m_index.find(uri);
+    if (it != m_index.end())
+        m_liveBytes -= it->size;
+    // Where flush() is going to write it
+    qint64 offset = m_fileBytes + m_writeBuffer.size();
+    m_index.insert(uri, Entry{offset, quint32(encoded.size()), quint8(kind)});
+    m_liveBytes += encoded.size();
+    m_unmapped.insert(uri, record);
+
+    m_writeBuffer += encoded;
+    if (m_writeBuffer.size() >= g_flushThreshold)
+        flush();
+}
+
+void QSpotifyMetadataStore::flush()
+{
+    if (!m_file.isOpen() || m_writeBuffer.isEmpty())
+        return;
+
+    m_file.seek(m_fileBytes);
+    if (m_file.write(m_writeBuffer) != m_writeBuffer.size() || !m_file.flush()) {
+        qCWarning(lcCache) << "Cannot write metadata store" << m_file.errorString();
+        // The records stay in memory only
+        m_file.resize(m_fileBytes);
+        for (auto it = m_unmapped.constBegin(); it != m_unmapped.constEnd(); ++it) {
+            auto entry = m_index.find(it.key());
+            if (entry != m_index.end() && entry->offset >= m_fileBytes)
+                entry->offset = -1;
+        }
+        m_writeBuffer.clear();
+        return;
+    }
+    m_fileBytes += m_writeBuffer.size();
+    m_writeBuffer.clear();
+
+    if (m_map)
+        m_file.unmap(m_map);
+    m_map = m_file.map(0, m_fileBytes);
+    m_mapSize = m_map ? m_fileBytes : 0;
+    if (m_map) {
+        for (auto it = m_unmapped.begin(); it != m_unmapped.end();) {
+            if (m_index.value(it.key()).offset >= 0)
+                it = m_unmapped.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    maybeCompact();
+}
+
+void QSpotifyMetadataStore::maybeCompact()
+{
+    if (!m_compacting && m_fileBytes + m_writeBuffer.size() > g_compactThreshold
+            && m_liveBytes * 2 < m_fileBytes + m_writeBuffer.size())
+        compact();
+}
+
+void QSpotifyMetadataStore::compact()
+{
+    if (!m_file.isOpen())
+        return;
+
+    QSPOTIFY_TRACE_SPAN("cache", "compactMetadataStore");
+
+    QByteArray data = header();
+    data.reserve(int(m_liveBytes));
+    for (auto it = m_index.constBegin(); it != m_index.constEnd(); ++it) {
+        Record record;
+        if (lookup(it.key(), &record))
+            data += encode(it.key(), it->kind, record);
+    }
+
+    QString fileName = m_fileName;
+    m_writeBuffer.clear();
+    close();
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit())
+        qCWarning(lcCache) << "Cannot compact metadata store" << file.errorString();
+
+    m_compacting = true;
+    open(fileName);
+    m_compacting = false;
+}
@@ -0,0 +1,100 @@
+#ifndef QSPOTIFYMETADATASTORE_H
+#define QSPOTIFYMETADATASTORE_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QFile>
+#include <QtCore/QHash>
+#include <QtCore/QString>
+
+/**
+ * Persistent metadata of tracks, albums and artists keyed by Spotify URI,
+ * used to show something while libspotify is still loading an object.
+ *
+ * The file is append-only and memory mapped for reading. It starts with
+ * the magic "QSMD" and a big endian quint32 format version, followed by
+ * records of a big endian quint32 payload size, a quint8 kind and a
+ * payload written with QDataStream (Qt_5_0):
+ *
+ *   QByteArray uri, QString name, QString artists, QString album,
+ *   QString coverId, qint32 duration, qint32 popularity, qint32 year,
+ *   bool available
+ *
+ * A later record for the same URI replaces an earlier one. The file is
+ * compacted when superseded records take more than half of it.
+ *
+ * Must only be used from the GUI thread.
+ */
+class QSpotifyMetadataStore
+{
+public:
+    enum { FormatVersion = 1 };
+
+    enum Kind {
+        Track = 1,
+        Album = 2,
+        Artist = 3
+    };
+
+    struct Record {
+        QString name;
+        QString artists;
+        QString album;
+        QString coverId;
+        qint32 duration{};
+        qint32 popularity{};
+        qint32 year{};
+        bool available{};
+
+        bool operator==(const Record &o) const
+        {
+            return name == o.name && artists == o.artists && album == o.album
+                    && coverId == o.coverId && duration == o.duration
+                    && popularity == o.popularity && year == o.year && available == o.available;
+        }
+        bool operator!=(const Record &o) const { return !(*this == o); }
+    };
+
+    static QSpotifyMetadataStore &instance();
+
+    bool open(const QString &fileName);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+
+    bool lookup(const QByteArray &uri, Record *record) const;
+    void store(const QByteArray &uri, Kind kind, const Record &record);
+
+    void flush();
+    void compact();
+
+    int count() const { return m_index.size(); }
+
+private:
+    QSpotifyMetadataStore() = default;
+
+    struct Entry {
+        // Offset of the record in the file, -1 if it could not be written.
+        // Records not mapped yet are also kept in m_unmapped.
+        qint64 offset;
+        quint32 size;
+        quint8 kind;
+    };
+
+    bool readMapped(qint64 offset, QByteArray *uri, quint8 *kind, Record *record) const;
+    void maybeCompact();
+
+    QString m_fileName;
+    QFile m_file;
+    uchar *m_map{};
+    qint64 m_mapSize{};
+
+    QHash<QByteArray, Entry> m_index;
+    QHash<QByteArray, Record> m_unmapped;
+    QByteArray m_writeBuffer;
+    qint64 m_fileBytes{};
+    qint64 m_liveBytes{};
+    bool m_compacting{};
+
+    Q_DISABLE_COPY(QSpotifyMetadataStore)
+};
+
+#endif // QSPOTIFYMETADATASTORE_H
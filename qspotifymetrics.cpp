@@ -0,0 +1,98 @@
+#include "qspotifymetrics.h"
+
+#include <QtCore/QEvent>
+#include <QtCore/QHash>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QObject>
+#include <QtCore/QPair>
+
+#include "qspotifyeventwatchdog.h"
+
+void QSpotifyMetrics::Histogram::observe(qint64 ms)
+{
+    quint32 v = quint32(qBound<qint64>(0, ms, 0x7fffffff));
+    m_count.fetchAndAddRelaxed(1);
+    m_sumMs.fetchAndAddRelaxed(v);
+
+    quint32 max = m_maxMs.load();
+    while (v > max && !m_maxMs.testAndSetRelaxed(max, v))
+        max = m_maxMs.load();
+
+    int bucket = 0;
+    while (bucket < NumBuckets - 1 && v >= (1u << bucket))
+        ++bucket;
+    m_buckets[bucket].fetchAndAddRelaxed(1);
+}
+
+QVariantMap QSpotifyMetrics::Histogram::toVariantMap() const
+{
+    QVariantList buckets;
+    for (int i = 0; i < NumBuckets; ++i)
+        buckets << m_buckets[i].load();
+
+    QVariantMap map;
+    map.insert(QLatin1String("count"), m_count.load());
+    map.insert(QLatin1String("sumMs"), m_sumMs.load());
+    map.insert(QLatin1String("maxMs"), m_maxMs.load());
+    map.insert(QLatin1String("buckets"), buckets);
+    return map;
+}
+
+QSpotifyMetrics &QSpotifyMetrics::instance()
+{
+    static QSpotifyMetrics inst;
+    return inst;
+}
+
+QSpotifyMetrics::Counter *QSpotifyMetrics::counter(const QString &name)
+{
+    QMutexLocker lock(&m_mutex);
+    Counter *&c = m_counters[name];
+    if (!c)
+        c = new Counter;
+    return c;
+}
+
+QSpotifyMetrics::Gauge *QSpotifyMetrics::gauge(const QString &name)
+{
+    QMutexLocker lock(&m_mutex);
+    Gauge *&g = m_gauges[name];
+    if (!g)
+        g = new Gauge;
+    return g;
+}
+
+QSpotifyMetrics::Histogram *QSpotifyMetrics::histogram(const QString &name)
+{
+    QMutexLocker lock(&m_mutex);
+    Histogram *&h = m_histograms[name];
+    if (!h)
+        h = new Histogram;
+    return h;
+}
+
+void QSpotifyMetrics::countEvent(const QObject *receiver, const QEvent *e)
+{
+    static QHash<QPair<const char *, int>, Counter *> counters;
+
+    const char *className = receiver->metaObject()->className();
+    Counter *&c = counters[qMakePair(className, int(e->type()))];
+    if (!c) {
+        c = instance().counter(QLatin1String("events.")
+                               + QSpotifyEventWatchdog::eventLabel(className, e->type()));
+    }
+    c->add();
+}
+
+QVariantMap QSpotifyMetrics::snapshot() const
+{
+    QMutexLocker lock(&m_mutex);
+    QVariantMap map;
+    for (auto it = m_counters.constBegin(); it != m_counters.constEnd(); ++it)
+        map.insert(it.key(), it.value()->value());
+    for (auto it = m_gauges.constBegin(); it != m_gauges.constEnd(); ++it)
+        map.insert(it.key(), it.value()->value());
+    for (auto it = m_histograms.constBegin(); it != m_histograms.constEnd(); ++it)
+        map.insert(it.key(), it.value()->toVariantMap());
+    return map;
+}
@@ -0,0 +1,89 @@
+#ifndef QSPOTIFYMETRICS_H
+#define QSPOTIFYMETRICS_H
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QMap>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+#include <QtCore/QVariantMap>
+
+class QEvent;
+class QObject;
+
+/**
+ * Registry of named counters, gauges and latency histograms.
+ *
+ * Looking up a metric by name takes a lock, so callers on hot paths look
+ * it up once and keep the pointer; metrics are never deleted. Updating a
+ * metric is a relaxed atomic operation and can be done from any thread.
+ *
+ * snapshot() is readable from QML through QSpotifySession::metrics() and
+ * over D-Bus through the org.cutespot.Metrics interface.
+ */
+class QSpotifyMetrics
+{
+public:
+    class Counter
+    {
+    public:
+        void add(quint32 n = 1) { m_value.fetchAndAddRelaxed(n); }
+        quint32 value() const { return m_value.load(); }
+
+    private:
+        QAtomicInteger<quint32> m_value;
+    };
+
+    class Gauge
+    {
+    public:
+        void set(int v) { m_value.store(v); }
+        void add(int n) { m_value.fetchAndAddRelaxed(n); }
+        int value() const { return m_value.load(); }
+
+    private:
+        QAtomicInt m_value;
+    };
+
+    class Histogram
+    {
+    public:
+        enum { NumBuckets = 12 };
+
+        // Bucket i counts values below 2^i ms, the last one everything slower.
+        void observe(qint64 ms);
+        void observe(const QElapsedTimer &timer) { observe(timer.elapsed()); }
+
+        QVariantMap toVariantMap() const;
+
+    private:
+        QAtomicInteger<quint32> m_count;
+        QAtomicInteger<quint32> m_sumMs;
+        QAtomicInteger<quint32> m_maxMs;
+        QAtomicInteger<quint32> m_buckets[NumBuckets];
+    };
+
+    static QSpotifyMetrics &instance();
+
+    Counter *counter(const QString &name);
+    Gauge *gauge(const QString &name);
+    Histogram *histogram(const QString &name);
+
+    // Counts an event delivered to one of the watched receivers. Must be
+    // called from the GUI thread.
+    static void countEvent(const QObject *receiver, const QEvent *e);
+
+    QVariantMap snapshot() const;
+
+private:
+    QSpotifyMetrics() = default;
+
+    mutable QMutex m_mutex;
+    QMap<QString, Counter *> m_counters;
+    QMap<QString, Gauge *> m_gauges;
+    QMap<QString, Histogram *> m_histograms;
+
+    Q_DISABLE_COPY(QSpotifyMetrics)
+};
+
+#endif // QSPOTIFYMETRICS_H
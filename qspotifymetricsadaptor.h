@@ -0,0 +1,26 @@
+#ifndef QSPOTIFYMETRICSADAPTOR_H
+#define QSPOTIFYMETRICSADAPTOR_H
+
+#include <QtCore/QObject>
+#include <QtCore/QVariantMap>
+#include <QtDBus/QDBusAbstractAdaptor>
+
+#include "qspotifymemory.h"
+#include "qspotifymetrics.h"
+
+class QSpotifyMetricsAdaptor : public QDBusAbstractAdaptor
+{
+    Q_OBJECT
+    Q_CLASSINFO ("D-Bus Interface", "org.cutespot.Metrics")
+
+public:
+    QSpotifyMetricsAdaptor(QObject* parent) : QDBusAbstractAdaptor(parent) {}
+
+public slots:
+    QVariantMap Snapshot() const { return QSpotifyMetrics::instance().snapshot(); }
+    QVariantMap Memory() const { return QSpotifyMemory::instance().snapshot(); }
+    QVariantList LongLivedObjects(int minAgeMs) const { return QSpotifyMemory::instance().longLived(minAgeMs); }
+    void ResetMemoryPeaks() { QSpotifyMemory::instance().resetPeaks(); }
+};
+
+#endif // QSPOTIFYMETRICSADAPTOR_H
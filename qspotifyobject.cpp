@@ -42,11 +42,28 @@
 #include "qspotifyobject.h"
 #include "qspotifysession.h"
 #include "qspotifycachemanager.h"
+#include "qspotifymetrics.h"
+
+static QSpotifyMetrics::Gauge *liveObjects()
+{
+    static QSpotifyMetrics::Gauge *gauge = QSpotifyMetrics::instance().gauge(QLatin1String("objects.live"));
+    return gauge;
+}
 
 QSpotifyObject::QSpotifyObject(bool autoConnectToSessionSignal)
   : QObject(nullptr)
   , m_autoConnect(autoConnectToSessionSignal)
 {
+    liveObjects()->add(1);
+}
+
+QSpotifyObject::~QSpotifyObject()
+{
+    liveObjects()->add(-1);
+    if (m_memoryAccount) {
+        m_memoryAccount->update(-1, -m_accountedBytes);
+        QSpotifyMemory::instance().untrack(this);
+    }
 }
 
 void QSpotifyObject::init()
@@ -63,14 +80,29 @@ void QSpotifyObject::destroy()
 
 void QSpotifyObject::release()
 {
-    --m_refCount;
-    Q_ASSERT(m_refCount >= 0);
-    if (m_refCount == 0) {
-        if (m_autoConnect)
-            disconnect(QSpotifySession::instance(), SIGNAL(metadataUpdated()), this, SLOT(metadataUpdated()));
-        QSpotifyCacheManager::instance().removeObject(this);
-        destroy();
+    for (;;) {
+        int count = m_refCount.load();
+        Q_ASSERT(count > 0);
+        // The last reference is dropped under the cache manager's lock
+        if (count == 1)
+            break;
+        if (m_refCount.testAndSetOrdered(count, count - 1))
+            return;
     }
+    QSpotifyCacheManager::instance().releaseLast(this);
+}
+
+void QSpotifyObject::retire()
+{
+    if (m_autoConnect)
+        disconnect(QSpotifySession::instance(), SIGNAL(metadataUpdated()), this, SLOT(metadataUpdated()));
+}
+
+void QSpotifyObject::revive()
+{
+    if (m_autoConnect)
+        connect(QSpotifySession::instance(), SIGNAL(metadataUpdated()), this, SLOT(metadataUpdated()));
+    metadataUpdated();
 }
 
 void QSpotifyObject::metadataUpdated()
@@ -81,6 +113,22 @@ void QSpotifyObject::metadataUpdated()
         m_isLoaded = newIsLoaded;
         emit isLoadedChanged();
     }
+    accountMemory();
     if (updated)
         emit dataChanged();
 }
+
+void QSpotifyObject::accountMemory()
+{
+    // The subclass is only known once construction is done, init() calls us
+    QSpotifyMemory &memory = QSpotifyMemory::instance();
+    int size = estimatedSize();
+    if (!m_memoryAccount) {
+        m_memoryAccount = memory.account(QLatin1String("objects.") + QLatin1String(metaObject()->className()));
+        m_memoryAccount->update(1, size);
+        memory.track(this, m_memoryAccount);
+    } else if (size != m_accountedBytes) {
+        m_memoryAccount->update(0, size - m_accountedBytes);
+    }
+    m_accountedBytes = size;
+}
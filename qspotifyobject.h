@@ -42,20 +42,32 @@
 #ifndef QSPOTIFYOBJECT_H
 #define QSPOTIFYOBJECT_H
 
+#include <QtCore/QAtomicInt>
 #include <QtCore/QObject>
 
+#include "qspotifymemory.h"
+
 class QSpotifySession;
 
 class QSpotifyObject : public QObject
 {
     Q_OBJECT
 public:
+    // Which QSpotifyCacheManager hash holds the object, set on insertion.
+    enum CacheType {
+        NotCached,
+        CachedTrack,
+        CachedAlbum,
+        CachedArtist,
+        NumCacheTypes
+    };
+
     /**
      * To properly initialize call init() after constructing
      * an album object.
      */
     QSpotifyObject(bool autoConnectToSessionSignal);
-    virtual ~QSpotifyObject() { }
+    virtual ~QSpotifyObject();
 
     virtual void init();
 
@@ -63,8 +75,21 @@ public:
 
     virtual void destroy();
 
-    void addRef() { ++m_refCount; }
+    // Reference counting is thread safe; see QSpotifyCacheManager.
+    void addRef() { m_refCount.ref(); }
     void release();
+    int refCount() const { return m_refCount.load(); }
+    CacheType cacheType() const { return m_cacheType; }
+
+    // Rough heap footprint including owned strings, used to bound the cache
+    // manager's retention pool and for QSpotifyMemory.
+    virtual int estimatedSize() const { return sizeof(QSpotifyObject); }
+
+    // Called when the last reference is released and the cache manager keeps
+    // the object around instead of destroying it, and when it is handed out
+    // again. Overrides must call the base implementation.
+    virtual void retire();
+    virtual void revive();
 
 public Q_SLOTS:
     void metadataUpdated();
@@ -77,9 +102,18 @@ protected:
     virtual bool updateData() = 0;
 
 private:
+    void accountMemory();
+
     bool m_isLoaded{};
     bool m_autoConnect;
-    int m_refCount{1};
+    QAtomicInt m_refCount{1};
+    CacheType m_cacheType{NotCached};
+    // Set under the shard lock from revival until revive() returned
+    bool m_reviving{};
+    QSpotifyMemory::Account *m_memoryAccount{};
+    int m_accountedBytes{};
+
+    friend class QSpotifyCacheManager;
 
     QSpotifyObject(const QSpotifyObject&) = delete;
 };
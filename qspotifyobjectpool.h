@@ -0,0 +1,132 @@
+#ifndef QSPOTIFYOBJECTPOOL_H
+#define QSPOTIFYOBJECTPOOL_H
+
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+
+#include <cstddef>
+#include <new>
+
+/**
+ * Fixed size slot allocator for one object type, used through the class
+ * specific operator new/delete of QSpotifyTrack, QSpotifyAlbum and
+ * QSpotifyArtist. Slots are carved from chunks of ChunkSize objects and
+ * recycled through a free list; chunks are only given back to the heap
+ * once every object of the type is gone.
+ *
+ * Objects may be created on any thread, so the free list is guarded by
+ * a lock per type.
+ */
+template <typename T>
+class QSpotifyObjectPool
+{
+public:
+    enum { ChunkSize = 256 };
+
+    struct Stats {
+        int chunks;
+        int live;
+        int peak;
+        quint64 allocations;
+        // Fraction of the reserved slots that are unused.
+        double fragmentation;
+    };
+
+    static void *allocate(std::size_t size)
+    {
+        if (size != sizeof(T))
+            return ::operator new(size);
+        QMutexLocker lock(&mutex());
+        if (!s_free)
+            grow();
+        Slot *slot = s_free;
+        s_free = slot->next;
+        ++s_allocations;
+        if (++s_live > s_peak)
+            s_peak = s_live;
+        return slot;
+    }
+
+    static void deallocate(void *p, std::size_t size)
+    {
+        if (!p)
+            return;
+        if (size != sizeof(T)) {
+            ::operator delete(p);
+            return;
+        }
+        QMutexLocker lock(&mutex());
+        Slot *slot = static_cast<Slot *>(p);
+        slot->next = s_free;
+        s_free = slot;
+        --s_live;
+    }
+
+    // Gives all chunks back to the heap if no object is alive.
+    static void trim()
+    {
+        QMutexLocker lock(&mutex());
+        if (s_live != 0)
+            return;
+        for (Slot *chunk : s_chunks)
+            ::operator delete(chunk);
+        s_chunks.clear();
+        s_free = nullptr;
+    }
+
+    static Stats stats()
+    {
+        QMutexLocker lock(&mutex());
+        Stats s;
+        s.chunks = s_chunks.count();
+        s.live = s_live;
+        s.peak = s_peak;
+        s.allocations = s_allocations;
+        int reserved = s.chunks * ChunkSize;
+        s.fragmentation = reserved ? double(reserved - s_live) / reserved : 0.0;
+        return s;
+    }
+
+private:
+    static QMutex &mutex()
+    {
+        static QMutex m;
+        return m;
+    }
+
+    union Slot {
+        Slot *next;
+        alignas(T) char storage[sizeof(T)];
+    };
+
+    static void grow()
+    {
+        Slot *chunk = static_cast<Slot *>(::operator new(sizeof(Slot) * ChunkSize));
+        for (int i = 0; i < ChunkSize - 1; ++i)
+            chunk[i].next = &chunk[i + 1];
+        chunk[ChunkSize - 1].next = s_free;
+        s_free = chunk;
+        s_chunks.append(chunk);
+    }
+
+    static Slot *s_free;
+    static QList<Slot *> s_chunks;
+    static int s_live;
+    static int s_peak;
+    static quint64 s_allocations;
+};
+
+template <typename T> typename QSpotifyObjectPool<T>::Slot *QSpotifyObjectPool<T>::s_free = nullptr;
+template <typename T> QList<typename QSpotifyObjectPool<T>::Slot *> QSpotifyObjectPool<T>::s_chunks;
+template <typename T> int QSpotifyObjectPool<T>::s_live = 0;
+template <typename T> int QSpotifyObjectPool<T>::s_peak = 0;
+template <typename T> quint64 QSpotifyObjectPool<T>::s_allocations = 0;
+
+#define QSPOTIFY_DECLARE_POOLED(Class) \
+public: \
+    static void *operator new(std::size_t size) { return QSpotifyObjectPool<Class>::allocate(size); } \
+    static void operator delete(void *p, std::size_t size) { QSpotifyObjectPool<Class>::deallocate(p, size); } \
+private:
+
+#endif // QSPOTIFYOBJECTPOOL_H
@@ -49,14 +49,17 @@
 
 #include "qspotifyalbum.h"
 #include "qspotifyalbumbrowse.h"
+#include "qspotifyeventwatchdog.h"
+#include "qspotifymemory.h"
+#include "qspotifymetrics.h"
+#include "qspotifyplaylistcontainer.h"
 #include "qspotifyplayqueue.h"
 #include "qspotifysession.h"
+#include "qspotifytrace.h"
 #include "qspotifytrack.h"
 #include "qspotifyuser.h"
-#include "qspotifycachemanager.h"
 #include "qspotifyutil.h"
-
-static QHash<QString, byte*> m_imagePointers;
+#include "qspotifycachemanager.h"
 
 class QSpotifyTracksAddedEvent : public QEvent
 {
@@ -125,17 +128,17 @@ private:
 
 static void callback_playlist_state_changed(sp_playlist *, void *objectPtr)
 {
-    QCoreApplication::postEvent(static_cast<QSpotifyPlaylist*>(objectPtr), new QEvent(QEvent::User));
+    QSpotifyEventWatchdog::postEvent(static_cast<QSpotifyPlaylist*>(objectPtr), new QEvent(QEvent::User));
 }
 
 static void callback_playlist_metadata_updated(sp_playlist *, void *objectPtr)
 {
-    QCoreApplication::postEvent(static_cast<QSpotifyPlaylist*>(objectPtr), new QEvent(QEvent::Type(QEvent::User + 1)));
+    QSpotifyEventWatchdog::postEvent(static_cast<QSpotifyPlaylist*>(objectPtr), new QEvent(QEvent::Type(QEvent::User + 1)));
 }
 
 static void callback_playlist_renamed(sp_playlist *, void *objectPtr)
 {
-    QCoreApplication::postEvent(static_cast<QSpotifyPlaylist*>(objectPtr), new QEvent(QEvent::Type(QEvent::User + 2)));
+    QSpotifyEventWatchdog::postEvent(static_cast<QSpotifyPlaylist*>(objectPtr), new QEvent(QEvent::Type(QEvent::User + 2)));
 }
 
 static void callback_tracks_added(sp_playlist *, sp_track *const *tracks, int num_tracks, int position, void *objectPtr)
@@ -144,7 +147,7 @@ static void callback_tracks_added(sp_playlist *, sp_track *const *tracks, int nu
     for (int i = 0; i < num_tracks; ++i)
         if (tracks[i] != nullptr)
             vec.append(tracks[i]);
-    QCoreApplication::postEvent(static_cast<QSpotifyPlaylist*>(objectPtr), new QSpotifyTracksAddedEvent(vec, position));
+    QSpotifyEventWatchdog::postEvent(static_cast<QSpotifyPlaylist*>(objectPtr), new QSpotifyTracksAddedEvent(vec, position));
 }
 
 static void callback_tracks_removed(sp_playlist *, const int *tracks, int num_tracks, void *objectPtr)
@@ -152,7 +155,7 @@ static void callback_tracks_removed(sp_playlist *, const int *tracks, int num_tr
     QVector<int> vec;
     for (int i = 0; i < num_tracks; ++i)
         vec.append(tracks[i]);
-    QCoreApplication::postEvent(static_cast<QSpotifyPlaylist*>(objectPtr), new QSpotifyTracksRemovedEvent(vec));
+    QSpotifyEventWatchdog::postEvent(static_cast<QSpotifyPlaylist*>(objectPtr), new QSpotifyTracksRemovedEvent(vec));
 }
 
 static void callback_tracks_moved(sp_playlist *, const int *tracks, int num_tracks, int new_position, void *objectPtr)
@@ -160,12 +163,12 @@ static void callback_tracks_moved(sp_playlist *, const int *tracks, int num_trac
     QVector<int> vec;
     for (int i = 0; i < num_tracks; ++i)
         vec.append(tracks[i]);
-    QCoreApplication::postEvent(static_cast<QSpotifyPlaylist*>(objectPtr), new QSpotifyTracksMovedEvent(vec, new_position));
+    QSpotifyEventWatchdog::postEvent(static_cast<QSpotifyPlaylist*>(objectPtr), new QSpotifyTracksMovedEvent(vec, new_position));
 }
 
 static void callback_track_seen_changed(sp_playlist *, int position, bool seen, void *objectPtr)
 {
-    QCoreApplication::postEvent(static_cast<QSpotifyPlaylist*>(objectPtr), new QSpotifyTrackSeenEvent(position, seen));
+    QSpotifyEventWatchdog::postEvent(static_cast<QSpotifyPlaylist*>(objectPtr), new QSpotifyTrackSeenEvent(position, seen));
 }
 
 
@@ -174,12 +177,15 @@ QSpotifyPlaylist::QSpotifyPlaylist(Type type, sp_playlist *playlist, bool incrRe
     , m_type(type)
 {
     Q_ASSERT(playlist);
-    if (type != Folder && type != None)
+    if (type != Folder && type != None) {
         m_trackList = new QSpotifyTrackList(this);
+        connect(m_trackList, SIGNAL(rowsDataChanged()), this, SLOT(onRowsDataChanged()));
+    }
 
     if (incrRefCount)
         sp_playlist_add_ref(playlist);
     m_sp_playlist = playlist;
+    QSPOTIFY_TRACE_BEGIN("playlist", "playlistLoad", this);
     connect(this, SIGNAL(dataChanged()), this, SIGNAL(playlistDataChanged()));
     connect(this, SIGNAL(isLoadedChanged()), this, SIGNAL(thisIsLoadedChanged()));
     connect(this, SIGNAL(playlistDataChanged()), this , SIGNAL(seenCountChanged()));
@@ -189,8 +195,8 @@ QSpotifyPlaylist::QSpotifyPlaylist(Type type, sp_playlist *playlist, bool incrRe
 QSpotifyPlaylist::~QSpotifyPlaylist()
 {
     emit playlistDestroyed();
-    auto ptr = m_imagePointers.take(m_hashKey);
-    if(ptr) delete[] ptr;
+    if (m_container)
+        m_container->unindexPlaylist(this);
     if (m_sp_playlist) {
         sp_playlist_remove_callbacks(m_sp_playlist, m_callbacks, this);
         sp_playlist_release(m_sp_playlist);
@@ -205,6 +211,7 @@ bool QSpotifyPlaylist::isLoaded()
 
 bool QSpotifyPlaylist::updateData()
 {
+    QSpotifyMemoryTag memoryTag("playlist");
     bool updated = false;
 
     if (m_type != Folder) {
@@ -225,34 +232,25 @@ bool QSpotifyPlaylist::updateData()
         }
     }
 
-    if (m_hashKey.isEmpty()) {
-        auto link = sp_link_create_from_playlist(m_sp_playlist);
-        QSpotifyUtil::spLinkToQString(link, [this, &updated] (const QString &hashKey) {
-            m_hashKey = hashKey;
-        });
-    }
-
     // Image
-    if (m_ImageId.isEmpty()) {
-        const int image_id_size = 20;
-        byte *image_id_buffer = new byte[image_id_size];
+    if (!m_imageId.isValid()) {
+        byte image_id_buffer[20];
         if(sp_playlist_get_image(m_sp_playlist, image_id_buffer)) {
-            m_imagePointers.insert(m_hashKey, image_id_buffer);
-            m_ImageId = m_hashKey;
-            m_hasImage = true;
+            m_imageId = QSpotifyId::fromImageId(image_id_buffer);
             updated = true;
-        } else {
-            delete[] image_id_buffer;
         }
     }
 
+    // Read from libspotify directly, album objects would be created for
+    // every track scanned
     int i = 0;
     while(i < sp_playlist_num_tracks(m_sp_playlist) && m_coverImages.size() < 4) {
         sp_track *track = sp_playlist_track(m_sp_playlist, i);
         if (auto salb = sp_track_album(track)) {
-            if (auto alb = QSpotifyCacheManager::instance().getAlbum(salb)) {
-                if (!m_coverImages.contains(alb->coverId()) && !alb->coverId().isEmpty()) {
-                    m_coverImages.append(alb->coverId());
+            if (const byte *cover = sp_album_cover(salb, SP_IMAGE_SIZE_NORMAL)) {
+                QString coverId = QSpotifyId::fromImageId(cover).toString();
+                if (!m_coverImages.contains(coverId)) {
+                    m_coverImages.append(coverId);
                     updated = true;
                 }
             }
@@ -260,8 +258,15 @@ bool QSpotifyPlaylist::updateData()
         i++;
     }
 
+    if (m_uri.isEmpty() && m_type == Playlist) {
+        // The container sets it if libspotify knew it before loading
+        QByteArray uri = QSpotifyUtil::spLinkToByteArray(sp_link_create_from_playlist(m_sp_playlist));
+        if (!uri.isEmpty())
+            m_uri = QString::fromUtf8(uri);
+    }
+
     if (auto rawOwner = sp_playlist_owner(m_sp_playlist)) {
-        QString owner = QString::fromUtf8(sp_user_canonical_name(rawOwner));
+        QSpotifyInternedString owner(sp_user_canonical_name(rawOwner));
         if (m_owner != owner) {
             m_owner = owner;
             updated = true;
@@ -275,22 +280,32 @@ bool QSpotifyPlaylist::updateData()
     }
 
     if (m_trackList && m_trackList->isEmpty() && !m_skipUpdateTracks) {
+        QSPOTIFY_TRACE_SPAN("playlist", "populateTracks");
         int count = sp_playlist_num_tracks(m_sp_playlist);
         m_trackList->reserve(count);
-        int insertPos = -1; // Append
-        if (m_type == Starred || m_type == Inbox) insertPos = 0; // Prepend
-        for (int i = 0; i < count; ++i) {
-            auto strack = sp_playlist_track(m_sp_playlist, i);
-            addTrack(strack, insertPos);
+        QVector<sp_track *> tracks;
+        tracks.reserve(count);
+        for (int i = 0; i < count; ++i)
+            tracks.append(sp_playlist_track(m_sp_playlist, i));
+        // Newest first
+        if (isReversed()) {
+            QVector<sp_track *> reversed(tracks.crbegin(), tracks.crend());
+            addTracks(reversed);
+        } else {
+            addTracks(tracks);
         }
+        // Populates the user's starred index
+        if (m_type == Starred && count > 0)
+            emit tracksAdded(tracks);
         updated = true;
     }
 
     OfflineStatus os = OfflineStatus(sp_playlist_get_offline_status(QSpotifySession::instance()->spsession(), m_sp_playlist));
     if (m_offlineStatus != os) {
-        if (os == Waiting && m_offlineTracks.count() == m_availableTracks.count())
+        const auto &totals = m_trackList ? m_trackList->records().totals() : QSpotifyTrackRecords::Totals();
+        if (os == Waiting && totals.availableOffline == totals.available)
             m_offlineStatus = Yes;
-        else if (os == Yes && m_offlineTracks.count() < m_availableTracks.count())
+        else if (os == Yes && totals.availableOffline < totals.available)
             m_offlineStatus = Waiting;
         else
             m_offlineStatus = os;
@@ -311,6 +326,11 @@ bool QSpotifyPlaylist::updateData()
         }
     }
 
+    if (!m_loadTraced && sp_playlist_is_loaded(m_sp_playlist)) {
+        m_loadTraced = true;
+        QSPOTIFY_TRACE_END("playlist", "playlistLoad", this);
+    }
+
     if (!m_callbacks) {
         m_callbacks = new sp_playlist_callbacks;
         memset(m_callbacks, 0, sizeof(sp_playlist_callbacks));
@@ -333,32 +353,39 @@ bool QSpotifyPlaylist::updateData()
     return updated;
 }
 
-QSpotifyTrack *QSpotifyPlaylist::addTrack(sp_track *track, int pos)
+void QSpotifyPlaylist::addTracks(const QVector<sp_track *> &tracks, int pos)
 {
-    auto qtrack = QSpotifyCacheManager::instance().getTrack(track, this);
-    if (!qtrack) return nullptr;
+    if (pos < 0)
+        pos = m_trackList->count();
 
-    if (pos == -1)
-        m_trackList->appendRow(qtrack);
-    else
-        m_trackList->insertRow(pos, qtrack);
-    m_tracksSet.insert(track);
-    connect(qtrack, SIGNAL(trackDataChanged()), this, SIGNAL(playlistDataChanged()));
-    connect(qtrack, SIGNAL(offlineStatusChanged()), this, SLOT(onTrackChanged()));
-    connect(qtrack, SIGNAL(isAvailableChanged()), this, SLOT(onTrackChanged()));
-    if (m_type != Starred) {
-        connect(QSpotifySession::instance()->user()->starredList(), SIGNAL(tracksAdded(QVector<sp_track*>)), qtrack, SLOT(onStarredListTracksAdded(QVector<sp_track*>)));
-        connect(QSpotifySession::instance()->user()->starredList(), SIGNAL(tracksRemoved(QVector<sp_track*>)), qtrack, SLOT(onStarredListTracksRemoved(QVector<sp_track*>)));
-    }
-    if (m_type == Inbox) {
-        connect(qtrack, SIGNAL(seenChanged()), this, SIGNAL(seenCountChanged()));
+    // Track changes reach us through m_trackList's rowsDataChanged()
+    if (m_type != Inbox) {
+        // Rows get their QSpotifyTrack once the view needs it
+        m_trackList->insertTracks(pos, tracks);
+        if (m_container) {
+            for (sp_track *track : tracks)
+                m_container->indexTrack(this, track);
+        }
+    } else {
+        // The seen state is only known to the objects, the inbox is small
+        QList<QSpotifyTrack *> qtracks;
+        qtracks.reserve(tracks.size());
+        for (sp_track *track : tracks) {
+            if (auto qtrack = QSpotifyCacheManager::instance().getTrack(track, this))
+                qtracks.append(qtrack);
+        }
+        // They read their seen state by row, so update once inserted
+        m_trackList->insertRows(pos, qtracks);
+        for (QSpotifyTrack *qtrack : qtracks)
+            qtrack->metadataUpdated();
     }
-    qtrack->metadataUpdated();
-    return qtrack;
+    updateHasOfflineTracks();
 }
 
 bool QSpotifyPlaylist::event(QEvent *e)
 {
+    QSpotifyEventWatchdog::Scope watchdog(this, e);
+    QSpotifyMetrics::countEvent(this, e);
 
     // FIXME correctly pass events to playqueue tracklist.
     if (e->type() == QEvent::User) {
@@ -369,11 +396,8 @@ bool QSpotifyPlaylist::event(QEvent *e)
         return true;
     } else if (e->type() == QEvent::User + 1) {
         // TracksMetadata updated
-        if (m_trackList) {
-            for (int i = 0; i < m_trackList->count(); ++i) {
-                m_trackList->at(i)->metadataUpdated();
-            }
-        }
+        if (m_trackList)
+            m_trackList->updateRows();
         e->accept();
         return true;
     } else if (e->type() == QEvent::User + 2) {
@@ -384,60 +408,57 @@ bool QSpotifyPlaylist::event(QEvent *e)
         e->accept();
         return true;
     } else if (e->type() == QEvent::User + 3) {
-        qDebug() << "Track add start";
+        qCDebug(lcPlaylist) << "Track add start";
         // TracksAdded event
         QSpotifyTracksAddedEvent *ev = static_cast<QSpotifyTracksAddedEvent *>(e);
         QVector<sp_track*> tracks = ev->tracks();
         int pos = ev->position();
 //      TODO  bool currentList = QSpotifySession::instance()->playQueue()->isCurrentTrackList(m_trackList);
         int amount = sp_playlist_num_tracks(m_sp_playlist);
+        QVector<sp_track *> added;
+        added.reserve(tracks.count());
         for (int i = 0; i < tracks.count(); ++i) {
             auto strack = tracks.at(i);
             if(!strack) {
                 qWarning() << "## No track";
                 continue;
             }
-            if (pos < amount && strack == sp_playlist_track(m_sp_playlist, pos)) {
-                if (auto t = addTrack(strack, pos)) {
-//          TODO          if(currentList)
-//                        QSpotifySession::instance()->playQueue()->appendRow(t);
-                    ++pos;
-                }
-            }
+            int trackPos = pos + added.count();
+            if (trackPos < amount && strack == sp_playlist_track(m_sp_playlist, trackPos))
+                added.append(strack);
+        }
+        if (isReversed()) {
+            // Before the row of the track that was at pos - 1
+            std::reverse(added.begin(), added.end());
+            addTracks(added, m_trackList->count() - pos);
+        } else {
+            addTracks(added, pos);
         }
+//          TODO          if(currentList)
+//                        QSpotifySession::instance()->playQueue()->appendRows(...);
 
         postUpdateEvent();
         if (m_type == Starred || m_type == Inbox)
             emit tracksAdded(tracks);
-        qDebug() << "Track add end";
+        qCDebug(lcPlaylist) << "Track add end";
         e->accept();
         return true;
     } else if (e->type() == QEvent::User + 4) {
         // TracksRemoved event
         QSpotifyTracksRemovedEvent *ev = static_cast<QSpotifyTracksRemovedEvent *>(e);
-        QVector<int> tracks = ev->positions();
-        std::sort(tracks.begin(), tracks.end(), std::greater<int>());
-        QVector<sp_track *> tracksSignal;
 
 //   TODO     bool isCurrentList = QSpotifySession::instance()->playQueue()->isCurrentTrackList(m_trackList);
 
-        for (int i = 0; i < tracks.count(); ++i) {
-            int pos = tracks.at(i);
-            if (pos < 0 || pos >= m_trackList->count())
-                continue;
-            if (auto tr = m_trackList->takeRow(pos)) {
-                unregisterTrackType(tr);
-                disconnect(tr, SIGNAL(offlineStatusChanged()), this, SLOT(onTrackChanged()));
-                disconnect(tr, SIGNAL(isAvailableChanged()), this, SLOT(onTrackChanged()));
-                tracksSignal.append(tr->m_sp_track);
-                m_tracksSet.remove(tr->m_sp_track);
-
-//                if(isCurrentList) {
-//     TODO               auto playQueueList = QSpotifySession::instance()->playQueue();
-//                    playQueueList->removeRow(playQueueList->indexOf(tr));
-//                }
-            }
+        QVector<int> rows;
+        rows.reserve(ev->positions().count());
+        for (int pos : ev->positions())
+            rows.append(rowOfPosition(pos));
+        QVector<sp_track *> tracksSignal = m_trackList->removeRowsAt(rows);
+        if (m_container) {
+            for (sp_track *track : tracksSignal)
+                m_container->unindexTrack(this, track);
         }
+        updateHasOfflineTracks();
         postUpdateEvent();
         if (m_type == Starred)
             emit tracksRemoved(tracksSignal);
@@ -446,19 +467,17 @@ bool QSpotifyPlaylist::event(QEvent *e)
     } else if (e->type() == QEvent::User + 5) {
         // TracksMoved event
         QSpotifyTracksMovedEvent *ev = static_cast<QSpotifyTracksMovedEvent *>(e);
-        QVector<int> positions = ev->positions();
-        int newpos = ev->newPosition();
-        QVector<QSpotifyTrack *> tracks;
-        for (int i = 0; i < positions.count(); ++i) {
-            int pos = positions.at(i);
-            if (pos < 0 || pos >= m_trackList->count())
-                continue;
-            tracks.append(m_trackList->at(pos));
-            m_trackList->replace(pos, nullptr);
+        if (isReversed()) {
+            // The moved tracks end up before the row of the track that was
+            // at newPosition - 1, in reverse order as well
+            QVector<int> rows;
+            rows.reserve(ev->positions().count());
+            for (auto it = ev->positions().crbegin(); it != ev->positions().crend(); ++it)
+                rows.append(rowOfPosition(*it));
+            m_trackList->moveRows(rows, m_trackList->count() - ev->newPosition());
+        } else {
+            m_trackList->moveRows(ev->positions(), ev->newPosition());
         }
-        for (int i = 0; i < tracks.count(); ++i)
-            m_trackList->insertRow(newpos++, tracks.at(i));
-        m_trackList->removeAll(nullptr);
         postUpdateEvent();
 //        if (QSpotifySession::instance()->playQueue()->isCurrentTrackList(m_trackList))
 // TODO           QSpotifySession::instance()->playQueue()->tracksUpdated();
@@ -468,7 +487,9 @@ bool QSpotifyPlaylist::event(QEvent *e)
         // TrackSeen event
         if (m_type == Inbox) {
             QSpotifyTrackSeenEvent *ev = static_cast<QSpotifyTrackSeenEvent*>(e);
-            m_trackList->at(ev->position())->updateSeen(ev->seen());
+            int row = rowOfPosition(ev->position());
+            if (row >= 0 && row < m_trackList->count())
+                m_trackList->at(row)->updateSeen(ev->seen());
         }
         e->accept();
         return true;
@@ -484,15 +505,42 @@ bool QSpotifyPlaylist::event(QEvent *e)
 void QSpotifyPlaylist::postUpdateEvent()
 {
     if (!m_updateEventPosted) {
-        QCoreApplication::postEvent(this, new QEvent(QEvent::Type(QEvent::User + 7)));
+        QSpotifyEventWatchdog::postEvent(this, new QEvent(QEvent::Type(QEvent::User + 7)));
         m_updateEventPosted = true;
     }
 }
 
-void QSpotifyPlaylist::add(QSpotifyTrack *track)
+int QSpotifyPlaylist::rowOfPosition(int pos) const
+{
+    return isReversed() ? m_trackList->count() - 1 - pos : pos;
+}
+
+bool QSpotifyPlaylist::contains(sp_track *t) const
+{
+    if (m_container)
+        return m_container->occurrences(t, this) > 0;
+    if (m_type == Starred) {
+        QSpotifyUser *user = QSpotifySession::instance()->user();
+        if (user && user->m_starredList == this)
+            return user->isStarred(t);
+    }
+    // Other users' starred lists and the inbox, which is small
+    return m_trackList && m_trackList->records().indexOf(t) >= 0;
+}
+
+bool QSpotifyPlaylist::containsTrack(QSpotifyTrack *track) const
+{
+    return track && contains(track->sptrack());
+}
+
+void QSpotifyPlaylist::add(QSpotifyTrack *track, bool allowDuplicate)
 {
     if (!track)
         return;
+    if (!allowDuplicate && contains(track->sptrack())) {
+        qCDebug(lcPlaylist) << "Not adding" << track->name() << "to" << m_name << "twice";
+        return;
+    }
 
     sp_playlist_add_tracks(m_sp_playlist, const_cast<sp_track* const*>(&track->m_sp_track), 1, m_trackList->count(), QSpotifySession::instance()->spsession());
 }
@@ -503,8 +551,10 @@ void QSpotifyPlaylist::remove(QSpotifyTrack *track)
         return;
 
     int i = m_trackList->indexOf(track);
-    if (i > -1)
-        sp_playlist_remove_tracks(m_sp_playlist, &i, 1);
+    if (i > -1) {
+        int pos = libspotifyPosition(i);
+        sp_playlist_remove_tracks(m_sp_playlist, &pos, 1);
+    }
 }
 
 void QSpotifyPlaylist::addAlbum(QSpotifyAlbumBrowse *album)
@@ -536,14 +586,9 @@ void QSpotifyPlaylist::rename(const QString &name)
 
 int QSpotifyPlaylist::trackCount() const
 {
-    int c = 0;
-    if (m_trackList) {
-        for (int i = 0; i < m_trackList->count(); ++i) {
-            if (m_trackList->at(i)->error() == QSpotifyTrack::Ok)
-                ++c;
-        }
-    }
-    return c;
+    if (!m_trackList)
+        return 0;
+    return m_trackList->records().totals().playable;
 }
 
 int QSpotifyPlaylist::totalDuration() const
@@ -569,11 +614,6 @@ bool QSpotifyPlaylist::isCurrentPlaylist() const
     return QSpotifySession::instance()->m_playQueue->isCurrentTrackList(m_trackList);
 }
 
-byte *QSpotifyPlaylist::getImageIdPtr(const QString &key)
-{
-    return m_imagePointers.value(key, nullptr);
-}
-
 void QSpotifyPlaylist::setCollaborative(bool c)
 {
     sp_playlist_set_collaborative(m_sp_playlist, c);
@@ -610,49 +650,36 @@ void QSpotifyPlaylist::enqueue()
     }
 }
 
+void QSpotifyPlaylist::setAllSeen(bool seen)
+{
+    if (m_type != Inbox || !m_trackList)
+        return;
+    // The tracks are updated by the track_seen_changed callbacks
+    const QSpotifyTrackRecords &records = m_trackList->records();
+    for (int row = 0; row < records.count(); ++row) {
+        if (records.seen(row) != seen)
+            sp_playlist_track_set_seen(m_sp_playlist, libspotifyPosition(row), seen);
+    }
+}
+
 int QSpotifyPlaylist::unseenCount() const
 {
     if (m_type != Inbox)
         return 0;
-
-    int c = 0;
-    for (int i = 0; i < m_trackList->count(); ++i) {
-        QSpotifyTrack *t = m_trackList->at(i);
-        if (t->error() == QSpotifyTrack::Ok && !t->seen())
-            ++c;
-    }
-    return c;
+    return m_trackList->records().totals().unseen;
 }
 
-void QSpotifyPlaylist::onTrackChanged()
+void QSpotifyPlaylist::onRowsDataChanged()
 {
-    if (!sender())
-        return;
-
-    QSpotifyTrack *tr = dynamic_cast<QSpotifyTrack *>(sender());
-    if (!tr)
-        return;
-
-    registerTrackType(tr);
+    updateHasOfflineTracks();
+    emit playlistDataChanged();
 }
 
-void QSpotifyPlaylist::registerTrackType(QSpotifyTrack *t)
+void QSpotifyPlaylist::updateHasOfflineTracks()
 {
-    int oldCount = m_offlineTracks.count();
-    if (t->offlineStatus() == QSpotifyTrack::Yes)
-        m_offlineTracks.insert(t);
-    else
-        m_offlineTracks.remove(t);
-    if ((oldCount == 0 && m_offlineTracks.count() > 0) || (oldCount == 1 && m_offlineTracks.count() == 0))
+    bool hasOffline = m_trackList && m_trackList->records().totals().availableOffline > 0;
+    if (m_hasOfflineTracks != hasOffline) {
+        m_hasOfflineTracks = hasOffline;
         emit hasOfflineTracksChanged();
-
-    if (t->m_isAvailable) {
-        m_availableTracks.insert(t);
     }
 }
-
-void QSpotifyPlaylist::unregisterTrackType(QSpotifyTrack *t)
-{
-    m_offlineTracks.remove(t);
-    m_availableTracks.remove(t);
-}
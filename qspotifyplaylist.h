@@ -48,10 +48,13 @@
 
 #include <libspotify/api.h>
 
+#include "qspotifyid.h"
 #include "qspotifyobject.h"
+#include "qspotifystringpool.h"
 #include "qspotifytracklist.h"
 
 class QSpotifyAlbumBrowse;
+class QSpotifyPlaylistContainer;
 class QSpotifyTrack;
 struct sp_playlist;
 struct sp_playlist_callbacks;
@@ -110,14 +113,14 @@ public:
     int totalDuration() const;
     Type type() const { return m_type; }
     OfflineStatus offlineStatus() const { return m_offlineStatus; }
-    QString owner() const { return m_owner; }
+    QString owner() const { return m_owner.toString(); }
     bool collaborative() const { return m_collaborative; }
     void setCollaborative(bool c);
     int offlineDownloadProgress() const { return m_offlineDownloadProgress; }
     bool availableOffline() const { return m_availableOffline; }
     void setAvailableOffline(bool offline);
     int unseenCount() const;
-    bool hasOfflineTracks() const { return m_offlineTracks.count() > 0; }
+    bool hasOfflineTracks() const { return m_hasOfflineTracks; }
     QList<QObject *> playlists() const { return m_availablePlaylists + m_unavailablePlaylists; }
     int playlistCount() const { return m_availablePlaylists.count() + m_unavailablePlaylists.count(); }
 
@@ -126,15 +129,21 @@ public:
         m_unavailablePlaylists.clear();
     }
 
-    bool contains(sp_track *t) const { return m_tracksSet.contains(t); }
+    bool contains(sp_track *t) const;
+    // For warning about duplicates before adding a track.
+    Q_INVOKABLE bool containsTrack(QSpotifyTrack *track) const;
 
-    Q_INVOKABLE void add(QSpotifyTrack *track);
+    // Tracks already in the playlist are skipped unless allowDuplicate is set.
+    Q_INVOKABLE void add(QSpotifyTrack *track, bool allowDuplicate = false);
     Q_INVOKABLE void remove(QSpotifyTrack *track);
 
     Q_INVOKABLE void addAlbum(QSpotifyAlbumBrowse *album);
 
     Q_INVOKABLE void rename(const QString &name);
 
+    // Inbox only, one call for all rows whose seen state differs.
+    Q_INVOKABLE void setAllSeen(bool seen = true);
+
     Q_INVOKABLE void removeFromContainer();
     Q_INVOKABLE void deleteFolderContent();
 
@@ -142,11 +151,10 @@ public:
 
     Q_INVOKABLE QSpotifyTrackList *tracks() const { return m_trackList; }
 
-    bool hasImageId() const { return m_hasImage; }
-    QString imageId() const { return m_ImageId; }
+    bool hasImageId() const { return m_imageId.isValid(); }
+    QString imageId() const { return m_imageId.toString(); }
     QStringList coverImages() const { return m_coverImages; }
 
-    static byte* getImageIdPtr(const QString &key);
 
 public Q_SLOTS:
     void play();
@@ -170,12 +178,19 @@ protected:
     bool event(QEvent *);
 
 private Q_SLOTS:
-    void onTrackChanged();
+    void onRowsDataChanged();
 
 private:
-    QSpotifyTrack *addTrack(sp_track *track, int pos = -1);
-    void registerTrackType(QSpotifyTrack *t);
-    void unregisterTrackType(QSpotifyTrack *t);
+    // Inserts at row pos, -1 appends.
+    void addTracks(const QVector<sp_track *> &tracks, int pos = -1);
+    // Starred and Inbox rows are newest first, the reverse of libspotify's
+    // order. Rows and positions of tracks in m_trackList, converted either
+    // way; libspotify's callbacks and calls take positions.
+    bool isReversed() const { return m_type == Starred || m_type == Inbox; }
+    int rowOfPosition(int pos) const;
+    int libspotifyPosition(int row) const { return rowOfPosition(row); }
+    // Emits hasOfflineTracksChanged() after the rows changed.
+    void updateHasOfflineTracks();
 
     void postUpdateEvent();
 
@@ -183,37 +198,39 @@ private:
     sp_playlist_callbacks *m_callbacks{};
 
     QSpotifyTrackList *m_trackList{};
-    QSet<sp_track *> m_tracksSet;
+    // Set for playlists of the user's container, which indexes our tracks
+    QSpotifyPlaylistContainer *m_container{};
 
     QString m_name;
     QString m_description;
     Type m_type;
     OfflineStatus m_offlineStatus{No};
-    QString m_owner;
+    QSpotifyInternedString m_owner;
     bool m_collaborative{};
     int m_offlineDownloadProgress{};
     bool m_availableOffline{};
 
-    bool m_hasImage{};
-    QString m_ImageId;
-    QString m_hashKey;
+    QSpotifyId m_imageId;
     QStringList m_coverImages;
 
-    QSet<QSpotifyTrack *> m_offlineTracks;
-    QSet<QSpotifyTrack *> m_availableTracks;
+    bool m_hasOfflineTracks{};
 
     QList<QObject *> m_availablePlaylists;
     QList<QObject *> m_unavailablePlaylists;
 
     QString m_uri;
+    // Folders and their end markers, from the container
+    sp_uint64 m_folderId{};
 
     bool m_skipUpdateTracks{};
 
     bool m_updateEventPosted{};
+    bool m_loadTraced{};
 
     friend class QSpotifyPlaylistContainer;
     friend class QSpotifyUser;
     friend class QSpotifyTrack;
+    friend class QSpotifyPlaylistSnapshot;
 
     friend class QSpotifyCacheManager;
 };
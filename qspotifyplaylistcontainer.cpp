@@ -44,12 +44,27 @@
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDebug>
 #include <QtCore/QStack>
+#include <QtCore/QTimerEvent>
 #include <QtQml/QQmlEngine>
 
 #include <libspotify/api.h>
 
+#include <algorithm>
+
+#include "qspotifyeventwatchdog.h"
+#include "qspotifymetrics.h"
 #include "qspotifyplaylist.h"
 #include "qspotifysession.h"
+#include "qspotifytracklist.h"
+#include "qspotifystartuptimeline.h"
+#include "qspotifytrace.h"
+#include "qspotifyutil.h"
+#include "listmodels/qspotifyplaylistfiltermodel.h"
+#include "listmodels/qspotifyplaylistflatmodel.h"
+#include "listmodels/qspotifyplaylisttreemodel.h"
+
+// Changes within this many milliseconds are written together
+static const int g_snapshotDelay = 3000;
 
 class QSpotifyPlaylistAddedEvent : public QEvent
 {
@@ -104,22 +119,22 @@ private:
 
 static void callback_container_loaded(sp_playlistcontainer *, void *objectPtr)
 {
-    QCoreApplication::postEvent(static_cast<QSpotifyPlaylistContainer *>(objectPtr), new QEvent(QEvent::User));
+    QSpotifyEventWatchdog::postEvent(static_cast<QSpotifyPlaylistContainer *>(objectPtr), new QEvent(QEvent::User));
 }
 
 static void callback_playlist_added(sp_playlistcontainer *, sp_playlist *playlist, int position, void *objectPtr)
 {
-    QCoreApplication::postEvent(static_cast<QSpotifyPlaylistContainer *>(objectPtr), new QSpotifyPlaylistAddedEvent(playlist, position));
+    QSpotifyEventWatchdog::postEvent(static_cast<QSpotifyPlaylistContainer *>(objectPtr), new QSpotifyPlaylistAddedEvent(playlist, position));
 }
 
 static void callback_playlist_removed(sp_playlistcontainer *, sp_playlist *playlist, int position, void *objectPtr)
 {
-    QCoreApplication::postEvent(static_cast<QSpotifyPlaylistContainer *>(objectPtr), new QSpotifyPlaylistRemovedEvent(playlist, position));
+    QSpotifyEventWatchdog::postEvent(static_cast<QSpotifyPlaylistContainer *>(objectPtr), new QSpotifyPlaylistRemovedEvent(playlist, position));
 }
 
 static void callback_playlist_moved(sp_playlistcontainer *, sp_playlist *, int position, int new_position, void *objectPtr)
 {
-    QCoreApplication::postEvent(static_cast<QSpotifyPlaylistContainer *>(objectPtr), new QSpotifyPlaylistMovedEvent(position, new_position));
+    QSpotifyEventWatchdog::postEvent(static_cast<QSpotifyPlaylistContainer *>(objectPtr), new QSpotifyPlaylistMovedEvent(position, new_position));
 }
 
 QSpotifyPlaylistContainer::QSpotifyPlaylistContainer(sp_playlistcontainer *container)
@@ -135,17 +150,35 @@ QSpotifyPlaylistContainer::QSpotifyPlaylistContainer(sp_playlistcontainer *conta
     m_callbacks->container_loaded = callback_container_loaded;
     sp_playlistcontainer_add_callbacks(m_container, m_callbacks, this);
 
+    m_treeModel = new QSpotifyPlaylistTreeModel(this);
+    m_flatModel = new QSpotifyPlaylistFlatModel(m_treeModel, this);
+    m_availableModel = new QSpotifyPlaylistFilterModel(this);
+    m_availableModel->setSourceModel(m_treeModel);
+    QQmlEngine::setObjectOwnership(m_treeModel, QQmlEngine::CppOwnership);
+    QQmlEngine::setObjectOwnership(m_flatModel, QQmlEngine::CppOwnership);
+    QQmlEngine::setObjectOwnership(m_availableModel, QQmlEngine::CppOwnership);
+
     connect(QSpotifySession::instance(), SIGNAL(offlineModeChanged()), this, SLOT(updatePlaylists()));
 }
 
 QSpotifyPlaylistContainer::~QSpotifyPlaylistContainer()
 {
+    if (m_snapshotTimer) {
+        killTimer(m_snapshotTimer);
+        saveSnapshot();
+    }
     if (m_container) {
         sp_playlistcontainer_remove_callbacks(m_container, m_callbacks, this);
         sp_playlistcontainer_release(m_container);
     }
+    m_trackIndex.clear();
+    // Views must not see the playlists deleted below
+    m_treeModel->reset(QList<QSpotifyPlaylist *>());
+    for (QSpotifyPlaylist *pl : m_playlists)
+        pl->m_container = nullptr;
     qDeleteAll(m_playlists);
     m_playlists.clear();
+    m_positions.clear();
     delete m_callbacks;
 }
 
@@ -166,7 +199,14 @@ bool QSpotifyPlaylistContainer::updateData()
                 sp_playlistcontainer_remove_playlist(m_container, i);
         }
         updated = true;
+        if (m_treeModel->isSnapshot())
+            reconcileSnapshot();
+        else
+            m_treeModel->reset(m_playlists);
         updatePlaylists();
+        // Playlists that were already loaded never emit isLoadedChanged().
+        if (isLoaded())
+            onPlaylistLoaded();
     }
 
     return updated;
@@ -208,10 +248,13 @@ void QSpotifyPlaylistContainer::updatePlaylists()
         }
     }
 
+    if (!m_playlistsFlat.isEmpty())
+        QSpotifyStartupTimeline::instance().mark("playlists.visible");
+
     emit playlistContainerDataChanged();
 }
 
-void QSpotifyPlaylistContainer::addPlaylist(sp_playlist *playlist, int pos)
+int QSpotifyPlaylistContainer::addPlaylist(sp_playlist *playlist, int pos)
 {
     Q_ASSERT(playlist);
 
@@ -227,40 +270,86 @@ void QSpotifyPlaylistContainer::addPlaylist(sp_playlist *playlist, int pos)
 
     sp_playlist_type type = sp_playlistcontainer_playlist_type(m_container, pos);
     QSpotifyPlaylist *pl = new QSpotifyPlaylist(QSpotifyPlaylist::Type(type), playlist);
+    // Before init(), which adds the tracks that are loaded already
+    pl->m_container = this;
+    // Usually known for playlists in the container before they are loaded,
+    // the snapshot is matched by it
+    if (type == SP_PLAYLIST_TYPE_PLAYLIST)
+        pl->m_uri = QString::fromUtf8(QSpotifyUtil::spLinkToByteArray(sp_link_create_from_playlist(playlist)));
     pl->init();
     QQmlEngine::setObjectOwnership(pl, QQmlEngine::CppOwnership);
-    if (pos == -1)
+    if (pos == -1) {
+        pos = m_playlists.count();
         m_playlists.append(pl);
-    else
+    } else {
         m_playlists.insert(pos, pl);
+    }
+    m_positions.clear();
+    if (type == SP_PLAYLIST_TYPE_START_FOLDER || type == SP_PLAYLIST_TYPE_END_FOLDER)
+        pl->m_folderId = sp_playlistcontainer_playlist_folder_id(m_container, pos);
     if (type == SP_PLAYLIST_TYPE_START_FOLDER) {
         char buffer[200];
         sp_playlistcontainer_playlist_folder_name(m_container, pos, buffer, 200);
         pl->m_name = QString::fromUtf8(buffer);
     }
     connect(pl, SIGNAL(nameChanged()), this, SIGNAL(playlistsNameChanged()));
+    // Not on playlistDataChanged(), download progress emits that all the time
+    connect(pl, SIGNAL(nameChanged()), this, SLOT(scheduleSnapshot()));
+    connect(pl, SIGNAL(isLoadedChanged()), this, SLOT(scheduleSnapshot()));
+    connect(pl, SIGNAL(tracksAdded(QVector<sp_track*>)), this, SLOT(scheduleSnapshot()));
+    connect(pl, SIGNAL(tracksRemoved(QVector<sp_track*>)), this, SLOT(scheduleSnapshot()));
+    connect(pl, SIGNAL(availableOfflineChanged()), this, SLOT(scheduleSnapshot()));
+    if (!QSpotifyStartupTimeline::instance().isFinished())
+        connect(pl, SIGNAL(isLoadedChanged()), this, SLOT(onPlaylistLoaded()));
+    return pos;
+}
+
+void QSpotifyPlaylistContainer::onPlaylistLoaded()
+{
+    QSpotifyStartupTimeline &timeline = QSpotifyStartupTimeline::instance();
+    if (!timeline.isFinished()) {
+        for (QSpotifyPlaylist *pl : m_playlists) {
+            if (!pl->isLoaded())
+                return;
+        }
+        timeline.mark("playlists.loaded");
+        timeline.finish();
+    }
+
+    for (QSpotifyPlaylist *pl : m_playlists)
+        disconnect(pl, SIGNAL(isLoadedChanged()), this, SLOT(onPlaylistLoaded()));
 }
 
 bool QSpotifyPlaylistContainer::event(QEvent *e)
 {
+    QSpotifyEventWatchdog::Scope watchdog(this, e);
+    QSpotifyMetrics::countEvent(this, e);
     if (e->type() == QEvent::User) {
+        QSpotifyStartupTimeline::instance().mark("container.loaded");
         metadataUpdated();
+        // The playlists may have been added one by one before
+        reconcileSnapshot();
         e->accept();
         return true;
     } else if (e->type() == QEvent::User + 1) {
         // PlaylistAdded event
         QSpotifyPlaylistAddedEvent *ev = static_cast<QSpotifyPlaylistAddedEvent *>(e);
-        addPlaylist(ev->playlist(), ev->position());
+        int pos = addPlaylist(ev->playlist(), ev->position());
+        m_treeModel->entryInserted(m_playlists, pos);
         postUpdateEvent();
         e->accept();
         return true;
     } else if (e->type() == QEvent::User + 2) {
         // PlaylistRemoved event
-        qDebug() << "Playlist removed event";
+        qCDebug(lcPlaylist) << "Playlist removed event";
         QSpotifyPlaylistRemovedEvent *ev = static_cast<QSpotifyPlaylistRemovedEvent *>(e);
         int i = ev->position();
         if (i >= 0 && i < m_playlists.count() && m_playlists.at(i)->m_sp_playlist == ev->playlist()) {
             QSpotifyPlaylist *pl = m_playlists.takeAt(i);
+            m_positions.clear();
+            m_treeModel->entryRemoved(m_playlists, pl);
+            unindexPlaylist(pl);
+            pl->m_container = nullptr;
             pl->deleteLater();
             postUpdateEvent();
         }
@@ -273,7 +362,10 @@ bool QSpotifyPlaylistContainer::event(QEvent *e)
         int newpos = ev->newPosition();
         if (i >= 0 && i < m_playlists.count()) {
             QSpotifyPlaylist *pl = m_playlists.takeAt(i);
-            m_playlists.insert(newpos > i ? newpos - 1 : newpos, pl);
+            int pos = qBound(0, newpos > i ? newpos - 1 : newpos, m_playlists.count());
+            m_playlists.insert(pos, pl);
+            m_positions.clear();
+            m_treeModel->entryMoved(m_playlists, pos);
             postUpdateEvent();
         }
         e->accept();
@@ -281,16 +373,125 @@ bool QSpotifyPlaylistContainer::event(QEvent *e)
     } else if (e->type() == QEvent::User + 4) {
         updatePlaylists();
         m_updateEventPosted = false;
+        scheduleSnapshot();
         e->accept();
         return true;
     }
     return QSpotifyObject::event(e);
 }
 
+void QSpotifyPlaylistContainer::timerEvent(QTimerEvent *e)
+{
+    if (e->timerId() != m_snapshotTimer) {
+        QSpotifyObject::timerEvent(e);
+        return;
+    }
+    killTimer(m_snapshotTimer);
+    m_snapshotTimer = 0;
+    saveSnapshot();
+}
+
+void QSpotifyPlaylistContainer::loadSnapshot(const QString &fileName)
+{
+    m_snapshotFile = fileName;
+    if (!m_playlists.isEmpty())
+        return;
+
+    QList<QSpotifyPlaylistSnapshot::Entry> entries = QSpotifyPlaylistSnapshot::read(fileName);
+    qCDebug(lcPlaylist) << "Playlist snapshot" << fileName << "has" << entries.count() << "entries";
+    if (entries.isEmpty())
+        return;
+    m_treeModel->showSnapshot(entries);
+    m_snapshot = entries;
+    QSpotifyStartupTimeline::instance().mark("playlists.visible");
+}
+
+void QSpotifyPlaylistContainer::reconcileSnapshot()
+{
+    // Until then the entries are incomplete, reconciling would drop the
+    // snapshot rows of the playlists not added yet
+    if (!m_treeModel->isSnapshot() || !isLoaded())
+        return;
+    m_treeModel->reset(m_playlists);
+    QSpotifyStartupTimeline::instance().mark("snapshot.reconciled");
+}
+
+void QSpotifyPlaylistContainer::scheduleSnapshot()
+{
+    if (!m_snapshotFile.isEmpty() && !m_snapshotTimer)
+        m_snapshotTimer = startTimer(g_snapshotDelay);
+}
+
+void QSpotifyPlaylistContainer::saveSnapshot()
+{
+    // Before that the model still shows the last snapshot, if any
+    if (m_snapshotFile.isEmpty() || !isLoaded() || m_treeModel->isSnapshot())
+        return;
+    QList<QSpotifyPlaylistSnapshot::Entry> entries = m_treeModel->snapshot();
+    // Most updates, like download progress, don't change what is shown
+    if (entries == m_snapshot)
+        return;
+    QSPOTIFY_TRACE_SPAN("playlist", "saveSnapshot");
+    if (QSpotifyPlaylistSnapshot::write(m_snapshotFile, entries))
+        m_snapshot = entries;
+}
+
+QList<QSpotifyPlaylist *> QSpotifyPlaylistContainer::playlistsContaining(sp_track *track) const
+{
+    QList<QSpotifyPlaylist *> result;
+    for (QSpotifyPlaylist *pl : m_trackIndex.value(track)) {
+        if (!result.contains(pl))
+            result.append(pl);
+    }
+    if (result.count() < 2)
+        return result;
+    if (m_positions.isEmpty()) {
+        m_positions.reserve(m_playlists.count());
+        for (int i = 0; i < m_playlists.count(); ++i)
+            m_positions.insert(m_playlists.at(i), i);
+    }
+    std::sort(result.begin(), result.end(), [this](QSpotifyPlaylist *a, QSpotifyPlaylist *b) {
+        return m_positions.value(a) < m_positions.value(b);
+    });
+    return result;
+}
+
+int QSpotifyPlaylistContainer::occurrences(sp_track *track, const QSpotifyPlaylist *playlist) const
+{
+    auto it = m_trackIndex.constFind(track);
+    return it == m_trackIndex.constEnd() ? 0 : it->count(const_cast<QSpotifyPlaylist *>(playlist));
+}
+
+void QSpotifyPlaylistContainer::indexTrack(QSpotifyPlaylist *playlist, sp_track *track)
+{
+    m_trackIndex[track].append(playlist);
+}
+
+void QSpotifyPlaylistContainer::unindexTrack(QSpotifyPlaylist *playlist, sp_track *track)
+{
+    auto it = m_trackIndex.find(track);
+    if (it == m_trackIndex.end())
+        return;
+    int i = it->indexOf(playlist);
+    if (i >= 0)
+        it->remove(i);
+    if (it->isEmpty())
+        m_trackIndex.erase(it);
+}
+
+void QSpotifyPlaylistContainer::unindexPlaylist(QSpotifyPlaylist *playlist)
+{
+    if (!playlist->m_trackList)
+        return;
+    const QSpotifyTrackRecords &records = playlist->m_trackList->records();
+    for (int row = 0; row < records.count(); ++row)
+        unindexTrack(playlist, records.track(row));
+}
+
 void QSpotifyPlaylistContainer::postUpdateEvent()
 {
     if (!m_updateEventPosted) {
-        QCoreApplication::postEvent(this, new QEvent(QEvent::Type(QEvent::User + 4)));
+        QSpotifyEventWatchdog::postEvent(this, new QEvent(QEvent::Type(QEvent::User + 4)));
         m_updateEventPosted = true;
     }
 }
@@ -42,13 +42,20 @@
 #ifndef QSPOTIFYPLAYLISTCONTAINER_H
 #define QSPOTIFYPLAYLISTCONTAINER_H
 
+#include <QtCore/QHash>
 #include <QtCore/QMetaType>
+#include <QtCore/QVector>
 
 #include "qspotifyobject.h"
+#include "qspotifyplaylistsnapshot.h"
 
 class QSpotifyPlaylist;
+class QSpotifyPlaylistFilterModel;
+class QSpotifyPlaylistFlatModel;
+class QSpotifyPlaylistTreeModel;
 struct sp_playlist;
 struct sp_playlistcontainer;
+struct sp_track;
 struct sp_playlistcontainer_callbacks;
 
 class QSpotifyPlaylistContainer : public QSpotifyObject
@@ -63,8 +70,20 @@ public:
     QList<QObject *> formattedPlaylists() const { return m_formattedAvailablePlaylists + m_formattedUnavailablePlaylists; }
     QList<QObject *> playlistsFlat() const { return m_playlistsFlat; }
 
+    // Updated row by row as playlists are added, removed and moved, unlike
+    // the lists above which are rebuilt on every change.
+    QSpotifyPlaylistTreeModel *treeModel() const { return m_treeModel; }
+    QSpotifyPlaylistFlatModel *flatModel() const { return m_flatModel; }
+    // The tree without what can't be played in offline mode.
+    QSpotifyPlaylistFilterModel *availableModel() const { return m_availableModel; }
+
     sp_playlistcontainer *spcontainer() { return m_container; }
 
+    // Playlists of this container that contain track, in container order.
+    QList<QSpotifyPlaylist *> playlistsContaining(sp_track *track) const;
+    // How often track is in playlist.
+    int occurrences(sp_track *track, const QSpotifyPlaylist *playlist) const;
+
 Q_SIGNALS:
     void playlistContainerDataChanged();
     void playlistsNameChanged();
@@ -73,16 +92,33 @@ protected:
     bool updateData();
 
     bool event(QEvent *);
+    void timerEvent(QTimerEvent *);
 
 private Q_SLOTS:
     void updatePlaylists();
+    void onPlaylistLoaded();
+    void scheduleSnapshot();
 
 private:
     QSpotifyPlaylistContainer(sp_playlistcontainer *container);
-    void addPlaylist(sp_playlist *, int pos = -1);
+    // Returns the position the playlist was added at.
+    int addPlaylist(sp_playlist *, int pos = -1);
 
     void postUpdateEvent();
 
+    // Shows the snapshot in fileName until the container is loaded and
+    // keeps it up to date from then on.
+    void loadSnapshot(const QString &fileName);
+    // Matches the snapshot shown against the playlists once the container
+    // is loaded.
+    void reconcileSnapshot();
+    void saveSnapshot();
+
+    // Kept up to date by the playlists as their tracks are added and removed
+    void indexTrack(QSpotifyPlaylist *playlist, sp_track *track);
+    void unindexTrack(QSpotifyPlaylist *playlist, sp_track *track);
+    void unindexPlaylist(QSpotifyPlaylist *playlist);
+
     sp_playlistcontainer *m_container;
     sp_playlistcontainer_callbacks *m_callbacks;
 
@@ -91,8 +127,23 @@ private:
     QList<QObject *> m_formattedUnavailablePlaylists;
     QList<QObject *> m_playlistsFlat;
 
+    QSpotifyPlaylistTreeModel *m_treeModel;
+    QSpotifyPlaylistFlatModel *m_flatModel;
+    QSpotifyPlaylistFilterModel *m_availableModel;
+
+    // Reverse index over all playlists: a playlist is listed once for
+    // every occurrence of the track in it.
+    QHash<sp_track *, QVector<QSpotifyPlaylist *> > m_trackIndex;
+    // Index of each playlist in m_playlists for sorting, built on demand
+    // and dropped when the playlists change
+    mutable QHash<QSpotifyPlaylist *, int> m_positions;
+
     bool m_updateEventPosted{};
 
+    QString m_snapshotFile;
+    QList<QSpotifyPlaylistSnapshot::Entry> m_snapshot;
+    int m_snapshotTimer{};
+
     friend class QSpotifyUser;
     friend class QSpotifyPlaylist;
 };
@@ -0,0 +1,85 @@
+#include "qspotifyplaylistsnapshot.h"
+
+#include <QtCore/QDataStream>
+#include <QtCore/QDebug>
+#include <QtCore/QFile>
+#include <QtCore/QSaveFile>
+#include <QtCore/QtEndian>
+
+#include "qspotifyplaylist.h"
+#include "qspotifytrace.h"
+
+static const char g_magic[4] = { 'Q', 'S', 'P', 'S' };
+static const int g_headerSize = 8;
+
+static QByteArray header()
+{
+    QByteArray h(g_magic, sizeof(g_magic));
+    uchar version[4];
+    qToBigEndian<quint32>(QSpotifyPlaylistSnapshot::FormatVersion, version);
+    h.append(reinterpret_cast<const char *>(version), sizeof(version));
+    return h;
+}
+
+static QDataStream &operator<<(QDataStream &ds, const QSpotifyPlaylistSnapshot::Entry &e)
+{
+    return ds << e.key << e.type << e.name << e.owner << e.imageId
+              << e.trackCount << e.duration << e.availableOffline << e.coverImages;
+}
+
+static QDataStream &operator>>(QDataStream &ds, QSpotifyPlaylistSnapshot::Entry &e)
+{
+    return ds >> e.key >> e.type >> e.name >> e.owner >> e.imageId
+              >> e.trackCount >> e.duration >> e.availableOffline >> e.coverImages;
+}
+
+QList<QSpotifyPlaylistSnapshot::Entry> QSpotifyPlaylistSnapshot::read(const QString &fileName)
+{
+    QList<Entry> entries;
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return entries;
+    if (file.read(g_headerSize) != header()) {
+        qCDebug(lcCache) << "Ignoring playlist snapshot" << fileName << "of another format";
+        return entries;
+    }
+
+    QDataStream ds(&file);
+    ds.setVersion(QDataStream::Qt_5_0);
+    ds >> entries;
+    if (ds.status() != QDataStream::Ok) {
+        qCWarning(lcCache) << "Cannot read playlist snapshot" << fileName;
+        entries.clear();
+    }
+    return entries;
+}
+
+bool QSpotifyPlaylistSnapshot::write(const QString &fileName, const QList<Entry> &entries)
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(lcCache) << "Cannot write playlist snapshot" << fileName << file.errorString();
+        return false;
+    }
+
+    file.write(header());
+    QDataStream ds(&file);
+    ds.setVersion(QDataStream::Qt_5_0);
+    ds << entries;
+    if (ds.status() != QDataStream::Ok || !file.commit()) {
+        qCWarning(lcCache) << "Cannot write playlist snapshot" << fileName << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+QByteArray QSpotifyPlaylistSnapshot::key(const QSpotifyPlaylist *playlist)
+{
+    switch (playlist->type()) {
+    case QSpotifyPlaylist::Folder:
+    case QSpotifyPlaylist::FolderEnd:
+        return "folder:" + QByteArray::number(quint64(playlist->m_folderId));
+    default:
+        return playlist->m_uri.toLatin1();
+    }
+}
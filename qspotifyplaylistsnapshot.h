@@ -0,0 +1,63 @@
+#ifndef QSPOTIFYPLAYLISTSNAPSHOT_H
+#define QSPOTIFYPLAYLISTSNAPSHOT_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QList>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+class QSpotifyPlaylist;
+
+/**
+ * What the user's playlist container showed the last time it had settled,
+ * so the playlists can be shown at startup before libspotify has loaded
+ * them.
+ *
+ * The file starts with the magic "QSPS" and a big endian quint32 format
+ * version, followed by the entries written with QDataStream (Qt_5_0) as a
+ * QList<Entry>, each being:
+ *
+ *   QByteArray key, qint32 type, QString name, QString owner,
+ *   QString imageId, qint32 trackCount, qint32 duration,
+ *   bool availableOffline, QStringList coverImages
+ *
+ * Entries are in container order, folder start and end markers included.
+ * The file is replaced as a whole.
+ */
+class QSpotifyPlaylistSnapshot
+{
+public:
+    enum { FormatVersion = 1 };
+
+    struct Entry {
+        // See key()
+        QByteArray key;
+        qint32 type{};
+        QString name;
+        QString owner;
+        QString imageId;
+        qint32 trackCount{};
+        qint32 duration{};
+        bool availableOffline{};
+        QStringList coverImages;
+
+        bool operator==(const Entry &o) const
+        {
+            return key == o.key && type == o.type && name == o.name && owner == o.owner
+                    && imageId == o.imageId && trackCount == o.trackCount && duration == o.duration
+                    && availableOffline == o.availableOffline && coverImages == o.coverImages;
+        }
+        bool operator!=(const Entry &o) const { return !(*this == o); }
+    };
+
+    // Empty if the file is missing, corrupt or of another format version.
+    static QList<Entry> read(const QString &fileName);
+    static bool write(const QString &fileName, const QList<Entry> &entries);
+
+    // Identifies the playlist across runs: the URI for playlists, the
+    // folder id for folders. Empty if libspotify could not tell the URI
+    // yet, see QSpotifyPlaylistContainer::addPlaylist().
+    static QByteArray key(const QSpotifyPlaylist *playlist);
+};
+
+#endif // QSPOTIFYPLAYLISTSNAPSHOT_H
@@ -43,8 +43,11 @@
 
 #include <QtCore/QDebug>
 
+#include <libspotify/api.h>
+
 #include "qspotifysession.h"
 #include "qspotifytracklist.h"
+#include "qspotifytrace.h"
 
 QSpotifyPlayQueue::QSpotifyPlayQueue(QObject *parent)
     : QSpotifyTrackList(parent)
@@ -55,7 +58,7 @@ void QSpotifyPlayQueue::playTrack(QSpotifyTrackList *list, int index)
 //    qDebug() << "QSpotifyPlayQueue::playTrack" << list << " at " << index;
     adaptTrackList(list);
 
-    playTrackAt(indexOf(list->at(index)));
+    playTrackAt(m_records.indexOf(list->m_records.track(index)));
 
     if (m_shuffle) setShuffle(m_shuffle, true);
 }
@@ -74,28 +77,28 @@ void QSpotifyPlayQueue::adaptTrackList(QSpotifyTrackList *list)
 
     int index = 0;
     for (int i = 0; i < size; ++i) {
-        auto t = list->at(i);
-        if (t->isAvailable()) {
-            m_originalIndexes.push_back(index++);
-            t->addRef();
-            m_initialTracks.push_back(t);
-        }
+        if (!list->records().isAvailable(i))
+            continue;
+        sp_track *t = list->m_records.track(i);
+        sp_track_add_ref(t);
+        m_originalIndexes.push_back(index++);
+        m_initialTracks.push_back(t);
     }
 
-    appendRows(m_initialTracks);
+    insertTracks(0, m_initialTracks);
 }
 
 void QSpotifyPlayQueue::enqueueTrack(QSpotifyTrack *track)
 {
-    qDebug() << "QSpotifyPlayQueue::enqueueTrack" << track;
+    qCDebug(lcPlayback) << "QSpotifyPlayQueue::enqueueTrack" << track;
     if (track && track->isAvailable()) {
         track->addRef();
         int insertIndex = 0;
-        if (m_currentTrack && (m_explicitTracks.empty() || m_currentTrack != m_explicitTracks.front()))
+        if (m_currentTrack && (m_explicitTracks.empty() || m_currentTrack->sptrack() != m_explicitTracks.front()))
             ++insertIndex;
         insertIndex += m_explicitTracks.size();
 
-        m_explicitTracks.enqueue(track);
+        m_explicitTracks.enqueue(track->sptrack());
 
         insertRow(insertIndex, track);
     }
@@ -105,23 +108,33 @@ void QSpotifyPlayQueue::enqueueTracks(QSpotifyTrackList *list)
 {
     if (list) {
         int insertIndex = 0;
-        if (m_currentTrack && (m_explicitTracks.empty() || m_currentTrack != m_explicitTracks.front()))
+        if (m_currentTrack && (m_explicitTracks.empty() || m_currentTrack->sptrack() != m_explicitTracks.front()))
             ++insertIndex;
         insertIndex += m_explicitTracks.size();
 
-        for (auto t : *list) {
-            if (t->isAvailable()) {
-                t->addRef();
-                m_explicitTracks.enqueue(t);
-                insertRow(insertIndex++, t);
-            }
+        QVector<sp_track *> tracks;
+        for (int i = 0; i < list->count(); ++i) {
+            if (!list->records().isAvailable(i))
+                continue;
+            sp_track *t = list->m_records.track(i);
+            m_explicitTracks.enqueue(t);
+            tracks.append(t);
         }
+        insertTracks(insertIndex, tracks);
+    }
+}
+
+void QSpotifyPlayQueue::dropRows(int row, int count)
+{
+    for (auto t : takeRows(row, count)) {
+        if (t)
+            t->release();
     }
 }
 
 bool QSpotifyPlayQueue::playTrackAt(int i)
 {
-    qDebug() << "playTrackAt" << i;
+    qCDebug(lcPlayback) << "playTrackAt" << i;
     if (m_currentTrack) {
         m_currentTrack->release();
         m_currentTrack = nullptr;
@@ -133,17 +146,17 @@ bool QSpotifyPlayQueue::playTrackAt(int i)
         return false;
     }
 
-    while (i > 0) {
-        auto t = takeRow(0);
-        if (!m_explicitTracks.empty() && t == m_explicitTracks.front()) {
-            t->release();
-            m_explicitTracks.takeFirst();
-        }
-        --i;
+    for (int row = 0; row < i; ++row) {
+        if (!m_explicitTracks.empty() && trackAt(row) == m_explicitTracks.front())
+            m_explicitTracks.dequeue();
     }
+    dropRows(0, i);
 
     m_currentTrack = at(0);
     m_currentTrack->addRef();
+    // Lets libspotify load the next track while this one plays
+    if (count() > 1)
+        at(1);
     m_currentIndex = 0;
     emit currentPlayIndexChanged();
     playCurrentTrack();
@@ -152,7 +165,7 @@ bool QSpotifyPlayQueue::playTrackAt(int i)
 
 void QSpotifyPlayQueue::playCurrentTrack()
 {
-    qDebug() << "playCurrentTrack";
+    qCDebug(lcPlayback) << "playCurrentTrack";
     if (!m_currentTrack)
         return;
 
@@ -184,7 +197,7 @@ void QSpotifyPlayQueue::shuffleInitialTracks()
 
 void QSpotifyPlayQueue::clear()
 {
-    qDebug() << "QSpotifyPlayQueue::clear()";
+    qCDebug(lcPlayback) << "QSpotifyPlayQueue::clear()";
     clearQueue();
 }
 
@@ -197,8 +210,8 @@ void QSpotifyPlayQueue::playNext(bool repeatOne)
             playTrackAt(1);
         } else {
             if (m_repeat) {
-                takeRow(0);
-                appendRows(m_initialTracks);
+                dropRows(0, 1);
+                insertTracks(count(), m_initialTracks);
                 playTrackAt(0);
             } else {
                 QSpotifySession::instance()->stop();
@@ -210,19 +223,19 @@ void QSpotifyPlayQueue::playNext(bool repeatOne)
 
 void QSpotifyPlayQueue::playPrevious()
 {
-    int currentIndex = m_initialTracks.indexOf(m_currentTrack);
+    int currentIndex = m_currentTrack ? m_initialTracks.indexOf(m_currentTrack->sptrack()) : -1;
     if (currentIndex - 1 >= 0) {
         auto trackToAdd = m_initialTracks.at(currentIndex - 1);
-        int index = indexOf(trackToAdd);
-        if (index > - 1 && index < count()) takeRow(index);
-        insertRow(0, trackToAdd);
+        int index = m_records.indexOf(trackToAdd);
+        if (index > - 1 && index < count()) dropRows(index, 1);
+        insertTracks(0, QVector<sp_track *>() << trackToAdd);
         playTrackAt(0);
     } else {
-        if (m_repeat) {
+        if (m_repeat && !m_initialTracks.isEmpty()) {
             auto trackToAdd = m_initialTracks.at(m_initialTracks.size()-1);
-            int index = indexOf(trackToAdd);
-            if (index > - 1 && index < count()) takeRow(index);
-            insertRow(0, trackToAdd);
+            int index = m_records.indexOf(trackToAdd);
+            if (index > - 1 && index < count()) dropRows(index, 1);
+            insertTracks(0, QVector<sp_track *>() << trackToAdd);
             playTrackAt(0);
         } else {
             QSpotifySession::instance()->stop();
@@ -233,14 +246,9 @@ void QSpotifyPlayQueue::playPrevious()
 
 void QSpotifyPlayQueue::clearQueue()
 {
-    qDebug() << "QSpotifyPlayQueue::clearQueue()";
-    if (m_dataList.size()) {
-        beginRemoveRows(QModelIndex(),0, m_dataList.size()-1);
-        for (auto t : m_dataList)
-            disconnect(t, &QSpotifyObject::dataChanged, this, &QSpotifyPlayQueue::itemDataChanged);
-        m_dataList.clear();
-        endRemoveRows();
-    }
+    qCDebug(lcPlayback) << "QSpotifyPlayQueue::clearQueue()";
+    // Releases the objects of the rows
+    ListModelBase<QSpotifyTrack>::clear();
 
     if (m_currentTrack) {
         m_currentTrack->release();
@@ -249,44 +257,41 @@ void QSpotifyPlayQueue::clearQueue()
     }
 
     for (auto t : m_initialTracks)
-        t->release();
+        sp_track_release(t);
     m_initialTracks.clear();
     m_originalIndexes.clear();
     m_sourceTrackList = nullptr;
 
-    while (!m_explicitTracks.empty())
-        m_explicitTracks.takeFirst()->release();
+    m_explicitTracks.clear();
 }
 
 void QSpotifyPlayQueue::setShuffle(bool s, bool force)
 {
     if (!force && s == m_shuffle) return;
-    qDebug() << "QSpotifyPlayQueue::setShuffle" << s;
+    qCDebug(lcPlayback) << "QSpotifyPlayQueue::setShuffle" << s;
 
     m_shuffle = s;
     if (s) {
         shuffleInitialTracks();
-        int currentIndex = m_initialTracks.indexOf(m_currentTrack);
+        int currentIndex = m_currentTrack ? m_initialTracks.indexOf(m_currentTrack->sptrack()) : -1;
         if (currentIndex >= 0) {
             int insertIndex = 1 + m_explicitTracks.size();
-            while (count() > insertIndex) takeRow(insertIndex);
-            for (int i = currentIndex + 1; i < m_initialTracks.size(); ++i)
-                appendRow(m_initialTracks.at(i));
+            if (count() > insertIndex) dropRows(insertIndex, count() - insertIndex);
+            insertTracks(count(), m_initialTracks.mid(currentIndex + 1));
         } else {
             // Current track is explicit.
             int insertIndex = 1 + m_explicitTracks.size();
             if (insertIndex < count()) {
-                auto track = at(insertIndex);
+                auto track = trackAt(insertIndex);
                 int initialIndex = m_initialTracks.indexOf(track);
-                while (count() > insertIndex) takeRow(insertIndex);
-                for (int i = initialIndex; i < m_initialTracks.size(); ++i)
-                    appendRow(m_initialTracks.at(i));
+                dropRows(insertIndex, count() - insertIndex);
+                insertTracks(count(), m_initialTracks.mid(initialIndex));
             }
 
         }
     } else {
         int size = m_initialTracks.size();
-        int trackIndex = m_initialTracks.indexOf(m_currentTrack);
+        int trackIndex = m_currentTrack ? m_initialTracks.indexOf(m_currentTrack->sptrack()) : -1;
         if (trackIndex >= 0)
             trackIndex = m_originalIndexes[trackIndex];
         else // TODO fix for explicit
@@ -307,9 +312,8 @@ void QSpotifyPlayQueue::setShuffle(bool s, bool force)
 
         // TODO fix for explicit
         int insertIndex = 1 + m_explicitTracks.size();
-        while (count() > insertIndex) takeRow(insertIndex);
-        for (int i = trackIndex + 1; i < m_initialTracks.size(); ++i)
-            appendRow(m_initialTracks.at(i));
+        if (count() > insertIndex) dropRows(insertIndex, count() - insertIndex);
+        insertTracks(count(), m_initialTracks.mid(trackIndex + 1));
     }
 }
 
@@ -322,7 +326,7 @@ void QSpotifyPlayQueue::setRepeat(bool r)
 
 void QSpotifyPlayQueue::onTrackReady()
 {
-    qDebug() << "QSpotifyPlayQueue::onTrackReady";
+    qCDebug(lcPlayback) << "QSpotifyPlayQueue::onTrackReady";
     disconnect(this, SLOT(onTrackReady()));
     if (m_currentTrack) QSpotifySession::instance()->play(m_currentTrack);
 }
@@ -334,12 +338,12 @@ bool QSpotifyPlayQueue::isCurrentTrackList(QSpotifyTrackList *tl)
 
 bool QSpotifyPlayQueue::isExplicitTrack(int index)
 {
-    return index >= 0 && index < count() && m_explicitTracks.contains(at(index));
+    return index >= 0 && index < count() && m_explicitTracks.contains(trackAt(index));
 }
 
 void QSpotifyPlayQueue::onOfflineModeChanged()
 {
-    qDebug() << "NYI";
+    qCDebug(lcPlayback) << "NYI";
 //    if (m_shuffle && m_implicitTracks)
 //        m_implicitTracks->setShuffle(true);
     //    emit tracksChanged();
@@ -90,9 +90,16 @@ private:
 
     void shuffleInitialTracks();
 
+    sp_track *trackAt(int row) const { return m_records.track(row); }
+    // Removes the rows and releases their objects.
+    void dropRows(int row, int count);
+
+    // Rows are lazy, only the current and the next track get an object
     QVector<int> m_originalIndexes;
-    QQueue<QSpotifyTrack *> m_explicitTracks;
-    QList<QSpotifyTrack *> m_initialTracks;
+    // Enqueued tracks still in the rows after the current one
+    QQueue<sp_track *> m_explicitTracks;
+    // In play order, with a libspotify reference each
+    QVector<sp_track *> m_initialTracks;
 
     // The tracklist from which the current tracks are from, this should NEVER be accessed!
     QSpotifyTrackList* m_sourceTrackList{};
@@ -59,6 +59,9 @@
 #include "qspotifyuser.h"
 #include "qspotifyplayqueue.h"
 #include "qspotifycachemanager.h"
+#include "qspotifymemory.h"
+#include "qspotifymetrics.h"
+#include "qspotifytrace.h"
 
 #include "listmodels/qspotifyartistlist.h"
 #include "listmodels/qspotifyalbumlist.h"
@@ -163,6 +166,8 @@ void QSpotifySearch::search(bool preview)
                         sp_search_type(m_searchType), callback_search_complete, nullptr);
         }
         g_searchObjects.insert(m_sp_search, this);
+        QSPOTIFY_TRACE_BEGIN("search", "search", this);
+        m_requestTimer.start();
     } else {
         populateResults(nullptr);
     }
@@ -182,6 +187,8 @@ void QSpotifySearch::searchAlbums()
                     0, 0, 0, 0,
                     sp_search_type(m_searchType), callback_search_complete, typePtr);
         g_searchObjects.insert(m_sp_search, this);
+        QSPOTIFY_TRACE_BEGIN("search", "search", this);
+        m_requestTimer.start();
     }
 }
 
@@ -199,6 +206,8 @@ void QSpotifySearch::searchArtists()
                     0, m_artistsLimit, 0, 0,
                     sp_search_type(m_searchType), callback_search_complete, typePtr);
         g_searchObjects.insert(m_sp_search, this);
+        QSPOTIFY_TRACE_BEGIN("search", "search", this);
+        m_requestTimer.start();
     }
 }
 
@@ -216,6 +225,8 @@ void QSpotifySearch::searchPlaylists()
                     0, 0, 0, m_playlistsLimit,
                     sp_search_type(m_searchType), callback_search_complete, typePtr);
         g_searchObjects.insert(m_sp_search, this);
+        QSPOTIFY_TRACE_BEGIN("search", "search", this);
+        m_requestTimer.start();
     }
 }
 
@@ -233,6 +244,8 @@ void QSpotifySearch::searchTracks()
                     0, 0, 0, 0,
                     sp_search_type(m_searchType), callback_search_complete, typePtr);
         g_searchObjects.insert(m_sp_search, this);
+        QSPOTIFY_TRACE_BEGIN("search", "search", this);
+        m_requestTimer.start();
     }
 }
 
@@ -255,6 +268,12 @@ bool QSpotifySearch::event(QEvent *e)
                 g_mutex.lock();
                 bool is_current = (m_sp_search == search);
                 g_mutex.unlock();
+                QSPOTIFY_TRACE_END("search", "search", this);
+                if (is_current) {
+                    static QSpotifyMetrics::Histogram *latency = QSpotifyMetrics::instance().histogram(QLatin1String("search.latencyMs"));
+                    latency->observe(m_requestTimer);
+                }
+                QSPOTIFY_TRACE_SPAN("search", "populateResults");
                 if (sp_search_error(search) == SP_ERROR_OK && is_current) {
                     if(ev->getPtr()) {
                         switch(ev->getPtr()->mType) {
@@ -365,14 +384,9 @@ void QSpotifySearch::populateTracks(sp_search *search)
         int c = sp_search_num_tracks(search);
         for (int i = 0; i < c; ++i) {
             if (auto strack = sp_search_track(search, i)) {
-                auto track = QSpotifyCacheManager::instance().getTrack(strack);
-                if(m_enablePreview && i < m_numPreviewItems) {
-                    track->addRef();
-                    m_trackResultsPreview->appendRow(track);
-                }
-                m_trackResults->appendRow(track);
-                connect(QSpotifySession::instance()->user()->starredList(), SIGNAL(tracksAdded(QVector<sp_track*>)), track, SLOT(onStarredListTracksAdded(QVector<sp_track*>)));
-                connect(QSpotifySession::instance()->user()->starredList(), SIGNAL(tracksRemoved(QVector<sp_track*>)), track, SLOT(onStarredListTracksRemoved(QVector<sp_track*>)));
+                if(m_enablePreview && i < m_numPreviewItems)
+                    m_trackResultsPreview->appendTrack(strack);
+                m_trackResults->appendTrack(strack);
             }
         }
     }
@@ -386,6 +400,7 @@ void QSpotifySearch::setDidYouMean(sp_search *search)
 
 void QSpotifySearch::populateResults(sp_search *search)
 {
+    QSpotifyMemoryTag memoryTag("search");
     if (search) {
         if (sp_search_error(search) != SP_ERROR_OK)
             return;
@@ -42,6 +42,7 @@
 #ifndef QSPOTIFYSEARCH_H
 #define QSPOTIFYSEARCH_H
 
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QObject>
 
 #include <libspotify/api.h>
@@ -124,6 +125,7 @@ private:
     QSpotifyPlaylistSearchList *m_playlistResults;
     QString m_didYouMean;
     bool m_busy;
+    QElapsedTimer m_requestTimer;
 
     // Preview
     QSpotifyTrackList *m_trackResultsPreview;
@@ -44,6 +44,8 @@
 #include <QtCore/QBuffer>
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDebug>
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QEvent>
 #include <QtCore/QIODevice>
 #include <QtCore/QMutexLocker>
@@ -65,8 +67,16 @@
 #include "qspotifyplayqueue.h"
 #include "qspotifytracklist.h"
 #include "qspotifyevents.h"
+#include "qspotifyeventwatchdog.h"
+#include "qspotifylogsink.h"
+#include "qspotifymetadatastore.h"
+#include "qspotifymemory.h"
+#include "qspotifymetrics.h"
+#include "qspotifystartuptimeline.h"
+#include "qspotifytrace.h"
 #include "qspotifyuser.h"
 #include "spotify_key.h"
+#include "qspotifyid.h"
 #include "qspotifyplaylist.h"
 #include "qspotifycachemanager.h"
 #include "qspotifytrack.h"
@@ -75,6 +85,7 @@
 
 #include "mpris/mprismediaplayer.h"
 #include "mpris/mprismediaplayerplayer.h"
+#include "qspotifymetricsadaptor.h"
 
 static QSpotifyAudioThreadWorker *g_audioWorker;
 static int lastFrameSize = 0;
@@ -83,40 +94,41 @@ QSpotifySession *QSpotifySession::m_instance = nullptr;
 
 static void SP_CALLCONV callback_logged_in(sp_session *, sp_error error)
 {
-    qDebug() << "Logged in";
-    QCoreApplication::postEvent(QSpotifySession::instance(), new QSpotifyConnectionErrorEvent(error));
+    qCDebug(lcEvents) << "Logged in";
+    QSPOTIFY_TRACE_INSTANT("session", "callback_logged_in");
+    QSpotifyEventWatchdog::postEvent(QSpotifySession::instance(), new QSpotifyConnectionErrorEvent(error));
     if (error == SP_ERROR_OK)
-        QCoreApplication::postEvent(QSpotifySession::instance(), new QEvent(QEvent::Type(LoggedInEventType)));
+        QSpotifyEventWatchdog::postEvent(QSpotifySession::instance(), new QEvent(QEvent::Type(LoggedInEventType)));
 }
 
 static void SP_CALLCONV callback_logged_out(sp_session *)
 {
-    qDebug() << "Logged out";
-    QCoreApplication::postEvent(QSpotifySession::instance(), new QEvent(QEvent::Type(LoggedOutEventType)));
+    qCDebug(lcEvents) << "Logged out";
+    QSpotifyEventWatchdog::postEvent(QSpotifySession::instance(), new QEvent(QEvent::Type(LoggedOutEventType)));
 }
 
 static void SP_CALLCONV callback_connection_error(sp_session *, sp_error error)
 {
-    qDebug() << "Connection error ";
-    QCoreApplication::postEvent(QSpotifySession::instance(), new QSpotifyConnectionErrorEvent(error));
+    qCDebug(lcEvents) << "Connection error ";
+    QSpotifyEventWatchdog::postEvent(QSpotifySession::instance(), new QSpotifyConnectionErrorEvent(error));
 }
 
 static void SP_CALLCONV callback_notify_main_thread(sp_session *)
 {
-    qDebug() << "Notify main thread";
-    QCoreApplication::postEvent(QSpotifySession::instance(), new QEvent(QEvent::Type(NotifyMainThreadEventType)));
+    qCDebug(lcEvents) << "Notify main thread";
+    QSpotifyEventWatchdog::postEvent(QSpotifySession::instance(), new QEvent(QEvent::Type(NotifyMainThreadEventType)));
 }
 
 static void SP_CALLCONV callback_metadata_updated(sp_session *)
 {
-    qDebug() << "Metadata updated";
-    QCoreApplication::postEvent(QSpotifySession::instance(), new QEvent(QEvent::Type(MetaDataEventType)));
+    qCDebug(lcEvents) << "Metadata updated";
+    QSpotifyEventWatchdog::postEvent(QSpotifySession::instance(), new QEvent(QEvent::Type(MetaDataEventType)));
 }
 
 static void SP_CALLCONV callback_userinfo_updated(sp_session* )
 {
-    qDebug() << "User info updated";
-    QCoreApplication::postEvent(QSpotifySession::instance(), new QEvent(QEvent::Type(MetaDataEventType)));
+    qCDebug(lcEvents) << "User info updated";
+    QSpotifyEventWatchdog::postEvent(QSpotifySession::instance(), new QEvent(QEvent::Type(MetaDataEventType)));
 }
 
 static int SP_CALLCONV callback_music_delivery(sp_session *, const sp_audioformat *format, const void *frames, int num_frames)
@@ -130,6 +142,7 @@ static int SP_CALLCONV callback_music_delivery(sp_session *, const sp_audioforma
         return 0;
 
     if (!g_buffer.isOpen()) {
+        QSPOTIFY_TRACE_END("playback", "playbackStart", QSpotifySession::instance());
         g_buffer.open();
         QCoreApplication::postEvent(g_audioWorker,
                                     new QSpotifyStreamingStartedEvent(format->channels, format->sample_rate));
@@ -145,6 +158,7 @@ static int SP_CALLCONV callback_music_delivery(sp_session *, const sp_audioforma
     }
 
     g_buffer.write((const char *) frames, writtenFrames * sizeof(int16_t) * format->channels);
+    g_audioBufferFill->set(g_buffer.filledBytes());
 
     g_mutex.unlock();
     return writtenFrames;
@@ -169,43 +183,42 @@ static void SP_CALLCONV callback_stop_playback(sp_session *)
 
 static void SP_CALLCONV callback_end_of_track(sp_session *)
 {
-    qDebug() << "End of track";
-    QCoreApplication::postEvent(QSpotifySession::instance(), new QEvent(QEvent::Type(EndOfTrackEventType)));
+    qCDebug(lcEvents) << "End of track";
+    QSpotifyEventWatchdog::postEvent(QSpotifySession::instance(), new QEvent(QEvent::Type(EndOfTrackEventType)));
 }
 
 static void SP_CALLCONV callback_play_token_lost(sp_session *)
 {
-    qDebug() << "Play token lost";
-    QCoreApplication::postEvent(QSpotifySession::instance(), new QEvent(QEvent::Type(PlayTokenLostEventType)));
+    qCDebug(lcEvents) << "Play token lost";
+    QSpotifyEventWatchdog::postEvent(QSpotifySession::instance(), new QEvent(QEvent::Type(PlayTokenLostEventType)));
 }
 
 static void SP_CALLCONV callback_log_message(sp_session *, const char *data)
 {
     // Scrobble error doesn't actually work for authentication failures (only reports first failure)
     // So we have to parse the log for errors instead
-    QString qsdata = QString(data);
-    if(qsdata.contains("Scrobbling failure: 5001")) {
-        QCoreApplication::postEvent(QSpotifySession::instance(), new QEvent(QEvent::Type(ScrobbleLoginErrorEventType)));
+    if (strstr(data, "Scrobbling failure: 5001")) {
+        QSpotifyEventWatchdog::postEvent(QSpotifySession::instance(), new QEvent(QEvent::Type(ScrobbleLoginErrorEventType)));
     }
-    fprintf(stderr, "%s\n", data);
+    QSpotifyLogSink::post(data);
 }
 
 static void SP_CALLCONV callback_offline_error(sp_session *, sp_error error)
 {
-    qDebug() << "Offline error " << int(error);
+    qCDebug(lcEvents) << "Offline error " << int(error);
     if (error != SP_ERROR_OK)
-        QCoreApplication::postEvent(QSpotifySession::instance(), new QSpotifyOfflineErrorEvent(error));
+        QSpotifyEventWatchdog::postEvent(QSpotifySession::instance(), new QSpotifyOfflineErrorEvent(error));
 }
 
 static void SP_CALLCONV callback_scrobble_error(sp_session *, sp_error error)
 {
-    qDebug() << "Scrobble error " << int(error);
+    qCDebug(lcEvents) << "Scrobble error " << int(error);
 }
 
 static void SP_CALLCONV callback_connectionstate_updated(sp_session *)
 {
-    qDebug() << "Connection state updated";
-    QCoreApplication::postEvent(QSpotifySession::instance(), new QEvent(ConnectionStateUpdateEventType));
+    qCDebug(lcEvents) << "Connection state updated";
+    QSpotifyEventWatchdog::postEvent(QSpotifySession::instance(), new QEvent(ConnectionStateUpdateEventType));
 }
 
 QSpotifySession::QSpotifySession()
@@ -263,7 +276,10 @@ QSpotifySession::QSpotifySession()
 
 void QSpotifySession::init()
 {
+    QSpotifyStartupTimeline::instance().mark("session.init");
     QSettings settings;
+    QSpotifyLogSink::instance().start(QThread::LowPriority);
+
     memset(&m_sp_callbacks, 0, sizeof(m_sp_callbacks));
     m_sp_callbacks.logged_in = callback_logged_in;
     m_sp_callbacks.logged_out = callback_logged_out;
@@ -285,6 +301,12 @@ void QSpotifySession::init()
     dataPath = (char *) calloc(strlen(dpString.toLatin1()) + 1, sizeof(char));
     strcpy(dataPath, dpString.toLatin1());
 
+    QSpotifyStartupTimeline::instance().mark("settings.read");
+
+    if (!dpString.isEmpty() && QDir().mkpath(dpString))
+        QSpotifyMetadataStore::instance().open(dpString + QLatin1String("/metadata.qsm"));
+    QSpotifyStartupTimeline::instance().mark("metadataStore.open");
+
     memset(&m_sp_config, 0, sizeof(m_sp_config));
     m_sp_config.api_version = SPOTIFY_API_VERSION;
     m_sp_config.cache_location = dataPath;
@@ -304,6 +326,7 @@ void QSpotifySession::init()
         return;
     }
     Q_ASSERT(m_sp_session);
+    QSpotifyStartupTimeline::instance().mark("sp_session_create");
 
     sp_session_set_cache_size(m_sp_session, 0);
 
@@ -332,6 +355,7 @@ void QSpotifySession::init()
 
     QString storedLogin = getStoredLoginInformation();
     if (!storedLogin.isEmpty()) {
+        QSpotifyStartupTimeline::instance().mark("relogin");
         login(storedLogin);
     }
 
@@ -356,16 +380,20 @@ void QSpotifySession::init()
 
     new MPRISMediaPlayer(this);
     new MPRISMediaPlayerPlayer(this);
+    new QSpotifyMetricsAdaptor(this);
 
     QDBusConnection::sessionBus().registerObject(QString("/org/mpris/MediaPlayer2"), this, QDBusConnection::ExportAdaptors);
     QDBusConnection::sessionBus().registerService("org.mpris.MediaPlayer2.CuteSpot");
+    QSpotifyStartupTimeline::instance().mark("session.ready");
 }
 
 QSpotifySession::~QSpotifySession()
 {
-    qDebug() << "QSpotifySession::cleanUp";
+    qCDebug(lcSession) << "QSpotifySession::cleanUp";
     if (m_sp_session)
         sp_session_release(m_sp_session);
+    QSpotifyLogSink::instance().stop();
+    QSpotifyMetadataStore::instance().close();
     free(dataPath);
 }
 
@@ -433,13 +461,15 @@ void QSpotifySession::setScrobble(bool scrobble)
 
 bool QSpotifySession::event(QEvent *e)
 {
+    QSpotifyEventWatchdog::Scope watchdog(this, e);
+    QSpotifyMetrics::countEvent(this, e);
     if (e->type() == NotifyMainThreadEventType) {
-        qDebug() << "Process spotify event";
+        qCDebug(lcEvents) << "Process spotify event";
         processSpotifyEvents();
         e->accept();
         return true;
     } else if (e->type() == QEvent::Timer) {
-        qDebug() << "Timer, start spotify events";
+        qCDebug(lcEvents) << "Timer, start spotify events";
         QTimerEvent *te = static_cast<QTimerEvent *>(e);
         if (te->timerId() == m_timerID) {
             processSpotifyEvents();
@@ -447,29 +477,29 @@ bool QSpotifySession::event(QEvent *e)
             return true;
         }
     } else if (e->type() == ConnectionErrorEventType) {
-        qDebug() << "Connection error";
+        qCDebug(lcEvents) << "Connection error";
         QSpotifyConnectionErrorEvent *ev = static_cast<QSpotifyConnectionErrorEvent *>(e);
         setConnectionError(ConnectionError(ev->error()), QString::fromUtf8(sp_error_message(ev->error())));
         e->accept();
         return true;
     } else if (e->type() == MetaDataEventType) {
-        qDebug() << "Meta data";
+        qCDebug(lcEvents) << "Meta data";
         emit metadataUpdated();
         e->accept();
         return true;
     } else if (e->type() == EndOfTrackEventType) {
-        qDebug() << "End track";
+        qCDebug(lcEvents) << "End track";
         m_trackChangedAutomatically = true;
         playNext();
         e->accept();
         return true;
     } else if (e->type() == StopEventType) {
-        qDebug() << "Stop";
+        qCDebug(lcEvents) << "Stop";
         stop();
         e->accept();
         return true;
     } else if (e->type() == TrackProgressEventType) {
-        qDebug() << "Track progress";
+        qCDebug(lcEvents) << "Track progress";
         if(!m_isPlaying) {
             e->accept();
             return true;
@@ -490,49 +520,53 @@ bool QSpotifySession::event(QEvent *e)
         e->accept();
         return true;
     } else if (e->type() == SendImageRequestEventType) {
-        qDebug() << "Send image request";
+        qCDebug(lcEvents) << "Send image request";
         QSpotifyRequestImageEvent *ev = static_cast<QSpotifyRequestImageEvent *>(e);
         sendImageRequest(ev->imageId());
         e->accept();
         return true;
     } else if (e->type() == ReceiveImageRequestEventType) {
-        qDebug() << "Receive image request";
+        qCDebug(lcEvents) << "Receive image request";
         QSpotifyReceiveImageEvent *ev = static_cast<QSpotifyReceiveImageEvent *>(e);
         receiveImageResponse(ev->image());
         e->accept();
         return true;
     } else if (e->type() == PlayTokenLostEventType) {
-        qDebug() << "Play token lost";
+        qCDebug(lcEvents) << "Play token lost";
         emit playTokenLost();
         pause();
         e->accept();
         return true;
     } else if (e->type() == LoggedInEventType) {
-        qDebug() << "Logged in 1";
+        qCDebug(lcEvents) << "Logged in 1";
         onLoggedIn();
         e->accept();
         return true;
     } else if (e->type() == LoggedOutEventType) {
-        qDebug() << "Logged out";
+        qCDebug(lcEvents) << "Logged out";
         onLoggedOut();
         e->accept();
         return true;
     } else if (e->type() == OfflineErrorEventType) {
-        qDebug() << "Offline error";
+        qCDebug(lcEvents) << "Offline error";
         QSpotifyOfflineErrorEvent *ev = static_cast<QSpotifyOfflineErrorEvent *>(e);
         m_offlineErrorMessage = QString::fromUtf8(sp_error_message(ev->error()));
         emit offlineErrorMessageChanged();
         e->accept();
         return true;
     } else if (e->type() == ScrobbleLoginErrorEventType) {
-        qDebug() << "Scrobble login error";
+        qCDebug(lcEvents) << "Scrobble login error";
         m_lfmLoggedIn = false;
         emit lfmLoggedInChanged();
         emit lfmLoginError();
         e->accept();
         return true;
+    } else if (e->type() == DestroyObjectsEventType) {
+        QSpotifyCacheManager::instance().destroyPending();
+        e->accept();
+        return true;
     } else if (e->type() == ConnectionStateUpdateEventType) {
-        qDebug() << "Connectionstate update event";
+        qCDebug(lcEvents) << "Connectionstate update event";
         setConnectionStatus(ConnectionStatus(sp_session_connectionstate(m_sp_session)));
         if (m_offlineMode && m_connectionStatus == LoggedIn) {
             setConnectionRules(m_connectionRules | AllowNetwork);
@@ -546,7 +580,12 @@ bool QSpotifySession::event(QEvent *e)
 
 void QSpotifySession::initiateQuit()
 {
-    qDebug() << "QSpotifySession::initiateQuit";
+    qCDebug(lcSession) << "QSpotifySession::initiateQuit";
+    if (QSpotifyEventWatchdog::isEnabled())
+        qDebug("%s", qPrintable(QSpotifyEventWatchdog::instance().report()));
+    QSpotifyStartupTimeline::instance().finish();
+    if (QSpotifyTrace::isEnabled() && !QSpotifyTrace::defaultTraceFile().isEmpty())
+        QSpotifyTrace::dumpChromeTrace(QSpotifyTrace::defaultTraceFile());
     stop();
     m_audioThread->quit();
     m_audioThread->wait();
@@ -564,19 +603,17 @@ void QSpotifySession::initiateQuit()
 
 void QSpotifySession::processSpotifyEvents()
 {
-    qDebug() << "QSpotifySession::processSpotifyEvents";
+    QSPOTIFY_TRACE_SPAN("session", "processSpotifyEvents");
+    qCDebug(lcEvents) << "QSpotifySession::processSpotifyEvents";
     if (m_timerID)
         killTimer(m_timerID);
 
     int nextTimeout = 0;
 
-    if (!m_aboutToQuit)
-        QSpotifyCacheManager::instance().cacheInfo();
-
     do {
         assert(isValid());
 
-        qDebug() << "Processing events...";
+        qCDebug(lcEvents) << "Processing events...";
         sp_session_process_events(m_sp_session, &nextTimeout);
     } while (nextTimeout == 0);
     m_timerID = startTimer(nextTimeout);
@@ -584,7 +621,7 @@ void QSpotifySession::processSpotifyEvents()
 
 void QSpotifySession::setStreamingQuality(StreamingQuality q)
 {
-    qDebug() << "QSpotifySession::setStreamingQuality";
+    qCDebug(lcSession) << "QSpotifySession::setStreamingQuality";
     if (m_streamingQuality == q)
         return;
 
@@ -598,7 +635,7 @@ void QSpotifySession::setStreamingQuality(StreamingQuality q)
 
 void QSpotifySession::setSyncQuality(StreamingQuality q)
 {
-    qDebug() << "QSpotifySession::setSyncQuality" << q;
+    qCDebug(lcSession) << "QSpotifySession::setSyncQuality" << q;
     if (m_syncQuality == q)
         return;
 
@@ -612,12 +649,16 @@ void QSpotifySession::setSyncQuality(StreamingQuality q)
 
 void QSpotifySession::onLoggedIn()
 {
-    qDebug() << "Logged in";
+    qCDebug(lcSession) << "Logged in";
     QSettings settings;
 
     if (m_user)
         return;
 
+    QSPOTIFY_TRACE_END("session", "login", this);
+    QSPOTIFY_TRACE_SPAN("session", "onLoggedIn");
+    QSpotifyStartupTimeline::instance().mark("loggedIn");
+
     m_isLoggedIn = true;
     m_user = new QSpotifyUser(sp_session_user(m_sp_session));
     m_user->init();
@@ -630,12 +671,13 @@ void QSpotifySession::onLoggedIn()
     emit isLoggedInChanged();
 
     checkNetworkAccess();
-    qDebug() << "Done";
+    QSpotifyStartupTimeline::instance().mark("onLoggedIn.done");
+    qCDebug(lcSession) << "Done";
 }
 
 void QSpotifySession::onLoggedOut()
 {
-    qDebug() << "QSpotifySession::onLoggedOut";
+    qCDebug(lcSession) << "QSpotifySession::onLoggedOut";
     if (!m_explicitLogout)
         return;
 
@@ -655,7 +697,7 @@ void QSpotifySession::onLoggedOut()
 
 void QSpotifySession::setConnectionStatus(ConnectionStatus status)
 {
-    qDebug() << "QSpotifySession::setConnectionStatus" << status;
+    qCDebug(lcSession) << "QSpotifySession::setConnectionStatus" << status;
     if (m_connectionStatus == status)
         return;
 
@@ -669,11 +711,12 @@ void QSpotifySession::setConnectionStatus(ConnectionStatus status)
 
 void QSpotifySession::setConnectionError(ConnectionError error, const QString &message)
 {
-    qDebug() << "QSpotifySession::setConnectionError" << error << message;
+    qCDebug(lcSession) << "QSpotifySession::setConnectionError" << error << message;
     if (error == Ok || m_offlineMode)
         return;
 
     if (m_pending_connectionRequest) {
+        QSPOTIFY_TRACE_END("session", "login", this);
         m_pending_connectionRequest = false;
         emit pendingConnectionRequestChanged();
     }
@@ -696,7 +739,7 @@ void QSpotifySession::setConnectionError(ConnectionError error, const QString &m
 
 void QSpotifySession::login(const QString &username, const QString &password)
 {
-    qDebug() << "QSpotifySession::login";
+    qCDebug(lcSession) << "QSpotifySession::login";
     if (!isValid() || m_isLoggedIn || m_pending_connectionRequest)
         return;
 
@@ -704,23 +747,27 @@ void QSpotifySession::login(const QString &username, const QString &password)
     emit pendingConnectionRequestChanged();
     emit loggingIn();
 
+    QSPOTIFY_TRACE_BEGIN("session", "login", this);
+
     if (password.isEmpty()) {
-        qDebug() << "Relogin";
+        qCDebug(lcSession) << "Relogin";
         sp_session_relogin(m_sp_session);
     } else {
-        qDebug() << "Fresh login";
+        qCDebug(lcSession) << "Fresh login";
         sp_session_login(m_sp_session, username.toUtf8().constData(), password.toUtf8().constData(), true, NULL);
     }
 }
 
 void QSpotifySession::logout(bool keepLoginInfo)
 {
-    qDebug() << "QSpotifySession::logout";
+    qCDebug(lcSession) << "QSpotifySession::logout";
     if (!m_isLoggedIn || m_pending_connectionRequest)
         return;
 
     stop();
     m_playQueue->clearQueue();
+    QSpotifyCacheManager::instance().clearRetained();
+    QSpotifyMetadataStore::instance().flush();
 
     if (!keepLoginInfo) {
         setOfflineMode(false);
@@ -742,7 +789,7 @@ void QSpotifySession::logout(bool keepLoginInfo)
 
 void QSpotifySession::setShuffle(bool s)
 {
-    qDebug() << "QSpotifySession::setShuffle";
+    qCDebug(lcSession) << "QSpotifySession::setShuffle";
     if (m_shuffle == s)
         return;
 
@@ -755,7 +802,7 @@ void QSpotifySession::setShuffle(bool s)
 
 void QSpotifySession::setRepeat(bool r)
 {
-    qDebug() << "QSpotifySession::setRepeat";
+    qCDebug(lcSession) << "QSpotifySession::setRepeat";
     if (m_repeat == r)
         return;
 
@@ -768,7 +815,7 @@ void QSpotifySession::setRepeat(bool r)
 
 void QSpotifySession::setRepeatOne(bool r)
 {
-    qDebug() << "QSpotifySession::setRepeatOne";
+    qCDebug(lcSession) << "QSpotifySession::setRepeatOne";
     if (m_repeatOne == r)
         return;
 
@@ -780,7 +827,7 @@ void QSpotifySession::setRepeatOne(bool r)
 
 void QSpotifySession::setVolumeNormalize(bool normalize)
 {
-    qDebug() << "QSpotifySession::setVolumeNormalize" << normalize;
+    qCDebug(lcSession) << "QSpotifySession::setVolumeNormalize" << normalize;
     if(m_volumeNormalize == normalize)
         return;
 
@@ -789,14 +836,14 @@ void QSpotifySession::setVolumeNormalize(bool normalize)
     m_volumeNormalize = normalize;
 
     if(sp_session_set_volume_normalization(m_sp_session, normalize) != SP_ERROR_OK)
-        qDebug() << "Failed to set volume normalization";
+        qCDebug(lcSession) << "Failed to set volume normalization";
 
     emit volumeNormalizeChanged();
 }
 
 void QSpotifySession::play(QSpotifyTrack *track, bool restart)
 {
-    qDebug() << "QSpotifySession::play";
+    qCDebug(lcPlayback) << "QSpotifySession::play";
     if (track->error() != QSpotifyTrack::Ok || !track->isAvailable() || (m_currentTrack == track && !restart))
         return;
 
@@ -809,8 +856,7 @@ void QSpotifySession::play(QSpotifyTrack *track, bool restart)
         }
         sp_session_player_unload(m_sp_session);
         m_isPlaying = false;
-        m_currentTrack->release();
-        m_currentTrack = nullptr;
+        setCurrentTrack(nullptr);
         m_currentTrackPosition = 0;
         m_currentTrackPlayedDuration = 0;
         // Only discard buffers if the track change was initialized manually
@@ -824,6 +870,8 @@ void QSpotifySession::play(QSpotifyTrack *track, bool restart)
 
     m_trackChangedAutomatically = false;
 
+    QSPOTIFY_TRACE_BEGIN("playback", "playbackStart", this);
+
     if (!track->seen())
         track->setSeen(true);
 
@@ -831,10 +879,10 @@ void QSpotifySession::play(QSpotifyTrack *track, bool restart)
     if (error != SP_ERROR_OK) {
         fprintf(stderr, "failed to load track: %s\n",
                 sp_error_message(error));
+        QSPOTIFY_TRACE_END("playback", "playbackStart", this);
         return;
     }
-    m_currentTrack = track;
-    m_currentTrack->addRef();
+    setCurrentTrack(track);
     m_currentTrackPosition = 0;
     m_currentTrackPlayedDuration = 0;
     emit currentTrackChanged();
@@ -843,9 +891,22 @@ void QSpotifySession::play(QSpotifyTrack *track, bool restart)
     beginPlayBack();
 }
 
+void QSpotifySession::setCurrentTrack(QSpotifyTrack *track)
+{
+    if (m_currentTrack) {
+        m_currentTrack->setIsCurrentPlayingTrack(false);
+        m_currentTrack->release();
+    }
+    m_currentTrack = track;
+    if (m_currentTrack) {
+        m_currentTrack->addRef();
+        m_currentTrack->setIsCurrentPlayingTrack(true);
+    }
+}
+
 void QSpotifySession::beginPlayBack(bool notifyThread)
 {
-    qDebug() << "QSpotifySession::beginPlayBack";
+    qCDebug(lcPlayback) << "QSpotifySession::beginPlayBack";
     sp_session_player_play(m_sp_session, true);
     m_isPlaying = true;
     emit isPlayingChanged();
@@ -856,7 +917,7 @@ void QSpotifySession::beginPlayBack(bool notifyThread)
 
 void QSpotifySession::pause(bool notifyThread)
 {
-    qDebug() << "QSpotifySession::pause";
+    qCDebug(lcPlayback) << "QSpotifySession::pause";
     if (!m_isPlaying)
         return;
 
@@ -870,7 +931,7 @@ void QSpotifySession::pause(bool notifyThread)
 
 void QSpotifySession::resume()
 {
-    qDebug () << "QSpotifySession::resume";
+    qCDebug(lcPlayback) << "QSpotifySession::resume";
     if (m_isPlaying || !m_currentTrack)
         return;
 
@@ -879,17 +940,18 @@ void QSpotifySession::resume()
 
 void QSpotifySession::stop(bool dontEmitSignals)
 {
-    qDebug() << "QSpotifySession::stop";
+    qCDebug(lcPlayback) << "QSpotifySession::stop";
     if (!m_isPlaying && !m_currentTrack)
         return;
 
     sp_session_player_unload(m_sp_session);
     m_isPlaying = false;
-    m_currentTrack->release();
-    m_currentTrack = nullptr;
+    setCurrentTrack(nullptr);
     m_currentTrackPosition = 0;
     m_currentTrackPlayedDuration = 0;
 
+    QSPOTIFY_TRACE_END("playback", "playbackStart", this);
+
     if (!dontEmitSignals) {
         emit isPlayingChanged();
         emit currentTrackChanged();
@@ -901,7 +963,7 @@ void QSpotifySession::stop(bool dontEmitSignals)
 
 void QSpotifySession::seek(int offset)
 {
-    qDebug () << "QSpotifySession::seek";
+    qCDebug(lcPlayback) << "QSpotifySession::seek";
     if (!m_currentTrack)
         return;
 
@@ -916,36 +978,36 @@ void QSpotifySession::seek(int offset)
 
 void QSpotifySession::playNext()
 {
-    qDebug() << "QSpotifySession::playNext";
+    qCDebug(lcPlayback) << "QSpotifySession::playNext";
     m_playQueue->playNext(m_repeatOne);
 }
 
 void QSpotifySession::playPrevious()
 {
-    qDebug() << "QSpotifySession::playPrevious";
+    qCDebug(lcPlayback) << "QSpotifySession::playPrevious";
     m_playQueue->playPrevious();
 }
 
 void QSpotifySession::enqueue(QSpotifyTrack *track)
 {
-    qDebug() << "QSpotifySession::enqieue";
+    qCDebug(lcPlayback) << "QSpotifySession::enqieue";
     m_playQueue->enqueueTrack(track);
 }
 
 void QSpotifySession::audioStateChange(QAudio::State state)
 {
-    qDebug() << "audio state change";
+    qCDebug(lcPlayback) << "audio state change";
     switch(state) {
     case QAudio::ActiveState:
-        qDebug() << "Audio is now in active state";
+        qCDebug(lcPlayback) << "Audio is now in active state";
         beginPlayBack(false);
         break;
     case QAudio::SuspendedState:
-        qDebug() << "Audio is now in supended state";
+        qCDebug(lcPlayback) << "Audio is now in supended state";
         pause(false);
         break;
     default:
-        qDebug() << "unhandled audioStateChange" << state;
+        qCDebug(lcPlayback) << "unhandled audioStateChange" << state;
         break;
     }
 }
@@ -970,7 +1032,7 @@ QString QSpotifySession::formatDuration(qint64 d) const
 
 QString QSpotifySession::getStoredLoginInformation() const
 {
-    qDebug() << "QSpotifySession::getStoredLoginInformation";
+    qCDebug(lcSession) << "QSpotifySession::getStoredLoginInformation";
     QString username;
     char buffer[200];
     int size = sp_session_remembered_user(m_sp_session, &buffer[0], 200);
@@ -980,35 +1042,47 @@ QString QSpotifySession::getStoredLoginInformation() const
     return username;
 }
 
+// Decoded images between the libspotify callback and the requesting thread
+static QSpotifyMemory::Account *pendingImages()
+{
+    static QSpotifyMemory::Account *account = QSpotifyMemory::instance().account(QLatin1String("images.pending"));
+    return account;
+}
+
 QImage QSpotifySession::requestSpotifyImage(const QString &id)
 {
-    qDebug() << "QSpotifySession::requestSpotifyImage";
+    qCDebug(lcSession) << "QSpotifySession::requestSpotifyImage";
+    static QSpotifyMetrics::Histogram *latency = QSpotifyMetrics::instance().histogram(QLatin1String("image.latencyMs"));
+    QElapsedTimer timer;
+    timer.start();
     g_imageRequestMutex.lock();
     g_imageRequestConditions.insert(id, new QWaitCondition);
-    QCoreApplication::postEvent(this, new QSpotifyRequestImageEvent(id));
+    QSpotifyEventWatchdog::postEvent(this, new QSpotifyRequestImageEvent(id));
     g_imageRequestConditions[id]->wait(&g_imageRequestMutex);
     delete g_imageRequestConditions.take(id);
 
     QImage im = g_imageRequestImages.take(id);
+    pendingImages()->update(-1, -im.byteCount());
 
     g_imageRequestMutex.unlock();
 
+    latency->observe(timer);
     return im;
 }
 
 static void SP_CALLCONV callback_image_loaded(sp_image *image, void *)
 {
-    qDebug() << "callback_image_loaded";
-    QCoreApplication::postEvent(QSpotifySession::instance(), new QSpotifyReceiveImageEvent(image));
+    qCDebug(lcEvents) << "callback_image_loaded";
+    QSpotifyEventWatchdog::postEvent(QSpotifySession::instance(), new QSpotifyReceiveImageEvent(image));
 }
 
 void QSpotifySession::sendImageRequest(const QString &id)
 {
-    qDebug() << "QSpotifySession::sendImageRequest" << id;
+    qCDebug(lcSession) << "QSpotifySession::sendImageRequest" << id;
     sp_image *image = nullptr;
-    byte *idPtr = QSpotifyPlaylist::getImageIdPtr(id);
-    if(idPtr)
-        image = sp_image_create(m_sp_session, idPtr);
+    QSpotifyId imageId = QSpotifyId::fromUri(id.toLatin1());
+    if (imageId.type() == QSpotifyId::Image)
+        image = sp_image_create(m_sp_session, imageId.data());
     else {
         sp_link *link = sp_link_create_from_string(id.toUtf8().constData());
         if(link) {
@@ -1026,7 +1100,7 @@ void QSpotifySession::sendImageRequest(const QString &id)
 void QSpotifySession::receiveImageResponse(sp_image *image)
 {
     Q_ASSERT(image);
-    qDebug() << "QSpotifySession::receiveImageResponse";
+    qCDebug(lcSession) << "QSpotifySession::receiveImageResponse";
     sp_image_remove_load_callback(image, callback_image_loaded, 0);
 
     QString id = g_imageRequestObject.take(image);
@@ -1041,31 +1115,57 @@ void QSpotifySession::receiveImageResponse(sp_image *image)
 
     g_imageRequestMutex.lock();
     g_imageRequestImages.insert(id, im);
+    pendingImages()->update(1, im.byteCount());
     g_imageRequestConditions[id]->wakeAll();
     g_imageRequestMutex.unlock();
 }
 
+QString QSpotifySession::startupReport() const
+{
+    return QSpotifyStartupTimeline::instance().report();
+}
+
+QVariantMap QSpotifySession::cacheStatistics() const
+{
+    return QSpotifyCacheManager::instance().statistics();
+}
+
+QVariantMap QSpotifySession::metrics() const
+{
+    return QSpotifyMetrics::instance().snapshot();
+}
+
+QVariantMap QSpotifySession::memoryStatistics() const
+{
+    return QSpotifyMemory::instance().snapshot();
+}
+
+QVariantList QSpotifySession::longLivedObjects(int minAgeMs) const
+{
+    return QSpotifyMemory::instance().longLived(minAgeMs);
+}
+
 bool QSpotifySession::isOnline() const
 {
-    qDebug() << "QSpotifySession::isOnline";
+    qCDebug(lcSession) << "QSpotifySession::isOnline";
     return m_networkConfManager->isOnline();
 }
 
 void QSpotifySession::onOnlineChanged()
 {
-    qDebug() << "QSpotifySession::onOnlineChanged";
+    qCDebug(lcSession) << "QSpotifySession::onOnlineChanged";
     checkNetworkAccess();
 }
 
 void QSpotifySession::configurationChanged()
 {
-    qDebug() << "QSpotifySession::configurationChanged";
+    qCDebug(lcSession) << "QSpotifySession::configurationChanged";
     checkNetworkAccess();
 }
 
 void QSpotifySession::checkNetworkAccess()
 {
-    qDebug() << "QSpotifySession::checkNetworkAccess";
+    qCDebug(lcSession) << "QSpotifySession::checkNetworkAccess";
     if (!m_networkConfManager->isOnline()) {
         sp_session_set_connection_type(m_sp_session, SP_CONNECTION_TYPE_NONE);
         setOfflineMode(true, true);
@@ -1076,7 +1176,7 @@ void QSpotifySession::checkNetworkAccess()
         QList<QNetworkConfiguration> confs = m_networkConfManager->allConfigurations(QNetworkConfiguration::Active);
         for (int i = 0; i < confs.count(); ++i) {
             QNetworkConfiguration::BearerType bearer = confs.at(i).bearerType();
-            qDebug() << "Network connection type: " << confs.at(i).bearerTypeName();
+            qCDebug(lcSession) << "Network connection type: " << confs.at(i).bearerTypeName();
             if (bearer == QNetworkConfiguration::BearerWLAN || bearer == QNetworkConfiguration::BearerEthernet) {
                 wifi = true;
                 break;
@@ -1110,7 +1210,7 @@ void QSpotifySession::checkNetworkAccess()
 
 void QSpotifySession::setConnectionRules(ConnectionRules r)
 {
-    qDebug() << "QSpotifySession::setConnectionRules";
+    qCDebug(lcSession) << "QSpotifySession::setConnectionRules";
     if (m_connectionRules == r)
         return;
 
@@ -1120,7 +1220,7 @@ void QSpotifySession::setConnectionRules(ConnectionRules r)
 
 void QSpotifySession::setOfflineMode(bool on, bool forced)
 {
-    qDebug() << "QSpotifySession::setOfflineMode" << on << forced;
+    qCDebug(lcSession) << "QSpotifySession::setOfflineMode" << on << forced;
     if (m_offlineMode == on)
         return;
 
@@ -1139,6 +1239,10 @@ void QSpotifySession::setOfflineMode(bool on, bool forced)
     setConnectionRules(on ? m_connectionRules & ~AllowNetwork :
                            m_connectionRules | AllowNetwork);
 
+    // Track lists recompute availability in one go and tell the tracks
+    // they hold; the current track may not be in any list.
+    if (m_currentTrack)
+        m_currentTrack->offlineModeChanged();
     emit offlineModeChanged();
 }
 
@@ -1152,7 +1256,7 @@ bool QSpotifySession::privateSession() const
 
 void QSpotifySession::setPrivateSession(bool on)
 {
-    qDebug() << "QSpotifySession::setPrivateSession " << on;
+    qCDebug(lcSession) << "QSpotifySession::setPrivateSession " << on;
 
     if(!m_isLoggedIn)
         return;
@@ -1175,7 +1279,7 @@ void QSpotifySession::setShowOfflineSwitch(bool on)
 
 void QSpotifySession::handleUri(const QString &uri)
 {
-    qDebug() << "QSpotifySession::handleUri" << uri;
+    qCDebug(lcSession) << "QSpotifySession::handleUri" << uri;
     sp_link *link = sp_link_create_from_string(uri.toLatin1().data());
     const sp_linktype link_type = sp_link_type(link);
     switch (link_type) {
@@ -1197,31 +1301,31 @@ void QSpotifySession::handleUri(const QString &uri)
         break;
     }
     case SP_LINKTYPE_ALBUM: // TODO: add support
-        qDebug() << "Album links not supported!";
+        qCDebug(lcSession) << "Album links not supported!";
         break;
     case SP_LINKTYPE_ARTIST: // TODO: add support
-        qDebug() << "Artist links not supported!";
+        qCDebug(lcSession) << "Artist links not supported!";
         break;
     case SP_LINKTYPE_SEARCH: // TODO: add support
-        qDebug() << "Search links not supported!";
+        qCDebug(lcSession) << "Search links not supported!";
         break;
     case SP_LINKTYPE_PLAYLIST: // TODO: add support
-        qDebug() << "Playlist links not supported!";
+        qCDebug(lcSession) << "Playlist links not supported!";
         break;
     case SP_LINKTYPE_PROFILE: // TODO: add support
-        qDebug() << "Profile links not supported!";
+        qCDebug(lcSession) << "Profile links not supported!";
         break;
     case SP_LINKTYPE_STARRED: // TODO: add support
-        qDebug() << "Starred links not supported!";
+        qCDebug(lcSession) << "Starred links not supported!";
         break;
     case SP_LINKTYPE_LOCALTRACK: // TODO: add support
-        qDebug() << "Local track links not supported!";
+        qCDebug(lcSession) << "Local track links not supported!";
         break;
     case SP_LINKTYPE_IMAGE: // TODO: add support
-        qDebug() << "Image links not supported!";
+        qCDebug(lcSession) << "Image links not supported!";
         break;
     case SP_LINKTYPE_TOPLIST: // TODO: add support
-        qDebug() << "Toplist links not supported!";
+        qCDebug(lcSession) << "Toplist links not supported!";
         break;
     }
     sp_link_release(link);
@@ -1229,7 +1333,7 @@ void QSpotifySession::handleUri(const QString &uri)
 
 void QSpotifySession::setSyncOverMobile(bool s)
 {
-    qDebug() << "QSpotifySession::setSyncOverMobile";
+    qCDebug(lcSession) << "QSpotifySession::setSyncOverMobile";
     if (m_syncOverMobile == s)
         return;
 
@@ -1244,7 +1348,7 @@ void QSpotifySession::setSyncOverMobile(bool s)
 }
 
 void QSpotifySession::clearCache() {
-    qDebug() << "QSpotifySession::clearCache";
+    qCDebug(lcSession) << "QSpotifySession::clearCache";
     QSettings settings;
     QString dataPath = settings.value("dataPath").toString();
     if(dataPath.contains(".local/share") || dataPath.contains("/mnt/sdcard/")) {
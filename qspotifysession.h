@@ -43,6 +43,8 @@
 #define QSPOTIFYSESSION_H
 
 #include <QtCore/QObject>
+#include <QtCore/QVariantList>
+#include <QtCore/QVariantMap>
 #include <QtMultimedia/QAudio>
 #include <libspotify/api.h>
 
@@ -204,6 +206,13 @@ public:
 
     Q_INVOKABLE void handleUri(const QString &uri);
 
+    Q_INVOKABLE QVariantMap metrics() const;
+    Q_INVOKABLE QVariantMap cacheStatistics() const;
+    Q_INVOKABLE QVariantMap memoryStatistics() const;
+    // Only filled in debug builds, see QSpotifyMemory::longLived().
+    Q_INVOKABLE QVariantList longLivedObjects(int minAgeMs) const;
+    Q_INVOKABLE QString startupReport() const;
+
 public Q_SLOTS:
     void login(const QString &username, const QString &password = QString());
     void logout(bool keepLoginInfo);
@@ -263,6 +272,7 @@ private:
     void init();
     void checkNetworkAccess();
     void processSpotifyEvents();
+    void setCurrentTrack(QSpotifyTrack *track);
     void beginPlayBack(bool notifyThread = true);
 
     void onLoggedIn();
@@ -0,0 +1,90 @@
+#include "qspotifystartuptimeline.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QSettings>
+
+#include "qspotifytrace.h"
+
+static QElapsedTimer startClock()
+{
+    QElapsedTimer t;
+    t.start();
+    return t;
+}
+
+static const QElapsedTimer g_processClock = startClock();
+
+QSpotifyStartupTimeline &QSpotifyStartupTimeline::instance()
+{
+    static QSpotifyStartupTimeline inst;
+    return inst;
+}
+
+void QSpotifyStartupTimeline::mark(const char *milestone)
+{
+    if (m_finished)
+        return;
+    for (const auto &m : m_milestones) {
+        if (qstrcmp(m.first, milestone) == 0)
+            return;
+    }
+    m_milestones.append(qMakePair(milestone, g_processClock.elapsed()));
+    QSPOTIFY_TRACE_INSTANT("startup", milestone);
+}
+
+void QSpotifyStartupTimeline::finish()
+{
+    if (m_finished || m_milestones.isEmpty())
+        return;
+    m_finished = true;
+
+    QString timeline = format();
+
+    QSettings settings;
+    QStringList stored = settings.value("startupTimelines").toStringList();
+    stored.prepend(timeline);
+    while (stored.count() > MaxStoredTimelines)
+        stored.removeLast();
+    settings.setValue("startupTimelines", stored);
+
+    qCDebug(lcSession) << "Startup timeline:" << timeline;
+}
+
+QString QSpotifyStartupTimeline::format() const
+{
+    QStringList parts;
+    for (const auto &m : m_milestones)
+        parts << QString(QLatin1String("%1=%2")).arg(QLatin1String(m.first)).arg(m.second);
+    return parts.join(QLatin1Char(' '));
+}
+
+QStringList QSpotifyStartupTimeline::storedTimelines() const
+{
+    QSettings settings;
+    return settings.value("startupTimelines").toStringList();
+}
+
+QString QSpotifyStartupTimeline::report() const
+{
+    QStringList lines;
+    lines << QLatin1String("Startup timeline (ms since process start, +delta):");
+    qint64 previous = 0;
+    for (const auto &m : m_milestones) {
+        lines << QString(QLatin1String("  %1 %2 (+%3)"))
+                 .arg(QLatin1String(m.first), -20)
+                 .arg(m.second, 6)
+                 .arg(m.second - previous);
+        previous = m.second;
+    }
+    if (!m_finished)
+        lines << QLatin1String("  (in progress)");
+
+    QStringList stored = storedTimelines();
+    if (!stored.isEmpty()) {
+        lines << QLatin1String("Previous runs:");
+        // The current run is already stored once it has finished.
+        for (int i = m_finished ? 1 : 0; i < stored.count(); ++i)
+            lines << QLatin1String("  ") + stored.at(i);
+    }
+    return lines.join(QLatin1Char('\n'));
+}
@@ -0,0 +1,43 @@
+#ifndef QSPOTIFYSTARTUPTIMELINE_H
+#define QSPOTIFYSTARTUPTIMELINE_H
+
+#include <QtCore/QList>
+#include <QtCore/QPair>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+/**
+ * Milestones from process start to the playlists being loaded.
+ *
+ * Times are milliseconds on a monotonic clock started when the library is
+ * loaded. Each milestone is recorded the first time it is reached; once
+ * finish() is called the run is stored in the settings, which keep the
+ * last MaxStoredTimelines runs, and later marks are ignored.
+ *
+ * Must only be used from the GUI thread.
+ */
+class QSpotifyStartupTimeline
+{
+public:
+    enum { MaxStoredTimelines = 10 };
+
+    static QSpotifyStartupTimeline &instance();
+
+    void mark(const char *milestone);
+    void finish();
+    bool isFinished() const { return m_finished; }
+
+    // Current run followed by the stored ones, newest first.
+    QString report() const;
+    QStringList storedTimelines() const;
+
+private:
+    QSpotifyStartupTimeline() = default;
+
+    QString format() const;
+
+    QList<QPair<const char *, qint64> > m_milestones;
+    bool m_finished{};
+};
+
+#endif // QSPOTIFYSTARTUPTIMELINE_H
@@ -0,0 +1,160 @@
+#include "qspotifystringpool.h"
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+
+#include "qspotifymetrics.h"
+
+struct QSpotifyInternedString::Entry
+{
+    QAtomicInt ref;
+    QString string;
+};
+
+struct QSpotifyStringPool
+{
+    QSpotifyStringPool()
+        : entries(QSpotifyMetrics::instance().gauge(QLatin1String("strings.entries")))
+        , storedBytes(QSpotifyMetrics::instance().gauge(QLatin1String("strings.storedBytes")))
+        , savedBytes(QSpotifyMetrics::instance().gauge(QLatin1String("strings.savedBytes")))
+    {}
+
+    QMutex mutex;
+    QHash<QString, QSpotifyInternedString::Entry *> table;
+
+    QSpotifyMetrics::Gauge *entries;
+    QSpotifyMetrics::Gauge *storedBytes;
+    // Compared to every handle holding its own copy
+    QSpotifyMetrics::Gauge *savedBytes;
+};
+
+static QSpotifyStringPool &pool()
+{
+    static QSpotifyStringPool p;
+    return p;
+}
+
+static int stringBytes(const QString &s)
+{
+    return int(sizeof(QString)) + s.size() * int(sizeof(QChar));
+}
+
+QSpotifyInternedString::QSpotifyInternedString(const QString &s)
+    : d(intern(s))
+{
+}
+
+QSpotifyInternedString::QSpotifyInternedString(const char *utf8)
+    : d(utf8 && *utf8 ? intern(QString::fromUtf8(utf8)) : nullptr)
+{
+}
+
+QSpotifyInternedString::QSpotifyInternedString(const QSpotifyInternedString &other)
+    : d(other.d)
+{
+    ref(d);
+}
+
+QSpotifyInternedString::~QSpotifyInternedString()
+{
+    deref(d);
+}
+
+QSpotifyInternedString &QSpotifyInternedString::operator=(const QSpotifyInternedString &other)
+{
+    if (d != other.d) {
+        ref(other.d);
+        deref(d);
+        d = other.d;
+    }
+    return *this;
+}
+
+QSpotifyInternedString &QSpotifyInternedString::operator=(QSpotifyInternedString &&other)
+{
+    if (this != &other) {
+        deref(d);
+        d = other.d;
+        other.d = nullptr;
+    }
+    return *this;
+}
+
+const QString &QSpotifyInternedString::toString() const
+{
+    static const QString empty;
+    return d ? d->string : empty;
+}
+
+QSpotifyInternedString::Entry *QSpotifyInternedString::intern(const QString &s)
+{
+    if (s.isEmpty())
+        return nullptr;
+
+    QSpotifyStringPool &p = pool();
+    QMutexLocker lock(&p.mutex);
+    Entry *&e = p.table[s];
+    if (!e) {
+        e = new Entry;
+        e->string = s;
+        p.entries->add(1);
+        p.storedBytes->add(stringBytes(s));
+    } else {
+        p.savedBytes->add(stringBytes(s));
+    }
+    // 0 -> 1 only happens under the lock, see deref()
+    e->ref.ref();
+    return e;
+}
+
+void QSpotifyInternedString::ref(Entry *e)
+{
+    if (!e)
+        return;
+    // The caller holds a reference, so the entry cannot go away meanwhile
+    e->ref.ref();
+    pool().savedBytes->add(stringBytes(e->string));
+}
+
+void QSpotifyInternedString::deref(Entry *e)
+{
+    if (!e)
+        return;
+
+    QSpotifyStringPool &p = pool();
+    for (;;) {
+        int count = e->ref.load();
+        if (count > 1) {
+            if (e->ref.testAndSetOrdered(count, count - 1)) {
+                p.savedBytes->add(-stringBytes(e->string));
+                return;
+            }
+            continue;
+        }
+        // Dropping the last reference is done under the lock so that
+        // intern() cannot hand the entry out again while it is removed.
+        QMutexLocker lock(&p.mutex);
+        if (e->ref.deref()) {
+            p.savedBytes->add(-stringBytes(e->string));
+        } else {
+            p.table.remove(e->string);
+            p.entries->add(-1);
+            p.storedBytes->add(-stringBytes(e->string));
+            lock.unlock();
+            delete e;
+        }
+        return;
+    }
+}
+
+QVariantMap QSpotifyInternedString::statistics()
+{
+    QSpotifyStringPool &p = pool();
+    QVariantMap map;
+    map.insert(QLatin1String("entries"), p.entries->value());
+    map.insert(QLatin1String("storedBytes"), p.storedBytes->value());
+    map.insert(QLatin1String("savedBytes"), p.savedBytes->value());
+    return map;
+}
@@ -0,0 +1,54 @@
+#ifndef QSPOTIFYSTRINGPOOL_H
+#define QSPOTIFYSTRINGPOOL_H
+
+#include <QtCore/QString>
+#include <QtCore/QVariantMap>
+
+/**
+ * Immutable string shared through a global interning table.
+ *
+ * Equal strings interned anywhere in the process share one entry, so two
+ * interned strings are equal exactly if they point to the same entry.
+ * Entries are reference counted atomically and removed from the table
+ * when the last handle goes away; handles may be created, copied and
+ * destroyed on any thread.
+ *
+ * Used for names that repeat a lot across a library: artist, album and
+ * playlist owner names.
+ */
+class QSpotifyInternedString
+{
+public:
+    QSpotifyInternedString() = default;
+    explicit QSpotifyInternedString(const QString &s);
+    explicit QSpotifyInternedString(const char *utf8);
+    QSpotifyInternedString(const QSpotifyInternedString &other);
+    QSpotifyInternedString(QSpotifyInternedString &&other) : d(other.d) { other.d = nullptr; }
+    ~QSpotifyInternedString();
+
+    QSpotifyInternedString &operator=(const QSpotifyInternedString &other);
+    QSpotifyInternedString &operator=(QSpotifyInternedString &&other);
+
+    const QString &toString() const;
+    bool isEmpty() const { return !d; }
+    int size() const { return toString().size(); }
+
+    bool operator==(const QSpotifyInternedString &other) const { return d == other.d; }
+    bool operator!=(const QSpotifyInternedString &other) const { return d != other.d; }
+
+    // Entries, stored bytes and bytes saved compared to one copy per handle.
+    static QVariantMap statistics();
+
+private:
+    struct Entry;
+
+    static Entry *intern(const QString &s);
+    static void ref(Entry *e);
+    static void deref(Entry *e);
+
+    Entry *d{};
+
+    friend struct QSpotifyStringPool;
+};
+
+#endif // QSPOTIFYSTRINGPOOL_H
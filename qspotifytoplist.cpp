@@ -55,6 +55,8 @@
 #include "qspotifytracklist.h"
 #include "qspotifyuser.h"
 #include "qspotifycachemanager.h"
+#include "qspotifymemory.h"
+#include "qspotifymetrics.h"
 
 #include "listmodels/qspotifyalbumlist.h"
 #include "listmodels/qspotifyartistlist.h"
@@ -117,6 +119,8 @@ void QSpotifyToplist::updateResults()
     setBusy(true);
 
     QMutexLocker lock(&g_mutex);
+    m_requestTimer.start();
+    m_pendingBrowses = 3;
     m_sp_browsetracks = sp_toplistbrowse_create(QSpotifySession::instance()->spsession(), SP_TOPLIST_TYPE_TRACKS, SP_TOPLIST_REGION_EVERYWHERE, NULL, callback_toplistbrowse_complete, 0);
     g_toplistObjects.insert(m_sp_browsetracks, this);
     m_sp_browseartists = sp_toplistbrowse_create(QSpotifySession::instance()->spsession(), SP_TOPLIST_TYPE_ARTISTS, SP_TOPLIST_REGION_EVERYWHERE, NULL, callback_toplistbrowse_complete, 0);
@@ -147,13 +151,21 @@ void QSpotifyToplist::clear(bool emitResults)
         sp_toplistbrowse_release(m_sp_browsealbums);
     g_toplistObjects.remove(m_sp_browsealbums);
     m_sp_browsealbums = nullptr;
+    m_pendingBrowses = 0;
 }
 
 bool QSpotifyToplist::event(QEvent *e)
 {
     if (e->type() == QEvent::User) {
         QSpotifyToplistCompleteEvent *ev = static_cast<QSpotifyToplistCompleteEvent *>(e);
-        populateResults(ev->toplistBrowse());
+        sp_toplistbrowse *tl = ev->toplistBrowse();
+        bool current = tl && (tl == m_sp_browsetracks || tl == m_sp_browseartists || tl == m_sp_browsealbums);
+        // One sample per request, once all three browses are in
+        if (current && m_pendingBrowses > 0 && --m_pendingBrowses == 0) {
+            static QSpotifyMetrics::Histogram *latency = QSpotifyMetrics::instance().histogram(QLatin1String("toplist.latencyMs"));
+            latency->observe(m_requestTimer);
+        }
+        populateResults(tl);
         e->accept();
         return true;
     }
@@ -162,6 +174,7 @@ bool QSpotifyToplist::event(QEvent *e)
 
 void QSpotifyToplist::populateResults(sp_toplistbrowse *tl)
 {
+    QSpotifyMemoryTag memoryTag("toplist");
     if (sp_toplistbrowse_error(tl) != SP_ERROR_OK)
         return;
 
@@ -169,13 +182,8 @@ void QSpotifyToplist::populateResults(sp_toplistbrowse *tl)
         int c = sp_toplistbrowse_num_tracks(tl);
         m_trackResults->reserve(c);
         for (int i = 0; i < c; ++i) {
-            if (auto strack = sp_toplistbrowse_track(tl, i)) {
-                auto track = QSpotifyCacheManager::instance().getTrack(strack);
-
-                m_trackResults->appendRow(track);
-                connect(QSpotifySession::instance()->user()->starredList(), SIGNAL(tracksAdded(QVector<sp_track*>)), track, SLOT(onStarredListTracksAdded(QVector<sp_track*>)));
-                connect(QSpotifySession::instance()->user()->starredList(), SIGNAL(tracksRemoved(QVector<sp_track*>)), track, SLOT(onStarredListTracksRemoved(QVector<sp_track*>)));
-            }
+            if (auto strack = sp_toplistbrowse_track(tl, i))
+                m_trackResults->appendTrack(strack);
         }
     }
 
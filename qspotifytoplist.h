@@ -43,6 +43,7 @@
 #define QSPOTIFYTOPLIST_H
 
 #include <QtCore/QDateTime>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QObject>
 
 class QSpotifyTrackList;
@@ -84,6 +85,9 @@ private:
     sp_toplistbrowse *m_sp_browsealbums{};
 
     bool m_busy{};
+    QElapsedTimer m_requestTimer;
+    // Browses of the current request that have not completed yet
+    int m_pendingBrowses{};
 
     QSpotifyTrackList *m_trackResults;
     QSpotifyAlbumList *m_albumResults;
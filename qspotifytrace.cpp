@@ -0,0 +1,155 @@
+#include "qspotifytrace.h"
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QThread>
+
+#include <atomic>
+
+Q_LOGGING_CATEGORY(lcSession, "qtspotify.session")
+Q_LOGGING_CATEGORY(lcEvents, "qtspotify.events")
+Q_LOGGING_CATEGORY(lcPlayback, "qtspotify.playback")
+Q_LOGGING_CATEGORY(lcPlaylist, "qtspotify.playlist")
+Q_LOGGING_CATEGORY(lcCache, "qtspotify.cache")
+Q_LOGGING_CATEGORY(lcLibspotify, "qtspotify.libspotify")
+
+namespace {
+
+struct TraceSlot {
+    // 0 while the slot is being written, otherwise the ticket + 1 of the
+    // event it holds. Readers skip slots whose sequence changes under them.
+    QAtomicInteger<quint32> seq;
+    const char *category;
+    const char *name;
+    qint64 ts;
+    qint64 duration;
+    quintptr id;
+    quintptr tid;
+    char phase;
+};
+
+TraceSlot g_ring[QSpotifyTrace::RingSize];
+QAtomicInteger<quint32> g_next;
+
+QElapsedTimer startClock()
+{
+    QElapsedTimer t;
+    t.start();
+    return t;
+}
+
+const QElapsedTimer g_clock = startClock();
+
+}
+
+QAtomicInt QSpotifyTrace::s_enabled(!qgetenv("QTSPOTIFY_TRACE").isEmpty());
+
+qint64 QSpotifyTrace::now()
+{
+    return g_clock.nsecsElapsed() / 1000;
+}
+
+void QSpotifyTrace::record(char phase, const char *category, const char *name,
+                           qint64 ts, qint64 duration, const void *id)
+{
+    quint32 ticket = g_next.fetchAndAddRelaxed(1);
+    TraceSlot &slot = g_ring[ticket & (RingSize - 1)];
+    slot.seq.store(0);
+    // Keeps the writes below from becoming visible before the 0
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.category = category;
+    slot.name = name;
+    slot.ts = ts;
+    slot.duration = duration;
+    slot.id = quintptr(id);
+    slot.tid = quintptr(QThread::currentThreadId());
+    slot.phase = phase;
+    slot.seq.storeRelease(ticket + 1);
+}
+
+void QSpotifyTrace::complete(const char *category, const char *name, qint64 start, qint64 duration)
+{
+    record('X', category, name, start, duration, nullptr);
+}
+
+void QSpotifyTrace::asyncBegin(const char *category, const char *name, const void *id)
+{
+    record('b', category, name, now(), 0, id);
+}
+
+void QSpotifyTrace::asyncEnd(const char *category, const char *name, const void *id)
+{
+    record('e', category, name, now(), 0, id);
+}
+
+void QSpotifyTrace::instant(const char *category, const char *name)
+{
+    record('i', category, name, now(), 0, nullptr);
+}
+
+QByteArray QSpotifyTrace::chromeTraceJson()
+{
+    QByteArray json("{\"traceEvents\":[");
+    quint32 end = g_next.loadAcquire();
+    quint32 begin = end > quint32(RingSize) ? end - RingSize : 0;
+    bool first = true;
+    for (quint32 ticket = begin; ticket != end; ++ticket) {
+        const TraceSlot &slot = g_ring[ticket & (RingSize - 1)];
+        quint32 seq = slot.seq.loadAcquire();
+        if (seq != ticket + 1)
+            continue;
+        TraceSlot copy;
+        copy.category = slot.category;
+        copy.name = slot.name;
+        copy.ts = slot.ts;
+        copy.duration = slot.duration;
+        copy.id = slot.id;
+        copy.tid = slot.tid;
+        copy.phase = slot.phase;
+        // Keeps the reads above from moving past the second load of seq
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load() != seq)
+            continue;
+
+        if (!first)
+            json += ',';
+        first = false;
+        json += "{\"name\":\"";
+        json += copy.name;
+        json += "\",\"cat\":\"";
+        json += copy.category;
+        json += "\",\"ph\":\"";
+        json += copy.phase;
+        json += "\",\"ts\":";
+        json += QByteArray::number(copy.ts);
+        if (copy.phase == 'X') {
+            json += ",\"dur\":";
+            json += QByteArray::number(copy.duration);
+        } else if (copy.phase == 'b' || copy.phase == 'e') {
+            json += ",\"id\":\"0x";
+            json += QByteArray::number(quint64(copy.id), 16);
+            json += '"';
+        } else if (copy.phase == 'i') {
+            json += ",\"s\":\"t\"";
+        }
+        json += ",\"pid\":1,\"tid\":";
+        json += QByteArray::number(quint64(copy.tid));
+        json += '}';
+    }
+    json += "]}";
+    return json;
+}
+
+bool QSpotifyTrace::dumpChromeTrace(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    return file.write(chromeTraceJson()) != -1;
+}
+
+QString QSpotifyTrace::defaultTraceFile()
+{
+    return QString::fromLocal8Bit(qgetenv("QTSPOTIFY_TRACE"));
+}
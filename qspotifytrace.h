@@ -0,0 +1,93 @@
+#ifndef QSPOTIFYTRACE_H
+#define QSPOTIFYTRACE_H
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QString>
+
+Q_DECLARE_LOGGING_CATEGORY(lcSession)
+Q_DECLARE_LOGGING_CATEGORY(lcEvents)
+Q_DECLARE_LOGGING_CATEGORY(lcPlayback)
+Q_DECLARE_LOGGING_CATEGORY(lcPlaylist)
+Q_DECLARE_LOGGING_CATEGORY(lcCache)
+Q_DECLARE_LOGGING_CATEGORY(lcLibspotify)
+
+/**
+ * In-memory trace of hot path spans that can be dumped in the Chrome
+ * trace event format (load it in chrome://tracing or Perfetto).
+ *
+ * Tracing is off unless QTSPOTIFY_TRACE is set to the file the trace is
+ * written to on quit, or setEnabled() is called. Events are stored in a
+ * fixed size lock-free ring, so they can be recorded from any thread and
+ * the oldest ones are overwritten once it is full.
+ *
+ * Defining QTSPOTIFY_NO_TRACE compiles all trace points away.
+ */
+class QSpotifyTrace
+{
+public:
+    enum { RingSize = 1 << 14 };
+
+    class Span
+    {
+    public:
+        Span(const char *category, const char *name)
+            : m_category(category), m_name(name)
+            , m_start(QSpotifyTrace::isEnabled() ? QSpotifyTrace::now() : -1)
+        { }
+        ~Span()
+        {
+            if (m_start >= 0)
+                QSpotifyTrace::complete(m_category, m_name, m_start, QSpotifyTrace::now() - m_start);
+        }
+
+    private:
+        const char *m_category;
+        const char *m_name;
+        qint64 m_start;
+
+        Span(const Span &) = delete;
+    };
+
+    // Relaxed, trace points check it on every thread
+    static bool isEnabled() { return s_enabled.load(); }
+    static void setEnabled(bool enabled) { s_enabled.store(enabled); }
+
+    // Microseconds on a monotonic clock.
+    static qint64 now();
+
+    static void complete(const char *category, const char *name, qint64 start, qint64 duration);
+    static void asyncBegin(const char *category, const char *name, const void *id);
+    static void asyncEnd(const char *category, const char *name, const void *id);
+    static void instant(const char *category, const char *name);
+
+    static QByteArray chromeTraceJson();
+    static bool dumpChromeTrace(const QString &fileName);
+    static QString defaultTraceFile();
+
+private:
+    static void record(char phase, const char *category, const char *name,
+                       qint64 ts, qint64 duration, const void *id);
+
+    static QAtomicInt s_enabled;
+};
+
+#ifndef QTSPOTIFY_NO_TRACE
+#define QSPOTIFY_TRACE_CONCAT2(a, b) a##b
+#define QSPOTIFY_TRACE_CONCAT(a, b) QSPOTIFY_TRACE_CONCAT2(a, b)
+#define QSPOTIFY_TRACE_SPAN(category, name) \
+    QSpotifyTrace::Span QSPOTIFY_TRACE_CONCAT(qspotifyTraceSpan, __LINE__)(category, name)
+#define QSPOTIFY_TRACE_BEGIN(category, name, id) \
+    do { if (QSpotifyTrace::isEnabled()) QSpotifyTrace::asyncBegin(category, name, id); } while (0)
+#define QSPOTIFY_TRACE_END(category, name, id) \
+    do { if (QSpotifyTrace::isEnabled()) QSpotifyTrace::asyncEnd(category, name, id); } while (0)
+#define QSPOTIFY_TRACE_INSTANT(category, name) \
+    do { if (QSpotifyTrace::isEnabled()) QSpotifyTrace::instant(category, name); } while (0)
+#else
+#define QSPOTIFY_TRACE_SPAN(category, name) do { } while (0)
+#define QSPOTIFY_TRACE_BEGIN(category, name, id) do { } while (0)
+#define QSPOTIFY_TRACE_END(category, name, id) do { } while (0)
+#define QSPOTIFY_TRACE_INSTANT(category, name) do { } while (0)
+#endif
+
+#endif // QSPOTIFYTRACE_H
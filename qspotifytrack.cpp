@@ -42,16 +42,29 @@
 #include "qspotifytrack.h"
 
 #include <QtCore/QDebug>
+#include <QtCore/QThread>
 
 #include "qspotifyalbum.h"
 #include "qspotifyartist.h"
 #include "qspotifyplaylist.h"
+#include "qspotifyplaylistcontainer.h"
 #include "qspotifyplayqueue.h"
 #include "qspotifysession.h"
 #include "qspotifytracklist.h"
 #include "qspotifyuser.h"
 #include "qspotifycachemanager.h"
-#include "qspotifyutil.h"
+#include "qspotifymetadatastore.h"
+
+static bool starredState(sp_track *track)
+{
+    // The index is not thread safe, libspotify knows as well
+    auto session = QSpotifySession::instance();
+    if (auto user = session->user()) {
+        if (QThread::currentThread() == session->thread())
+            return user->isStarred(track);
+    }
+    return sp_track_is_starred(session->spsession(), track);
+}
 
 QSpotifyTrack::QSpotifyTrack(sp_track *track, QSpotifyPlaylist *playlist)
     : QSpotifyObject(true)
@@ -61,10 +74,10 @@ QSpotifyTrack::QSpotifyTrack(sp_track *track, QSpotifyPlaylist *playlist)
     sp_track_add_ref(track);
     m_sp_track = track;
     m_error = TrackError(sp_track_error(m_sp_track));
+    m_isStarred = starredState(track);
+    m_offlineMode = QSpotifySession::instance()->offlineMode();
 
-    connect(QSpotifySession::instance(), SIGNAL(currentTrackChanged()), this, SLOT(onSessionCurrentTrackChanged()));
     connect(this, SIGNAL(dataChanged()), this, SIGNAL(trackDataChanged()));
-    connect(QSpotifySession::instance(), SIGNAL(offlineModeChanged()), this, SLOT(onSessionOfflineModeChanged()));
 }
 
 QSpotifyTrack::~QSpotifyTrack()
@@ -107,7 +120,8 @@ bool QSpotifyTrack::updateData()
         int popularity = sp_track_popularity(m_sp_track);
         OfflineStatus offlineSt = OfflineStatus(sp_track_offline_get_status(m_sp_track));
         if (m_playlist && m_playlist->type() == QSpotifyPlaylist::Inbox) {
-            int tindex = m_playlist->m_trackList->indexOf(this);
+            int row = m_playlist->m_trackList->indexOf(this);
+            int tindex = row >= 0 ? m_playlist->libspotifyPosition(row) : -1;
 
             if (tindex >= 0 && tindex < sp_playlist_num_tracks(m_playlist->m_sp_playlist)) {
                 bool seen = sp_playlist_track_seen(m_playlist->m_sp_playlist, tindex);
@@ -161,66 +175,131 @@ bool QSpotifyTrack::updateData()
             updated = true;
         }
 
-        if (!m_artist) {
-            int count = sp_track_num_artists(m_sp_track);
-            QStringList artistNames;
-            artistNames.reserve(count);
-            for (int i = 0; i < count; ++i) {
-                if (auto sartist = sp_track_artist(m_sp_track, i)) {
-                    if (auto artist = QSpotifyCacheManager::instance().getArtist(sartist)) {
-                        artistNames << artist->name();
-                        if(0 == i)
-                            m_artist = artist;
-                        else
-                            artist->release();
-                    }
-                }
+        if (!m_artistsLoaded) {
+            QSpotifyInternedString artists(artistNames(m_sp_track, &m_artistsLoaded));
+            // Keep stored names until libspotify has all of them
+            if (artists != m_artistsString && (m_artistsLoaded || m_artistsString.isEmpty())) {
+                m_artistsString = artists;
+                updated = true;
             }
-            m_artistsString = artistNames.join(QStringLiteral(", "));
-            updated = true;
         }
-        if (!m_album) {
-            if (auto salb = sp_track_album(m_sp_track)) {
-                if (auto alb = QSpotifyCacheManager::instance().getAlbum(salb)) {
-                    m_album = alb;
-                    updated = true;
-                }
+
+        sp_album *salb = sp_track_album(m_sp_track);
+        if (!m_albumLoaded && salb && sp_album_is_loaded(salb)) {
+            m_albumLoaded = true;
+            QSpotifyInternedString albumName(sp_album_name(salb));
+            QSpotifyId coverId = QSpotifyId::fromImageId(sp_album_cover(salb, SP_IMAGE_SIZE_NORMAL));
+            if (m_albumName != albumName || m_albumCoverId != coverId) {
+                m_albumName = albumName;
+                m_albumCoverId = coverId;
+                updated = true;
             }
         }
-        // Get track uri
-        sp_link *link = sp_link_create_from_track(m_sp_track, 0);
-        QSpotifyUtil::spLinkToQString(link, [this, &updated] (const QString &trackId) {
-            m_trackId = trackId;
-            updated = true;
-        });
+
+        if (!m_id.isValid()) {
+            QSpotifyId id = QSpotifyId::fromLink(sp_link_create_from_track(m_sp_track, 0));
+            if (m_id != id) {
+                m_id = id;
+                updated = true;
+            }
+        }
+
+        if (updated)
+            storeMetadata();
+    } else if (m_error == IsLoading && m_name.isEmpty()) {
+        updated = loadStoredMetadata() || updated;
     }
 
     return updated;
 }
 
+bool QSpotifyTrack::loadStoredMetadata()
+{
+    QSpotifyMetadataStore &store = QSpotifyMetadataStore::instance();
+    if (!store.isOpen())
+        return false;
+
+    if (!m_id.isValid())
+        m_id = QSpotifyId::fromLink(sp_link_create_from_track(m_sp_track, 0));
+
+    QSpotifyMetadataStore::Record r;
+    if (!store.lookup(m_id.toUri(), &r))
+        return false;
+
+    m_name = r.name;
+    m_artistsString = QSpotifyInternedString(r.artists);
+    m_albumName = QSpotifyInternedString(r.album);
+    m_albumCoverId = QSpotifyId::fromUri(r.coverId.toLatin1());
+    m_duration = r.duration;
+    m_durationString = QSpotifySession::instance()->formatDuration(m_duration);
+    m_popularity = r.popularity;
+    m_isAvailable = r.available;
+    return true;
+}
+
+void QSpotifyTrack::storeMetadata()
+{
+    if (!m_id.isValid() || m_name.isEmpty())
+        return;
+
+    QSpotifyMetadataStore::Record r;
+    r.name = m_name;
+    r.artists = m_artistsString.toString();
+    r.album = m_albumName.toString();
+    r.coverId = m_albumCoverId.toString();
+    r.duration = m_duration;
+    r.popularity = m_popularity;
+    r.available = m_isAvailable;
+    QSpotifyMetadataStore::instance().store(m_id.toUri(), QSpotifyMetadataStore::Track, r);
+}
+
 QString QSpotifyTrack::artists() const
 {
-    return m_artistsString;
+    return m_artistsString.toString();
 }
 
 QString QSpotifyTrack::album() const
 {
-    if (!m_album)
-        return QString();
-    return m_album->name();
+    return m_albumName.toString();
 }
 
 QString QSpotifyTrack::albumCoverId() const
 {
-    if (!m_album)
-        return QString();
+    return m_albumCoverId.toString();
+}
+
+QSpotifyAlbum *QSpotifyTrack::albumObject() const
+{
+    if (!m_album) {
+        if (auto salb = sp_track_album(m_sp_track))
+            m_album = QSpotifyCacheManager::instance().getAlbum(salb);
+    }
+    return m_album;
+}
 
-    return m_album->coverId();
+QSpotifyArtist *QSpotifyTrack::artistObject() const
+{
+    if (!m_artist && sp_track_num_artists(m_sp_track) > 0) {
+        if (auto sartist = sp_track_artist(m_sp_track, 0))
+            m_artist = QSpotifyCacheManager::instance().getArtist(sartist);
+    }
+    return m_artist;
 }
 
-bool QSpotifyTrack::isStarred() const
+QString QSpotifyTrack::artistNames(sp_track *track, bool *complete)
 {
-    return sp_track_is_starred(QSpotifySession::instance()->m_sp_session, m_sp_track);
+    *complete = true;
+    int count = sp_track_num_artists(track);
+    QStringList names;
+    names.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        sp_artist *artist = sp_track_artist(track, i);
+        if (artist && sp_artist_is_loaded(artist))
+            names << QString::fromUtf8(sp_artist_name(artist));
+        else
+            *complete = false;
+    }
+    return names.join(QStringLiteral(", "));
 }
 
 void QSpotifyTrack::setIsStarred(bool v)
@@ -264,27 +343,30 @@ void QSpotifyTrack::removeFromPlaylist()
         m_playlist->remove(this);
 }
 
-void QSpotifyTrack::onSessionCurrentTrackChanged()
+QList<QObject *> QSpotifyTrack::playlistsContaining() const
 {
-    bool newValue = QSpotifySession::instance()->currentTrack() == this;
-    if (m_isCurrentPlayingTrack != newValue) {
-        m_isCurrentPlayingTrack = newValue;
-        emit isCurrentPlayingTrackChanged();
-        emit dataChanged();
-    }
+    QList<QObject *> result;
+    QSpotifyUser *user = QSpotifySession::instance()->user();
+    if (!user)
+        return result;
+    for (QSpotifyPlaylist *pl : user->playlistContainer()->playlistsContaining(m_sp_track))
+        result.append(pl);
+    return result;
 }
 
-void QSpotifyTrack::onStarredListTracksAdded(QVector<sp_track *> v)
+void QSpotifyTrack::setIsCurrentPlayingTrack(bool current)
 {
-    if (v.contains(m_sp_track)) {
-        emit isStarredChanged();
-        emit dataChanged();
+    // Track lists update their rows from QSpotifySession::currentTrackChanged()
+    if (m_isCurrentPlayingTrack != current) {
+        m_isCurrentPlayingTrack = current;
+        emit isCurrentPlayingTrackChanged();
     }
 }
 
-void QSpotifyTrack::onStarredListTracksRemoved(QVector<sp_track *> v)
+void QSpotifyTrack::updateStarred(bool starred)
 {
-    if (v.contains(m_sp_track)) {
+    if (m_isStarred != starred) {
+        m_isStarred = starred;
         emit isStarredChanged();
         emit dataChanged();
     }
@@ -302,10 +384,30 @@ void QSpotifyTrack::destroy()
     // Even if we still are playing we are destroyed so we shouldn't stop the new music
     m_isCurrentPlayingTrack = false;
     // We don't care about signals if we are scheduled to be destroyed
-    disconnect(QSpotifySession::instance(), SIGNAL(currentTrackChanged()), this, SLOT(onSessionCurrentTrackChanged()));
     disconnect(this, SIGNAL(dataChanged()), this, SIGNAL(trackDataChanged()));
-    disconnect(QSpotifySession::instance(), SIGNAL(offlineModeChanged()), this, SLOT(onSessionOfflineModeChanged()));
-    deleteLater();
+    QSpotifyCacheManager::instance().scheduleDestroy(this);
+}
+
+int QSpotifyTrack::estimatedSize() const
+{
+    // Interned names are shared and not counted here
+    return int(sizeof(QSpotifyTrack))
+            + (m_durationString.size() + m_name.size() + m_creator.size()) * int(sizeof(QChar));
+}
+
+void QSpotifyTrack::retire()
+{
+    QSpotifyObject::retire();
+    // The playlist may go away while we are retained, getTrack() sets it again
+    m_playlist = nullptr;
+    m_isCurrentPlayingTrack = false;
+}
+
+void QSpotifyTrack::revive()
+{
+    QSpotifyObject::revive();
+    // Missed toggles while retained, new holders read isAvailable() afresh
+    m_offlineMode = QSpotifySession::instance()->offlineMode();
 }
 
 void QSpotifyTrack::setSeen(bool s)
@@ -313,7 +415,9 @@ void QSpotifyTrack::setSeen(bool s)
     if (!m_playlist)
         return;
 
-    sp_playlist_track_set_seen(m_playlist->m_sp_playlist, m_playlist->m_trackList->indexOf(this), s);
+    int row = m_playlist->m_trackList->indexOf(this);
+    if (row >= 0)
+        sp_playlist_track_set_seen(m_playlist->m_sp_playlist, m_playlist->libspotifyPosition(row), s);
 }
 
 bool QSpotifyTrack::isAvailableOffline() const
@@ -326,10 +430,12 @@ bool QSpotifyTrack::isAvailable() const
     return m_isAvailable && (!QSpotifySession::instance()->offlineMode() || isAvailableOffline());
 }
 
-void QSpotifyTrack::onSessionOfflineModeChanged()
+void QSpotifyTrack::offlineModeChanged()
 {
-    if (!isAvailableOffline()) {
+    bool offline = QSpotifySession::instance()->offlineMode();
+    if (m_offlineMode == offline)
+        return;
+    m_offlineMode = offline;
+    if (!isAvailableOffline())
         emit isAvailableChanged();
-        emit dataChanged();
-    }
 }
@@ -48,6 +48,9 @@
 #include <libspotify/api.h>
 
 #include "qspotifyobject.h"
+#include "qspotifyid.h"
+#include "qspotifyobjectpool.h"
+#include "qspotifystringpool.h"
 
 class QSpotifyAlbum;
 class QSpotifyArtist;
@@ -57,6 +60,7 @@ class QSpotifyTrackList;
 class QSpotifyTrack : public QSpotifyObject
 {
     Q_OBJECT
+    QSPOTIFY_DECLARE_POOLED(QSpotifyTrack)
     Q_PROPERTY(QString name READ name NOTIFY trackDataChanged)
     Q_PROPERTY(QString trackId READ trackId NOTIFY trackDataChanged)
     Q_PROPERTY(QString artists READ artists NOTIFY trackDataChanged)
@@ -110,14 +114,20 @@ public:
     QString durationString() const { return m_durationString; }
     TrackError error() const { return m_error; }
     int discIndex() const { return m_discIndex; }
+    // Depends on the session's offline mode. On a toggle the track lists
+    // emit isAvailableChanged() for the tracks they hold and the session
+    // for the current track; other tracks are not told.
     bool isAvailable() const;
-    bool isStarred() const;
+    // Kept up to date by QSpotifyUser's starred index.
+    bool isStarred() const { return m_isStarred; }
     void setIsStarred(bool v);
     QString name() const { return m_name; }
-    QString trackId() const { return m_trackId; }
+    QString trackId() const { return m_id.toString(); }
+    QSpotifyId id() const { return m_id; }
     int popularity() const { return m_popularity; }
-    QSpotifyAlbum *albumObject() const { return m_album; }
-    QSpotifyArtist *artistObject() const { return m_artist; }
+    // Created on first use, loading a track only needs the names.
+    QSpotifyAlbum *albumObject() const;
+    QSpotifyArtist *artistObject() const;
     bool seen() const { return m_seen; }
     void setSeen(bool s);
     QString creator() const { return m_creator; }
@@ -130,10 +140,21 @@ public:
 
     sp_track *sptrack() const { return m_sp_track; }
 
+    // Names of the track's artists joined with ", ". complete is set to
+    // false if libspotify has not loaded all of them yet.
+    static QString artistNames(sp_track *track, bool *complete);
+
     void updateSeen(bool s);
 
     void destroy();
 
+    int estimatedSize() const;
+    void retire();
+    void revive();
+
+    // The user's playlists this track is in, in container order.
+    Q_INVOKABLE QList<QObject *> playlistsContaining() const;
+
 public Q_SLOTS:
     void pause();
     void resume();
@@ -153,22 +174,30 @@ Q_SIGNALS:
 protected:
     bool updateData();
 
-private Q_SLOTS:
-    void onSessionCurrentTrackChanged();
-    void onStarredListTracksAdded(QVector<sp_track *>);
-    void onStarredListTracksRemoved(QVector<sp_track *>);
-    void onSessionOfflineModeChanged();
-
 private:
     QSpotifyTrack(sp_track *track, QSpotifyPlaylist *playlist);
 
+    bool loadStoredMetadata();
+    void storeMetadata();
+
+    // Called by QSpotifySession for the previous and the new current track
+    // only, instead of every track listening to the session.
+    void setIsCurrentPlayingTrack(bool current);
+    void offlineModeChanged();
+    void updateStarred(bool starred);
+
     sp_track *m_sp_track{};
-    QString m_trackId;
+    QSpotifyId m_id;
     QSpotifyPlaylist *m_playlist{};
 
-    QSpotifyAlbum *m_album{};
-    QSpotifyArtist *m_artist{};
-    QString m_artistsString;
+    mutable QSpotifyAlbum *m_album{};
+    mutable QSpotifyArtist *m_artist{};
+    bool m_artistsLoaded{};
+    bool m_albumLoaded{};
+    // Also filled from the metadata store until libspotify has the data
+    QSpotifyInternedString m_albumName;
+    QSpotifyId m_albumCoverId;
+    QSpotifyInternedString m_artistsString;
     int m_discNumber{};
     int m_duration{};
     QString m_durationString;
@@ -180,10 +209,16 @@ private:
     int m_popularity{};
     bool m_seen{true};
     QString m_creator;
-    int m_creationDate;
+    int m_creationDate{};
     OfflineStatus m_offlineStatus{No};
 
     bool m_isCurrentPlayingTrack{};
+    // Offline mode that isAvailableChanged() was last emitted for, so a
+    // track held by several lists is told once per toggle
+    bool m_offlineMode{};
+    bool m_isStarred{};
+    // Row in m_playlist's track list when last seen there, checked on use
+    mutable int m_row{-1};
 
     friend class QSpotifyPlaylist;
     friend class QSpotifySession;
@@ -193,6 +228,8 @@ private:
     friend class QSpotifyAlbumBrowse;
     friend class QSpotifyArtistBrowse;
     friend class QSpotifyToplist;
+    friend class QSpotifyTrackRecords;
+    friend class QSpotifyTrackList;
 
     friend class QSpotifyCacheManager;
 };
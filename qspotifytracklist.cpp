@@ -41,8 +41,14 @@
 
 #include "qspotifytracklist.h"
 
+#include <algorithm>
+#include <functional>
+
+#include "qspotifycachemanager.h"
+#include "qspotifyplaylist.h"
 #include "qspotifysession.h"
 #include "qspotifyplayqueue.h"
+#include "qspotifyuser.h"
 
 QSpotifyTrackList::QSpotifyTrackList(QObject *parent)
     : ListModelBase<QSpotifyTrack>(parent)
@@ -69,44 +75,52 @@ QSpotifyTrackList::QSpotifyTrackList(QObject *parent)
     m_roles[RawPtrRole] = "rawPtr";
 }
 
+QSpotifyTrackList::~QSpotifyTrackList()
+{
+    // The objects are released by ListModelBase
+    m_records.clear();
+}
+
 QVariant QSpotifyTrackList::data(const QModelIndex &index, int role) const
 {
-    if(index.row() < 0 || index.row() >= m_dataList.size())
+    int row = index.row();
+    if(row < 0 || row >= m_dataList.size())
         return QVariant();
-    auto track = m_dataList.at(index.row());
     switch(role) {
     case NameRole:
-        return track->name();
+        return m_records.name(row);
     case ArtistsRole:
-        return track->artists();
+        return m_records.artists(row);
     case AlbumRole:
-        return track->album();
+        return m_records.album(row);
     case AlbumCoverRole:
-        return track->albumCoverId();
+        return m_records.albumCoverId(row);
     case DiscNumberRole:
-        return track->discNumber();
+        return m_records.discNumber(row);
     case DurationRole:
-        return track->durationString();
+        return QSpotifySession::instance()->formatDuration(m_records.duration(row));
     case DurationMsRole:
-        return track->duration();
+        return m_records.duration(row);
     case ErrorRole:
-        return track->error();
+        return m_records.error(row);
     case DiscIndexRole:
-        return track->discIndex();
+        return m_records.discIndex(row);
     case IsAvailableRole:
-        return track->isAvailable();
+        return m_records.isAvailable(row);
     case IsStarredRole:
-        return track->isStarred();
+        return m_records.isStarred(row);
     case PopularityRole:
-        return track->popularity();
-    case IsCurrentPlayingTrackRole:
-        return track->isCurrentPlayingTrack();
+        return m_records.popularity(row);
+    case IsCurrentPlayingTrackRole: {
+        auto current = QSpotifySession::instance()->currentTrack();
+        return current && current->sptrack() == m_records.track(row);
+    }
     case SeenRole:
-        return track->seen();
+        return m_records.seen(row);
     case CreatorRole:
-        return track->creator();
+        return m_records.creator(row);
     case CreationDateRole:
-        return track->creationDate();
+        return QDateTime::fromTime_t(m_records.creationDate(row));
         // TODO
     case AlbumObjectRole:
         return QVariant();
@@ -115,12 +129,361 @@ QVariant QSpotifyTrackList::data(const QModelIndex &index, int role) const
     case OfflineStatusRole:
         return QVariant();
     case RawPtrRole:
-        return QVariant::fromValue<QSpotifyTrack *>(track);
+        return QVariant::fromValue<QSpotifyTrack *>(at(row));
     default:
         return QVariant();
     }
 }
 
+QSpotifyTrack *QSpotifyTrackList::at(int index) const
+{
+    if (auto track = m_dataList.at(index))
+        return track;
+    return const_cast<QSpotifyTrackList *>(this)->createObject(index);
+}
+
+QSpotifyTrack *QSpotifyTrackList::createObject(int row)
+{
+    auto playlist = qobject_cast<QSpotifyPlaylist *>(parent());
+    auto track = QSpotifyCacheManager::instance().getTrack(m_records.track(row), playlist);
+    if (!track)
+        return nullptr;
+    m_dataList[row] = track;
+    if (ownsRowHint(track))
+        track->m_row = row;
+    connect(track, &QSpotifyObject::dataChanged, this, &QSpotifyTrackList::itemDataChanged);
+    return track;
+}
+
+bool QSpotifyTrackList::ownsRowHint(const QSpotifyTrack *track) const
+{
+    // A track shared by several lists keeps the row of its playlist's
+    return track->m_playlist && track->m_playlist->m_trackList == this;
+}
+
+int QSpotifyTrackList::rowOf(QSpotifyTrack *track) const
+{
+    if (!track)
+        return -1;
+    int hint = track->m_row;
+    if (hint >= 0 && hint < m_dataList.size() && m_dataList.at(hint) == track)
+        return hint;
+    int row = m_dataList.indexOf(track);
+    if (row >= 0 && ownsRowHint(track))
+        track->m_row = row;
+    return row;
+}
+
+void QSpotifyTrackList::releaseObject(int row)
+{
+    auto track = m_dataList.at(row);
+    if (!track)
+        return;
+    disconnect(track, &QSpotifyObject::dataChanged, this, &QSpotifyTrackList::itemDataChanged);
+    m_dataList[row] = nullptr;
+    track->release();
+}
+
+void QSpotifyTrackList::setVisibleRange(int first, int last)
+{
+    // In rows, about a screen on a phone
+    enum { Page = 50, ReleaseDistance = 4 * Page };
+
+    if (m_dataList.isEmpty())
+        return;
+    first = qBound(0, first, m_dataList.size() - 1);
+    last = qBound(first, last, m_dataList.size() - 1);
+
+    int from = qMax(0, first - Page);
+    int to = qMin(m_dataList.size() - 1, last + Page);
+    for (int row = from; row <= to; ++row) {
+        if (!m_dataList.at(row))
+            createObject(row);
+    }
+
+    // Only lists that started out lazy can do without the objects, at most
+    // one pass per page scrolled
+    if (!m_watchingLazyRows || (m_releasedAt >= 0 && qAbs(first - m_releasedAt) < Page))
+        return;
+    m_releasedAt = first;
+    int keepFrom = qMax(0, first - ReleaseDistance);
+    int keepTo = qMin(m_dataList.size() - 1, last + ReleaseDistance);
+    // Only rows that left the window kept by the last pass
+    int leftTo = qMin(m_keptTo, m_dataList.size() - 1);
+    for (int row = m_keptFrom; row <= leftTo; ++row) {
+        if (row >= keepFrom && row <= keepTo)
+            row = keepTo;
+        else
+            releaseObject(row);
+    }
+    m_keptFrom = keepFrom;
+    m_keptTo = keepTo;
+}
+
+int QSpotifyTrackList::indexOf(QSpotifyTrack *ptr) const
+{
+    int i = rowOf(ptr);
+    if (i < 0 && ptr)
+        i = m_records.indexOf(ptr->sptrack());
+    return i;
+}
+
+void QSpotifyTrackList::appendTrack(sp_track *track)
+{
+    if (!track)
+        return;
+    insertTracks(m_dataList.size(), QVector<sp_track *>() << track);
+}
+
+void QSpotifyTrackList::insertTracks(int row, const QVector<sp_track *> &tracks)
+{
+    if (tracks.isEmpty())
+        return;
+    watchSession();
+    watchLazyRows();
+    beginInsertRows(QModelIndex(), row, row + tracks.size() - 1);
+    QList<QSpotifyTrack *> rows;
+    rows.reserve(m_dataList.size() + tracks.size());
+    rows.append(m_dataList.mid(0, row));
+    for (int i = 0; i < tracks.size(); ++i)
+        rows.append(nullptr);
+    rows.append(m_dataList.mid(row));
+    m_dataList.swap(rows);
+    m_records.reserve(m_dataList.size());
+    for (int i = 0; i < tracks.size(); ++i) {
+        m_records.insert(row + i, tracks.at(i));
+        m_records.update(row + i);
+    }
+    endInsertRows();
+    accountMemory();
+}
+
+void QSpotifyTrackList::moveRows(const QVector<int> &positions, int newPosition)
+{
+    QVector<int> order;
+    order.reserve(m_dataList.size() + positions.size());
+    for (int i = 0; i < m_dataList.size(); ++i)
+        order.append(i);
+
+    // Same as taking the rows out, inserting them at newPosition of the
+    // list that still has the gaps and then closing the gaps.
+    QVector<int> moved;
+    for (int pos : positions) {
+        if (pos < 0 || pos >= m_dataList.size() || order.at(pos) < 0)
+            continue;
+        moved.append(pos);
+        order[pos] = -1;
+    }
+    if (moved.isEmpty())
+        return;
+    for (int pos : moved)
+        order.insert(qBound(0, newPosition++, order.size()), pos);
+    order.removeAll(-1);
+
+    // Bring each row of the new order into place, together with the rows
+    // following it in both orders
+    QVector<int> current;
+    current.reserve(order.size());
+    for (int i = 0; i < order.size(); ++i)
+        current.append(i);
+    for (int row = 0; row < order.size(); ++row) {
+        if (current.at(row) == order.at(row))
+            continue;
+        int from = current.indexOf(order.at(row), row + 1);
+        int count = 1;
+        while (from + count < current.size() && current.at(from + count) == order.at(row + count))
+            ++count;
+
+        beginMoveRows(QModelIndex(), from, from + count - 1, QModelIndex(), row);
+        std::rotate(m_dataList.begin() + row, m_dataList.begin() + from, m_dataList.begin() + from + count);
+        std::rotate(current.begin() + row, current.begin() + from, current.begin() + from + count);
+        m_records.move(from, count, row);
+        endMoveRows();
+        row += count - 1;
+    }
+}
+
+QVector<sp_track *> QSpotifyTrackList::removeRowsAt(QVector<int> positions)
+{
+    std::sort(positions.begin(), positions.end(), std::greater<int>());
+    positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+
+    QVector<sp_track *> removed;
+    int i = 0;
+    while (i < positions.size()) {
+        int last = positions.at(i);
+        if (last < 0 || last >= m_dataList.size()) {
+            ++i;
+            continue;
+        }
+        // Descending, so a run ends where the positions stop being consecutive
+        int first = last;
+        while (++i < positions.size() && positions.at(i) == first - 1 && first > 0)
+            --first;
+        for (int row = first; row <= last; ++row)
+            removed.append(m_records.track(row));
+        for (auto track : takeRows(first, last - first + 1)) {
+            if (track)
+                track->release();
+        }
+    }
+    return removed;
+}
+
+void QSpotifyTrackList::updateRows()
+{
+    // One range over the changed rows without an object
+    int first = -1;
+    int last = -1;
+    for (int row = 0; row < m_dataList.size(); ++row) {
+        // Objects report back through itemDataChanged()
+        if (auto track = m_dataList.at(row)) {
+            // Rows may have moved, looking them up again would be quadratic
+            if (ownsRowHint(track))
+                track->m_row = row;
+            track->metadataUpdated();
+        } else if (m_records.update(row)) {
+            if (first < 0)
+                first = row;
+            last = row;
+        }
+    }
+    if (first >= 0) {
+        emit dataChanged(index(first), index(last));
+        emit rowsDataChanged();
+    }
+}
+
+int QSpotifyTrackList::estimatedSize() const
+{
+    return int(sizeof(QSpotifyTrackList)) + m_dataList.size() * int(sizeof(QSpotifyTrack *)) + int(m_records.bytes());
+}
+
+void QSpotifyTrackList::rowInserted(int row)
+{
+    watchSession();
+    auto track = m_dataList.at(row);
+    if (ownsRowHint(track))
+        track->m_row = row;
+    m_records.insert(row, track->sptrack());
+    m_records.update(row, track);
+}
+
+void QSpotifyTrackList::rowsRemoved(int row, int count)
+{
+    m_records.remove(row, count);
+}
+
+void QSpotifyTrackList::rowsCleared()
+{
+    m_records.clear();
+    m_releasedAt = -1;
+    m_keptFrom = 0;
+    m_keptTo = -1;
+}
+
+void QSpotifyTrackList::rowChanged(int row)
+{
+    if (auto track = m_dataList.at(row)) {
+        m_records.update(row, track);
+        emit rowsDataChanged();
+    }
+}
+
+void QSpotifyTrackList::watchSession()
+{
+    // Not done in the constructor, the play queue is created by the session
+    if (m_watchingSession)
+        return;
+    m_watchingSession = true;
+    auto session = QSpotifySession::instance();
+    if (auto current = session->currentTrack())
+        m_currentTrack = current->sptrack();
+    connect(session, SIGNAL(currentTrackChanged()), this, SLOT(onCurrentTrackChanged()));
+    connect(session, SIGNAL(offlineModeChanged()), this, SLOT(onOfflineModeChanged()));
+}
+
+void QSpotifyTrackList::watchLazyRows()
+{
+    // Rows without an object are not told about changes by a QSpotifyTrack
+    if (m_watchingLazyRows)
+        return;
+    m_watchingLazyRows = true;
+    auto session = QSpotifySession::instance();
+    connect(session, SIGNAL(metadataUpdated()), this, SLOT(onMetadataUpdated()));
+    if (auto user = session->user())
+        connect(user, SIGNAL(starredTracksChanged(QVector<sp_track*>)), this, SLOT(onStarredChanged(QVector<sp_track*>)));
+}
+
+void QSpotifyTrackList::onMetadataUpdated()
+{
+    bool changed = false;
+    for (int row = 0; row < m_dataList.size(); ++row) {
+        if (m_dataList.at(row) || m_records.isComplete(row))
+            continue;
+        if (m_records.update(row)) {
+            auto idx = index(row);
+            emit dataChanged(idx, idx);
+            changed = true;
+        }
+    }
+    if (changed)
+        emit rowsDataChanged();
+}
+
+void QSpotifyTrackList::onCurrentTrackChanged()
+{
+    auto current = QSpotifySession::instance()->currentTrack();
+    sp_track *track = current ? current->sptrack() : nullptr;
+    if (track == m_currentTrack)
+        return;
+
+    sp_track *previous = m_currentTrack;
+    m_currentTrack = track;
+    for (auto t : { previous, track }) {
+        if (!t)
+            continue;
+        for (int row = m_records.indexOf(t); row >= 0; row = m_records.indexOf(t, row + 1)) {
+            auto idx = index(row);
+            emit dataChanged(idx, idx, QVector<int>() << IsCurrentPlayingTrackRole);
+        }
+    }
+}
+
+void QSpotifyTrackList::onOfflineModeChanged()
+{
+    // One range over the rows that are not available offline, their
+    // objects notify whoever holds them
+    int first = -1;
+    int last = -1;
+    for (int row = 0; row < m_records.count(); ++row) {
+        if (!m_records.dependsOnOfflineMode(row))
+            continue;
+        if (first < 0)
+            first = row;
+        last = row;
+        if (auto track = m_dataList.at(row))
+            track->offlineModeChanged();
+    }
+    if (first >= 0)
+        emit dataChanged(index(first), index(last), QVector<int>() << IsAvailableRole);
+}
+
+void QSpotifyTrackList::onStarredChanged(QVector<sp_track *> tracks)
+{
+    // Rows with an object were updated through its dataChanged() already
+    auto user = QSpotifySession::instance()->user();
+    for (auto track : tracks) {
+        bool starred = user->isStarred(track);
+        for (int row = m_records.indexOf(track); row >= 0; row = m_records.indexOf(track, row + 1)) {
+            if (m_dataList.at(row) || !m_records.setStarred(row, starred))
+                continue;
+            auto idx = index(row);
+            emit dataChanged(idx, idx, QVector<int>() << IsStarredRole);
+        }
+    }
+}
+
 void QSpotifyTrackList::play()
 {
     if (count() == 0) return;
@@ -137,28 +500,19 @@ void QSpotifyTrackList::playTrack(int index)
     }
 }
 
-int QSpotifyTrackList::removeAll(QSpotifyTrack *ptr)
-{
-    beginResetModel();
-    int count = m_dataList.removeAll(ptr);
-    endResetModel();
-    return count;   
-}
-
 int QSpotifyTrackList::totalDuration() const
 {
-    return std::accumulate(begin(), end(), 0,
-                           [](int total, QSpotifyTrack *t){ return total + t->duration();});
+    return int(m_records.totals().duration);
 }
 
 int QSpotifyTrackList::nextAvailable(int i)
 {
-    do { ++i; } while (i < count() && !at(i)->isAvailable());
+    do { ++i; } while (i < count() && !m_records.isAvailable(i));
     return i;
 }
 
 int QSpotifyTrackList::previousAvailable(int i)
 {
-    do { --i; } while (i > -1 && !at(i)->isAvailable());
+    do { --i; } while (i > -1 && !m_records.isAvailable(i));
     return i;
 }
@@ -43,6 +43,7 @@
 #define QSPOTIFYTRACKLIST_H
 
 #include "qspotifytrack.h"
+#include "qspotifytrackrecords.h"
 #include "listmodels/listmodelbase.h"
 
 class QSpotifyTrackList : public ListModelBase<QSpotifyTrack>
@@ -73,6 +74,7 @@ public:
     };
 
     QSpotifyTrackList(QObject *parent = nullptr);
+    ~QSpotifyTrackList();
 
     QVariant data(const QModelIndex &index, int role) const;
     QHash<int, QByteArray> roleNames() const { return m_roles; }
@@ -82,21 +84,70 @@ public:
 
     int totalDuration() const;
 
-    int indexOf(QSpotifyTrack *ptr) const
-    { return m_dataList.indexOf(ptr); }
+    int indexOf(QSpotifyTrack *ptr) const;
 
-    void replace(int i, QSpotifyTrack *ptr)
-    { m_dataList.replace(i, ptr); }
+    // Appends a row that only gets a QSpotifyTrack once at() is called for it,
+    // until then the model is served from the records.
+    void appendTrack(sp_track *track);
+    // Same for many rows at once, with one beginInsertRows().
+    void insertTracks(int row, const QVector<sp_track *> &tracks);
+    QSpotifyTrack *at(int index) const;
+    bool hasObject(int index) const { return m_dataList.at(index); }
+    const QSpotifyTrackRecords &records() const { return m_records; }
 
-    int removeAll(QSpotifyTrack *ptr);
+    // Moves the rows at positions, in that order, to newPosition. Views see
+    // one row move per contiguous run of rows.
+    void moveRows(const QVector<int> &positions, int newPosition);
+    // Removes the rows at positions with one row removal per contiguous
+    // run and returns their tracks.
+    QVector<sp_track *> removeRowsAt(QVector<int> positions);
+    // Reloads every row from its object or from libspotify.
+    void updateRows();
+
+    // Range hint from the view: creates the objects of the rows around the
+    // visible ones and, for lists of lazy rows, releases those far away.
+    Q_INVOKABLE void setVisibleRange(int first, int last);
+
+Q_SIGNALS:
+    // Any change of the rows' data, one connection for all rows.
+    void rowsDataChanged();
 
 protected:
     int nextAvailable(int i);
     int previousAvailable(int i);
 
+    int estimatedSize() const;
+    void rowInserted(int row);
+    void rowsRemoved(int row, int count);
+    void rowsCleared();
+    void rowChanged(int row);
+    int rowOf(QSpotifyTrack *track) const;
+
+private Q_SLOTS:
+    void onMetadataUpdated();
+    void onCurrentTrackChanged();
+    void onOfflineModeChanged();
+    void onStarredChanged(QVector<sp_track *> tracks);
+
 private:
     void playCurrentTrack();
+    QSpotifyTrack *createObject(int row);
+    void releaseObject(int row);
+    bool ownsRowHint(const QSpotifyTrack *track) const;
+    void watchSession();
+    void watchLazyRows();
+
     QHash<int, QByteArray> m_roles;
+    QSpotifyTrackRecords m_records;
+    bool m_watchingSession{};
+    bool m_watchingLazyRows{};
+    // Whose rows are shown as the current track
+    sp_track *m_currentTrack{};
+    // First visible row when objects were last released
+    int m_releasedAt{-1};
+    // Rows whose objects that pass kept, the next one only looks at these
+    int m_keptFrom{};
+    int m_keptTo{-1};
 
     friend class QSpotifyTrack;
     friend class QSpotifyPlaylist;
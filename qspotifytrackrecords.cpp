@@ -0,0 +1,306 @@
+#include "qspotifytrackrecords.h"
+
+#include <algorithm>
+
+#include "qspotifymetrics.h"
+#include "qspotifysession.h"
+#include "qspotifyuser.h"
+
+static QSpotifyMetrics::Gauge *rowsGauge()
+{
+    static QSpotifyMetrics::Gauge *g = QSpotifyMetrics::instance().gauge(QLatin1String("trackRecords.rows"));
+    return g;
+}
+
+static QSpotifyMetrics::Gauge *bytesGauge()
+{
+    static QSpotifyMetrics::Gauge *g = QSpotifyMetrics::instance().gauge(QLatin1String("trackRecords.bytes"));
+    return g;
+}
+
+static quint32 encodeError(int error)
+{
+    switch (error) {
+    case QSpotifyTrack::Ok: return 0;
+    case QSpotifyTrack::IsLoading: return 1;
+    default: return 2;
+    }
+}
+
+QSpotifyTrackRecords::~QSpotifyTrackRecords()
+{
+    clear();
+}
+
+void QSpotifyTrackRecords::reserve(int size)
+{
+    m_tracks.reserve(size);
+    m_name.reserve(size);
+    m_artists.reserve(size);
+    m_album.reserve(size);
+    m_albumCoverId.reserve(size);
+    m_creator.reserve(size);
+    m_duration.reserve(size);
+    m_creationDate.reserve(size);
+    m_flags.reserve(size);
+}
+
+void QSpotifyTrackRecords::insert(int row, sp_track *track)
+{
+    Q_ASSERT(track);
+    sp_track_add_ref(track);
+    Flags flags{};
+    flags.seen = true;
+    flags.error = encodeError(QSpotifyTrack::IsLoading);
+    if (auto user = QSpotifySession::instance()->user())
+        flags.starred = user->isStarred(track);
+    m_tracks.insert(row, track);
+    m_name.insert(row, QSpotifyInternedString());
+    m_artists.insert(row, QSpotifyInternedString());
+    m_album.insert(row, QSpotifyInternedString());
+    m_albumCoverId.insert(row, QSpotifyId());
+    m_creator.insert(row, QSpotifyInternedString());
+    m_duration.insert(row, 0);
+    m_creationDate.insert(row, 0);
+    m_flags.insert(row, flags);
+    updateBytes();
+}
+
+void QSpotifyTrackRecords::remove(int row, int count)
+{
+    for (int i = row; i < row + count; ++i) {
+        sp_track_release(m_tracks.at(i));
+        addTotals(m_flags.at(i), m_duration.at(i), -1);
+    }
+    m_tracks.remove(row, count);
+    m_name.remove(row, count);
+    m_artists.remove(row, count);
+    m_album.remove(row, count);
+    m_albumCoverId.remove(row, count);
+    m_creator.remove(row, count);
+    m_duration.remove(row, count);
+    m_creationDate.remove(row, count);
+    m_flags.remove(row, count);
+    updateBytes();
+    checkTotals();
+}
+
+void QSpotifyTrackRecords::clear()
+{
+    for (auto track : m_tracks)
+        sp_track_release(track);
+    m_tracks.clear();
+    m_name.clear();
+    m_artists.clear();
+    m_album.clear();
+    m_albumCoverId.clear();
+    m_creator.clear();
+    m_duration.clear();
+    m_creationDate.clear();
+    m_flags.clear();
+    m_totals = Totals();
+    updateBytes();
+}
+
+template <typename T>
+static void moveColumn(QVector<T> &column, int from, int count, int to)
+{
+    auto begin = column.begin();
+    if (to < from)
+        std::rotate(begin + to, begin + from, begin + from + count);
+    else
+        std::rotate(begin + from, begin + from + count, begin + to + count);
+}
+
+void QSpotifyTrackRecords::move(int from, int count, int to)
+{
+    Q_ASSERT(from >= 0 && to >= 0 && from + count <= this->count() && to + count <= this->count());
+    moveColumn(m_tracks, from, count, to);
+    moveColumn(m_name, from, count, to);
+    moveColumn(m_artists, from, count, to);
+    moveColumn(m_album, from, count, to);
+    moveColumn(m_albumCoverId, from, count, to);
+    moveColumn(m_creator, from, count, to);
+    moveColumn(m_duration, from, count, to);
+    moveColumn(m_creationDate, from, count, to);
+    moveColumn(m_flags, from, count, to);
+}
+
+bool QSpotifyTrackRecords::sameRow(const Row &a, const Row &b)
+{
+    return a.name == b.name && a.artists == b.artists && a.album == b.album
+            && a.albumCoverId == b.albumCoverId && a.creator == b.creator
+            && a.duration == b.duration && a.creationDate == b.creationDate
+            && a.flags.discNumber == b.flags.discNumber && a.flags.discIndex == b.flags.discIndex
+            && a.flags.popularity == b.flags.popularity && a.flags.error == b.flags.error
+            && a.flags.available == b.flags.available && a.flags.availableOffline == b.flags.availableOffline
+            && a.flags.seen == b.flags.seen && a.flags.complete == b.flags.complete
+            && a.flags.starred == b.flags.starred;
+}
+
+QSpotifyTrackRecords::Row QSpotifyTrackRecords::row(int row) const
+{
+    return Row{m_name.at(row), m_artists.at(row), m_album.at(row), m_albumCoverId.at(row),
+               m_creator.at(row), m_duration.at(row), m_creationDate.at(row), m_flags.at(row)};
+}
+
+bool QSpotifyTrackRecords::setRow(int row, const Row &r)
+{
+    if (sameRow(this->row(row), r))
+        return false;
+
+    addTotals(m_flags.at(row), m_duration.at(row), -1);
+    addTotals(r.flags, r.duration, 1);
+    m_name[row] = r.name;
+    m_artists[row] = r.artists;
+    m_album[row] = r.album;
+    m_albumCoverId[row] = r.albumCoverId;
+    m_creator[row] = r.creator;
+    m_duration[row] = r.duration;
+    m_creationDate[row] = r.creationDate;
+    m_flags[row] = r.flags;
+    updateBytes();
+    checkTotals();
+    return true;
+}
+
+bool QSpotifyTrackRecords::update(int row, const QSpotifyTrack *track)
+{
+    Q_ASSERT(track && track->sptrack() == m_tracks.at(row));
+
+    Row r;
+    r.name = QSpotifyInternedString(track->name());
+    r.artists = track->m_artistsString;
+    r.album = track->m_albumName;
+    r.albumCoverId = track->m_albumCoverId;
+    r.creator = QSpotifyInternedString(track->creator());
+    r.duration = track->duration();
+    r.creationDate = track->m_creationDate;
+    r.flags = Flags();
+    r.flags.discNumber = qBound(0, track->discNumber(), 63);
+    r.flags.discIndex = qBound(0, track->discIndex(), 1023);
+    r.flags.popularity = qBound(0, track->popularity(), 100);
+    r.flags.error = encodeError(track->error());
+    r.flags.available = track->m_isAvailable;
+    r.flags.availableOffline = track->isAvailableOffline();
+    r.flags.seen = track->seen();
+    r.flags.complete = track->error() == QSpotifyTrack::Ok && track->m_artistsLoaded && track->m_albumLoaded;
+    r.flags.starred = track->isStarred();
+    return setRow(row, r);
+}
+
+bool QSpotifyTrackRecords::setStarred(int row, bool starred)
+{
+    Flags &flags = m_flags[row];
+    if (flags.starred == starred)
+        return false;
+    flags.starred = starred;
+    return true;
+}
+
+bool QSpotifyTrackRecords::update(int row)
+{
+    sp_track *track = m_tracks.at(row);
+    Row r = this->row(row);
+
+    int error = sp_track_error(track);
+    r.flags.error = encodeError(error);
+    if (error != SP_ERROR_OK)
+        return setRow(row, r);
+
+    bool complete;
+    r.name = QSpotifyInternedString(sp_track_name(track));
+    r.artists = QSpotifyInternedString(QSpotifyTrack::artistNames(track, &complete));
+
+    sp_album *album = sp_track_album(track);
+    if (album && sp_album_is_loaded(album)) {
+        r.album = QSpotifyInternedString(sp_album_name(album));
+        if (!r.albumCoverId.isValid())
+            r.albumCoverId = QSpotifyId::fromImageId(sp_album_cover(album, SP_IMAGE_SIZE_NORMAL));
+    } else {
+        complete = false;
+    }
+
+    r.duration = sp_track_duration(track);
+    r.flags.discNumber = qBound(0, sp_track_disc(track), 63);
+    r.flags.discIndex = qBound(0, sp_track_index(track), 1023);
+    r.flags.popularity = qBound(0, sp_track_popularity(track), 100);
+    r.flags.available = sp_track_get_availability(QSpotifySession::instance()->spsession(), track) == SP_TRACK_AVAILABILITY_AVAILABLE;
+    int offline = sp_track_offline_get_status(track);
+    r.flags.availableOffline = offline == SP_TRACK_OFFLINE_DONE || offline == SP_TRACK_OFFLINE_DONE_RESYNC;
+    r.flags.complete = complete;
+    return setRow(row, r);
+}
+
+QSpotifyTrack::TrackError QSpotifyTrackRecords::error(int row) const
+{
+    switch (m_flags.at(row).error) {
+    case 0: return QSpotifyTrack::Ok;
+    case 1: return QSpotifyTrack::IsLoading;
+    default: return QSpotifyTrack::OtherPermanent;
+    }
+}
+
+bool QSpotifyTrackRecords::isAvailable(int row) const
+{
+    const Flags &f = m_flags.at(row);
+    return f.available && (!QSpotifySession::instance()->offlineMode() || f.availableOffline);
+}
+
+void QSpotifyTrackRecords::addTotals(const Flags &flags, qint32 duration, int sign)
+{
+    // Starred rows can change without setRow(), the totals don't count them
+    bool playable = flags.error == encodeError(QSpotifyTrack::Ok);
+    m_totals.playable += sign * playable;
+    m_totals.unseen += sign * (playable && !flags.seen);
+    m_totals.available += sign * flags.available;
+    m_totals.availableOffline += sign * flags.availableOffline;
+    m_totals.duration += sign * duration;
+}
+
+void QSpotifyTrackRecords::checkTotals() const
+{
+#ifdef QSPOTIFY_CHECK_TOTALS
+    Totals check{};
+    for (int i = 0; i < count(); ++i) {
+        const Flags &f = m_flags.at(i);
+        bool playable = f.error == encodeError(QSpotifyTrack::Ok);
+        check.playable += playable;
+        check.unseen += playable && !f.seen;
+        check.available += f.available;
+        check.availableOffline += f.availableOffline;
+        check.duration += m_duration.at(i);
+    }
+    Q_ASSERT_X(check.playable == m_totals.playable && check.unseen == m_totals.unseen
+               && check.available == m_totals.available && check.availableOffline == m_totals.availableOffline
+               && check.duration == m_totals.duration,
+               "QSpotifyTrackRecords::checkTotals", "totals out of sync with the rows");
+#endif
+}
+
+qint64 QSpotifyTrackRecords::bytes() const
+{
+    const int perRow = sizeof(sp_track *) + 4 * sizeof(QSpotifyInternedString) + sizeof(QSpotifyId) + sizeof(qint32)
+            + sizeof(quint32) + sizeof(Flags);
+    return qint64(m_tracks.capacity()) * perRow;
+}
+
+void QSpotifyTrackRecords::updateBytes()
+{
+    qint64 b = bytes();
+    rowsGauge()->add(count() - m_reportedRows);
+    bytesGauge()->add(int(b - m_reportedBytes));
+    m_reportedRows = count();
+    m_reportedBytes = b;
+}
+
+QVariantMap QSpotifyTrackRecords::statistics()
+{
+    int rows = rowsGauge()->value();
+    int bytes = bytesGauge()->value();
+    QVariantMap map;
+    map.insert(QLatin1String("rows"), rows);
+    map.insert(QLatin1String("bytes"), bytes);
+    map.insert(QLatin1String("bytesPerTrack"), rows ? bytes / rows : 0);
+    return map;
+}
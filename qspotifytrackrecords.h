@@ -0,0 +1,137 @@
+#ifndef QSPOTIFYTRACKRECORDS_H
+#define QSPOTIFYTRACKRECORDS_H
+
+#include <QtCore/QString>
+#include <QtCore/QVariantMap>
+#include <QtCore/QVector>
+
+#include <libspotify/api.h>
+
+#include "qspotifyid.h"
+#include "qspotifystringpool.h"
+#include "qspotifytrack.h"
+
+/**
+ * Column store with the data QSpotifyTrackList shows for each row, so the
+ * model can answer data() without a QSpotifyTrack object per row.
+ *
+ * Names are interned strings shared with the rest of the library, numbers
+ * and flags are packed into a few columns. Every row holds a reference on its
+ * sp_track. Rows are filled either from a QSpotifyTrack or directly from
+ * libspotify for rows that have no object yet.
+ *
+ * Must only be used from the GUI thread.
+ */
+class QSpotifyTrackRecords
+{
+public:
+    QSpotifyTrackRecords() = default;
+    ~QSpotifyTrackRecords();
+
+    int count() const { return m_tracks.count(); }
+    void reserve(int size);
+
+    void insert(int row, sp_track *track);
+    void remove(int row, int count = 1);
+    void clear();
+    // Moves count rows from row from so the first ends up at row to.
+    void move(int from, int count, int to);
+
+    // Return true if the row changed.
+    bool update(int row, const QSpotifyTrack *track);
+    bool update(int row);
+    // False while libspotify is still loading the track or its album.
+    bool isComplete(int row) const { return m_flags.at(row).complete; }
+
+    sp_track *track(int row) const { return m_tracks.at(row); }
+    int indexOf(const sp_track *track, int from = 0) const { return m_tracks.indexOf(const_cast<sp_track *>(track), from); }
+
+    QString name(int row) const { return m_name.at(row).toString(); }
+    QString artists(int row) const { return m_artists.at(row).toString(); }
+    QString album(int row) const { return m_album.at(row).toString(); }
+    QString albumCoverId(int row) const { return m_albumCoverId.at(row).toString(); }
+    QString creator(int row) const { return m_creator.at(row).toString(); }
+    int duration(int row) const { return m_duration.at(row); }
+    uint creationDate(int row) const { return m_creationDate.at(row); }
+    int discNumber(int row) const { return m_flags.at(row).discNumber; }
+    int discIndex(int row) const { return m_flags.at(row).discIndex; }
+    int popularity(int row) const { return m_flags.at(row).popularity; }
+    QSpotifyTrack::TrackError error(int row) const;
+    // Takes the session's offline mode into account, like QSpotifyTrack.
+    bool isAvailable(int row) const;
+    // True if isAvailable() changes with the offline mode.
+    bool dependsOnOfflineMode(int row) const { return m_flags.at(row).available && !m_flags.at(row).availableOffline; }
+    bool seen(int row) const { return m_flags.at(row).seen; }
+    bool isStarred(int row) const { return m_flags.at(row).starred; }
+    // Returns true if the row changed.
+    bool setStarred(int row, bool starred);
+
+    // Kept up to date with every change of the rows.
+    struct Totals {
+        int playable;          // rows without error
+        int unseen;            // playable rows not seen yet
+        int available;
+        int availableOffline;
+        qint64 duration;
+    };
+    const Totals &totals() const { return m_totals; }
+
+    qint64 bytes() const;
+
+    // Rows and bytes of all stores without the shared strings, compared to
+    // the estimated size of a QSpotifyTrack object.
+    static QVariantMap statistics();
+
+private:
+    struct Flags {
+        quint32 discNumber : 6;
+        quint32 discIndex : 10;
+        quint32 popularity : 7;
+        quint32 error : 2;
+        quint32 available : 1;
+        quint32 availableOffline : 1;
+        quint32 seen : 1;
+        quint32 complete : 1;
+        quint32 starred : 1;
+    };
+
+    struct Row {
+        QSpotifyInternedString name;
+        QSpotifyInternedString artists;
+        QSpotifyInternedString album;
+        QSpotifyId albumCoverId;
+        QSpotifyInternedString creator;
+        qint32 duration;
+        quint32 creationDate;
+        Flags flags;
+    };
+
+    static bool sameRow(const Row &a, const Row &b);
+    void addTotals(const Flags &flags, qint32 duration, int sign);
+    // Recounts the totals after every change and asserts they match. O(N)
+    // per change, so only with QSPOTIFY_CHECK_TOTALS defined.
+    void checkTotals() const;
+    Row row(int row) const;
+    bool setRow(int row, const Row &r);
+
+    void updateBytes();
+
+    QVector<sp_track *> m_tracks;
+    QVector<QSpotifyInternedString> m_name;
+    QVector<QSpotifyInternedString> m_artists;
+    QVector<QSpotifyInternedString> m_album;
+    QVector<QSpotifyId> m_albumCoverId;
+    QVector<QSpotifyInternedString> m_creator;
+    QVector<qint32> m_duration;
+    QVector<quint32> m_creationDate;
+    QVector<Flags> m_flags;
+
+    Totals m_totals{};
+
+    int m_reportedRows{};
+    qint64 m_reportedBytes{};
+
+    Q_DISABLE_COPY(QSpotifyTrackRecords)
+};
+
+#endif // QSPOTIFYTRACKRECORDS_H
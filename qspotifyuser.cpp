@@ -41,12 +41,14 @@
 
 #include "qspotifyuser.h"
 
+#include <QtCore/QUrl>
 #include <QtQml/QQmlEngine>
 
 #include <libspotify/api.h>
 
 #include "qspotifyalbumbrowse.h"
 #include "qspotifyalbum.h"
+#include "qspotifycachemanager.h"
 #include "qspotifyplaylistcontainer.h"
 #include "qspotifyplaylist.h"
 #include "qspotifysession.h"
@@ -112,6 +114,12 @@ QSpotifyPlaylistContainer *QSpotifyUser::playlistContainer() const
             pc = sp_session_publishedcontainer_for_user_create(QSpotifySession::instance()->m_sp_session, m_canonicalName.toUtf8().constData());
         }
         m_playlistContainer = new QSpotifyPlaylistContainer(pc);
+        QString dataPath = QString::fromLatin1(QSpotifySession::instance()->dataPath);
+        if (QSpotifySession::instance()->user() == this && !dataPath.isEmpty()) {
+            // One per user, shown while the container loads
+            QString name = QString::fromLatin1(QUrl::toPercentEncoding(m_canonicalName));
+            m_playlistContainer->loadSnapshot(dataPath + QLatin1String("/playlists-") + name + QLatin1String(".qsps"));
+        }
         m_playlistContainer->init();
         connect(m_playlistContainer, SIGNAL(playlistContainerDataChanged()), this, SIGNAL(playlistsChanged()));
         connect(m_playlistContainer, SIGNAL(playlistsNameChanged()), this, SIGNAL(playlistsNameChanged()));
@@ -129,12 +137,65 @@ QSpotifyPlaylist *QSpotifyUser::starredList() const
             sl = sp_session_starred_for_user_create(QSpotifySession::instance()->m_sp_session, m_canonicalName.toUtf8().constData());
         }
         m_starredList = new QSpotifyPlaylist(QSpotifyPlaylist::Starred, sl, false);
+        connect(m_starredList, SIGNAL(tracksAdded(QVector<sp_track*>)), this, SLOT(onStarredTracksAdded(QVector<sp_track*>)));
+        connect(m_starredList, SIGNAL(tracksRemoved(QVector<sp_track*>)), this, SLOT(onStarredTracksRemoved(QVector<sp_track*>)));
+        connect(m_starredList, SIGNAL(isLoadedChanged()), this, SLOT(onStarredListLoaded()));
         m_starredList->init();
         QQmlEngine::setObjectOwnership(m_starredList, QQmlEngine::CppOwnership);
     }
     return m_starredList;
 }
 
+bool QSpotifyUser::isStarred(sp_track *track) const
+{
+    if (!m_starredIndexReady) {
+        // Changes are only dispatched once the starred list exists
+        starredList();
+        return sp_track_is_starred(QSpotifySession::instance()->m_sp_session, track);
+    }
+    return m_starredTracks.contains(track);
+}
+
+void QSpotifyUser::onStarredTracksAdded(QVector<sp_track *> tracks)
+{
+    m_starredIndexReady = true;
+    for (auto track : tracks)
+        m_starredTracks.insert(track);
+    dispatchStarredChange(tracks);
+}
+
+void QSpotifyUser::onStarredTracksRemoved(QVector<sp_track *> tracks)
+{
+    for (auto track : tracks)
+        m_starredTracks.remove(track);
+    dispatchStarredChange(tracks);
+}
+
+void QSpotifyUser::onStarredListLoaded()
+{
+    // An empty list never emits tracksAdded()
+    if (m_starredList->isLoaded() && sp_playlist_num_tracks(m_starredList->m_sp_playlist) == 0)
+        m_starredIndexReady = true;
+}
+
+void QSpotifyUser::dispatchStarredChange(const QVector<sp_track *> &tracks)
+{
+    // Starred state is per session user, other users' lists only keep a copy
+    if (QSpotifySession::instance()->user() != this)
+        return;
+    for (auto track : tracks) {
+        // libspotify has the last word, e.g. for tracks starred twice
+        bool starred = sp_track_is_starred(QSpotifySession::instance()->m_sp_session, track);
+        if (starred)
+            m_starredTracks.insert(track);
+        else
+            m_starredTracks.remove(track);
+        if (auto qtrack = QSpotifyCacheManager::instance().findTrack(track))
+            qtrack->updateStarred(starred);
+    }
+    emit starredTracksChanged(tracks);
+}
+
 QSpotifyPlaylist *QSpotifyUser::inbox() const
 {
     if (QSpotifySession::instance()->user() != this)
@@ -171,6 +232,21 @@ QList<QObject*> QSpotifyUser::playlistsFlat() const
     return playlistContainer()->playlistsFlat();
 }
 
+QSpotifyPlaylistTreeModel *QSpotifyUser::playlistModel() const
+{
+    return playlistContainer()->treeModel();
+}
+
+QSpotifyPlaylistFlatModel *QSpotifyUser::playlistFlatModel() const
+{
+    return playlistContainer()->flatModel();
+}
+
+QSpotifyPlaylistFilterModel *QSpotifyUser::availablePlaylistModel() const
+{
+    return playlistContainer()->availableModel();
+}
+
 bool QSpotifyUser::createPlaylist(const QString &name)
 {
     if (name.trimmed().isEmpty())
@@ -42,13 +42,20 @@
 #ifndef QSPOTIFYUSER_H
 #define QSPOTIFYUSER_H
 
+#include <QtCore/QSet>
+#include <QtCore/QVector>
+
 #include "qspotifyobject.h"
+#include "listmodels/qspotifyplaylistfiltermodel.h"
+#include "listmodels/qspotifyplaylistflatmodel.h"
+#include "listmodels/qspotifyplaylisttreemodel.h"
 
 class QSpotifyAlbumBrowse;
 class QSpotifyPlaylist;
 class QSpotifyPlaylistContainer;
 class QSpotifyTrack;
 
+struct sp_track;
 struct sp_user;
 
 class QSpotifyUser : public QSpotifyObject
@@ -58,6 +65,9 @@ class QSpotifyUser : public QSpotifyObject
     Q_PROPERTY(QString displayName READ displayName NOTIFY userDataChanged)
     Q_PROPERTY(QList<QObject *> playlists READ playlistsAsQObject NOTIFY playlistsChanged)
     Q_PROPERTY(QList<QObject *> playlistsFlat READ playlistsFlat NOTIFY playlistsChanged)
+    Q_PROPERTY(QSpotifyPlaylistTreeModel *playlistModel READ playlistModel CONSTANT)
+    Q_PROPERTY(QSpotifyPlaylistFlatModel *playlistFlatModel READ playlistFlatModel CONSTANT)
+    Q_PROPERTY(QSpotifyPlaylistFilterModel *availablePlaylistModel READ availablePlaylistModel CONSTANT)
 public:
     // Destroy the user before you log out !
     ~QSpotifyUser();
@@ -74,6 +84,9 @@ public:
     QList<QSpotifyPlaylist *> playlists() const;
     QList<QObject *> playlistsAsQObject() const;
     QList<QObject *> playlistsFlat() const;
+    QSpotifyPlaylistTreeModel *playlistModel() const;
+    QSpotifyPlaylistFlatModel *playlistFlatModel() const;
+    QSpotifyPlaylistFilterModel *availablePlaylistModel() const;
 
     Q_INVOKABLE bool createPlaylist(const QString &name);
     Q_INVOKABLE bool createPlaylistInFolder(const QString &name, QSpotifyPlaylist *folder);
@@ -85,10 +98,21 @@ public:
 
     void deleteFolderAndContent(QSpotifyPlaylist *playlist);
 
+    // Answered from a hash of the starred list once it is populated or
+    // loaded empty, from libspotify before that. GUI thread only.
+    bool isStarred(sp_track *track) const;
+
 Q_SIGNALS:
     void userDataChanged();
     void playlistsChanged();
     void playlistsNameChanged();
+    // After the QSpotifyTrack objects of these tracks have been updated.
+    void starredTracksChanged(QVector<sp_track *> tracks);
+
+private Q_SLOTS:
+    void onStarredTracksAdded(QVector<sp_track *> tracks);
+    void onStarredTracksRemoved(QVector<sp_track *> tracks);
+    void onStarredListLoaded();
 
 protected:
     bool updateData();
@@ -96,6 +120,8 @@ protected:
 private:
     QSpotifyUser(sp_user *user);
 
+    void dispatchStarredChange(const QVector<sp_track *> &tracks);
+
     sp_user *m_sp_user;
 
     QString m_canonicalName;
@@ -105,6 +131,9 @@ private:
     mutable QSpotifyPlaylist *m_starredList{};
     mutable QSpotifyPlaylist *m_inbox{};
 
+    QSet<sp_track *> m_starredTracks;
+    bool m_starredIndexReady{};
+
     friend class QSpotifySession;
     friend class QSpotifyPlaylist;
 };
@@ -1,5 +1,6 @@
 #include "qspotifyutil.h"
 
+#include <QtCore/QByteArray>
 #include <QtCore/QString>
 #include <QtCore/QDebug>
 
@@ -22,3 +23,15 @@ void QSpotifyUtil::spLinkToQString(sp_link *link, std::function<void(const QStri
         sp_link_release(link);
     }
 }
+
+QByteArray QSpotifyUtil::spLinkToByteArray(sp_link *link)
+{
+    QByteArray uri;
+    if (link) {
+        char buffer[200];
+        int uriSize = sp_link_as_string(link, &buffer[0], sizeof(buffer));
+        uri = QByteArray(&buffer[0], qMin<int>(uriSize, sizeof(buffer) - 1));
+        sp_link_release(link);
+    }
+    return uri;
+}
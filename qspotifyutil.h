@@ -3,6 +3,7 @@
 
 #include <functional>
 
+class QByteArray;
 class QString;
 struct sp_link;
 
@@ -11,6 +12,8 @@ class QSpotifyUtil
 public:
     QSpotifyUtil();
     static void spLinkToQString(sp_link *link, std::function<void(const QString&)> consumer);
+    // Releases the link, returns an empty array if it is null.
+    static QByteArray spLinkToByteArray(sp_link *link);
 };
 
 #endif // QSPOTIFYUTIL_H
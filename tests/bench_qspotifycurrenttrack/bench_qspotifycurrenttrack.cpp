@@ -0,0 +1,118 @@
+#include <QtTest/QtTest>
+
+#include <libspotify/api.h>
+
+#include "fakespotify.h"
+#include "qspotifycachemanager.h"
+#include "qspotifysession.h"
+#include "qspotifytrack.h"
+#include "qspotifytracklist.h"
+
+namespace {
+
+const int LiveTracks = 50000;
+
+sp_track *handle(int index)
+{
+    return static_cast<sp_track *>(fakespotify_handle(index));
+}
+
+}
+
+// Cost of a track change and of toggling offline mode with 50k live
+// tracks, either held directly or as rows of track lists.
+class bench_QSpotifyCurrentTrack : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void trackChange_data();
+    void trackChange();
+    void offlineMode_data() { trackChange_data(); }
+    void offlineMode();
+
+private:
+    void populate(int lists);
+
+    QList<QSpotifyTrack *> m_tracks;
+    QList<QSpotifyTrackList *> m_lists;
+};
+
+void bench_QSpotifyCurrentTrack::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QVERIFY(QSpotifySession::instance()->isValid());
+}
+
+void bench_QSpotifyCurrentTrack::trackChange_data()
+{
+    QTest::addColumn<int>("lists");
+
+    QTest::newRow("tracks") << 0;
+    QTest::newRow("5 lists of 10k rows") << 5;
+}
+
+void bench_QSpotifyCurrentTrack::init()
+{
+    QFETCH(int, lists);
+    populate(lists);
+}
+
+void bench_QSpotifyCurrentTrack::populate(int lists)
+{
+    QSpotifyCacheManager &cache = QSpotifyCacheManager::instance();
+    for (int i = 0; i < LiveTracks; ++i)
+        m_tracks.append(cache.getTrack(handle(i)));
+
+    // Lists share the same tracks, with every row materialized
+    for (int l = 0; l < lists; ++l) {
+        auto list = new QSpotifyTrackList;
+        QVector<sp_track *> rows;
+        int size = LiveTracks / lists;
+        for (int i = 0; i < size; ++i)
+            rows.append(handle(l * size + i));
+        list->insertTracks(0, rows);
+        for (int i = 0; i < size; ++i)
+            list->at(i);
+        m_lists.append(list);
+    }
+}
+
+void bench_QSpotifyCurrentTrack::cleanup()
+{
+    QSpotifySession::instance()->stop();
+    QSpotifySession::instance()->setOfflineMode(false);
+    qDeleteAll(m_lists);
+    m_lists.clear();
+    for (QSpotifyTrack *track : m_tracks)
+        track->release();
+    m_tracks.clear();
+    QSpotifyCacheManager::instance().clearRetained();
+    QCoreApplication::processEvents();
+}
+
+void bench_QSpotifyCurrentTrack::trackChange()
+{
+    QSpotifySession *session = QSpotifySession::instance();
+    int i = 0;
+    QBENCHMARK {
+        session->play(m_tracks.at(i));
+        i = (i + 7919) % LiveTracks;
+    }
+    QVERIFY(session->currentTrack());
+}
+
+void bench_QSpotifyCurrentTrack::offlineMode()
+{
+    QSpotifySession *session = QSpotifySession::instance();
+    session->play(m_tracks.first());
+    QBENCHMARK {
+        session->setOfflineMode(!session->offlineMode());
+    }
+}
+
+QTEST_MAIN(bench_QSpotifyCurrentTrack)
+
+#include "bench_qspotifycurrenttrack.moc"
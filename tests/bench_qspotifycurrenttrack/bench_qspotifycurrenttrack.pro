@@ -0,0 +1,6 @@
+TARGET = bench_qspotifycurrenttrack
+
+include(../shared/shared.pri)
+CONFIG -= testcase
+
+SOURCES += bench_qspotifycurrenttrack.cpp
@@ -0,0 +1,113 @@
+#include <QtTest/QtTest>
+
+#include <libspotify/api.h>
+
+#include "fakespotify.h"
+#include "qspotifycachemanager.h"
+#include "qspotifyevents.h"
+#include "qspotifyobjectpool.h"
+#include "qspotifysession.h"
+#include "qspotifytrack.h"
+
+namespace {
+
+const int PlaylistSize = 10000;
+
+void destroyPending()
+{
+    QCoreApplication::sendPostedEvents(QSpotifySession::instance(), DestroyObjectsEventType);
+}
+
+}
+
+class bench_QSpotifyObjectPool : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void allocate_data();
+    void allocate();
+    void reload();
+};
+
+void bench_QSpotifyObjectPool::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QVERIFY(QSpotifySession::instance()->isValid());
+}
+
+void bench_QSpotifyObjectPool::allocate_data()
+{
+    QTest::addColumn<bool>("pool");
+
+    QTest::newRow("heap") << false;
+    QTest::newRow("pool") << true;
+}
+
+// One iteration allocates and frees PlaylistSize track sized blocks.
+void bench_QSpotifyObjectPool::allocate()
+{
+    QFETCH(bool, pool);
+
+    QVector<void *> blocks(PlaylistSize);
+    QBENCHMARK {
+        for (int i = 0; i < PlaylistSize; ++i) {
+            blocks[i] = pool ? QSpotifyObjectPool<QSpotifyTrack>::allocate(sizeof(QSpotifyTrack))
+                             : ::operator new(sizeof(QSpotifyTrack));
+        }
+        for (int i = 0; i < PlaylistSize; ++i) {
+            if (pool)
+                QSpotifyObjectPool<QSpotifyTrack>::deallocate(blocks[i], sizeof(QSpotifyTrack));
+            else
+                ::operator delete(blocks[i]);
+        }
+    }
+}
+
+// Loads the tracks of a different 10k track playlist per round and keeps
+// every 100th, like views and the play queue do, then reports how much of
+// the pool is unused.
+void bench_QSpotifyObjectPool::reload()
+{
+    typedef QSpotifyObjectPool<QSpotifyTrack> Pool;
+    QSpotifyCacheManager &cache = QSpotifyCacheManager::instance();
+    cache.setRetentionLimits(0, 0);
+
+    QList<QSpotifyTrack *> kept;
+    QBENCHMARK_ONCE {
+        for (int round = 0; round < 20; ++round) {
+            QList<QSpotifyTrack *> tracks;
+            tracks.reserve(PlaylistSize);
+            for (int i = 0; i < PlaylistSize; ++i) {
+                auto t = static_cast<sp_track *>(fakespotify_handle(round * PlaylistSize + i));
+                tracks.append(cache.getTrack(t));
+            }
+            for (int i = 0; i < PlaylistSize; i += 100) {
+                tracks.at(i)->addRef();
+                kept.append(tracks.at(i));
+            }
+            for (QSpotifyTrack *track : tracks)
+                track->release();
+            destroyPending();
+
+            Pool::Stats stats = Pool::stats();
+            qDebug("round %2d: %6d live, %3d chunks, fragmentation %.2f",
+                   round, stats.live, stats.chunks, stats.fragmentation);
+            // Freed slots are reused before the pool grows
+            QVERIFY(stats.chunks * Pool::ChunkSize < stats.peak + Pool::ChunkSize);
+        }
+    }
+
+    for (QSpotifyTrack *track : kept)
+        track->release();
+    destroyPending();
+    QCOMPARE(Pool::stats().live, 0);
+    QCOMPARE(Pool::stats().chunks, 0);
+
+    cache.setRetentionLimits(QSpotifyCacheManager::DefaultMaxRetained,
+                             QSpotifyCacheManager::DefaultMaxRetainedBytes);
+}
+
+QTEST_MAIN(bench_QSpotifyObjectPool)
+
+#include "bench_qspotifyobjectpool.moc"
@@ -0,0 +1,6 @@
+TARGET = bench_qspotifyobjectpool
+
+include(../shared/shared.pri)
+CONFIG -= testcase
+
+SOURCES += bench_qspotifyobjectpool.cpp
@@ -0,0 +1,82 @@
+#include <QtTest/QtTest>
+
+#include <libspotify/api.h>
+
+#include "fakespotify.h"
+#include "qspotifyevents.h"
+#include "qspotifyplaylist.h"
+#include "qspotifysession.h"
+#include "qspotifytracklist.h"
+
+namespace {
+
+const int StarredSize = 10000;
+
+}
+
+class bench_QSpotifyPlaylistLoad : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void starred();
+    void insert_data();
+    void insert();
+};
+
+void bench_QSpotifyPlaylistLoad::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QVERIFY(QSpotifySession::instance()->isValid());
+    fakespotify_playlist_tracks = StarredSize;
+}
+
+// Loading a 10k track starred list, from the playlist's first
+// updateData() to the populated track list.
+void bench_QSpotifyPlaylistLoad::starred()
+{
+    auto sp = static_cast<sp_playlist *>(fakespotify_handle(0));
+    QBENCHMARK {
+        auto playlist = new QSpotifyPlaylist(QSpotifyPlaylist::Starred, sp, false);
+        playlist->init();
+        QCOMPARE(playlist->tracks()->count(), StarredSize);
+        playlist->release();
+        // The playlist is deleted later, its tracks in the next batch
+        QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+        QCoreApplication::sendPostedEvents(QSpotifySession::instance(), DestroyObjectsEventType);
+    }
+}
+
+void bench_QSpotifyPlaylistLoad::insert_data()
+{
+    QTest::addColumn<bool>("batch");
+
+    // Inserting every track at row 0 is what starred lists used to do
+    QTest::newRow("row by row at 0") << false;
+    QTest::newRow("one insert") << true;
+}
+
+// Only the track list part of the load, newest track first.
+void bench_QSpotifyPlaylistLoad::insert()
+{
+    QFETCH(bool, batch);
+
+    QVector<sp_track *> tracks;
+    for (int i = 0; i < StarredSize; ++i)
+        tracks.append(static_cast<sp_track *>(fakespotify_handle(i)));
+
+    QBENCHMARK {
+        QSpotifyTrackList list;
+        if (batch) {
+            list.insertTracks(0, QVector<sp_track *>(tracks.crbegin(), tracks.crend()));
+        } else {
+            for (sp_track *track : tracks)
+                list.insertTracks(0, QVector<sp_track *>() << track);
+        }
+        QCOMPARE(list.count(), StarredSize);
+    }
+}
+
+QTEST_MAIN(bench_QSpotifyPlaylistLoad)
+
+#include "bench_qspotifyplaylistload.moc"
@@ -0,0 +1,6 @@
+TARGET = bench_qspotifyplaylistload
+
+include(../shared/shared.pri)
+CONFIG -= testcase
+
+SOURCES += bench_qspotifyplaylistload.cpp
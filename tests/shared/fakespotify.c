@@ -0,0 +1,225 @@
+#include "fakespotify.h"
+
+#include <stdio.h>
+
+/*
+ * Link time stand-in for libspotify. Deliberately does not include
+ * libspotify/api.h: everything not defined explicitly below returns zero,
+ * i.e. SP_ERROR_OK, false, 0 or a null pointer.
+ */
+
+#define FAKE(name) void *name() { return 0; }
+
+int fakespotify_playlist_tracks = 0;
+
+static int g_session;
+
+int sp_session_create(const void *config, void **session)
+{
+    (void)config;
+    *session = &g_session;
+    return 0;
+}
+
+int sp_session_process_events(void *session, int *next_timeout)
+{
+    (void)session;
+    *next_timeout = 1000;
+    return 0;
+}
+
+const char *sp_error_message(int error)
+{
+    (void)error;
+    return "";
+}
+
+/* SP_TRACK_AVAILABILITY_AVAILABLE, so that tracks can be played */
+int sp_track_get_availability(void *session, void *track)
+{
+    (void)session;
+    (void)track;
+    return 1;
+}
+
+int sp_playlist_num_tracks(void *playlist)
+{
+    (void)playlist;
+    return fakespotify_playlist_tracks;
+}
+
+void *sp_playlist_track(void *playlist, int index)
+{
+    (void)playlist;
+    return fakespotify_handle(index);
+}
+
+/* Playlists are their own link, so that each has a distinct URI */
+void *sp_link_create_from_playlist(void *playlist)
+{
+    return playlist;
+}
+
+int sp_link_as_string(void *link, char *buffer, int buffer_size)
+{
+    return snprintf(buffer, buffer_size, "spotify:fake:%lx", (unsigned long)(uintptr_t)link);
+}
+
+const void *fakespotify_playlist_callbacks = 0;
+void *fakespotify_playlist_userdata = 0;
+
+int sp_playlist_add_callbacks(void *playlist, const void *callbacks, void *userdata)
+{
+    (void)playlist;
+    fakespotify_playlist_callbacks = callbacks;
+    fakespotify_playlist_userdata = userdata;
+    return 0;
+}
+
+FAKE(sp_album_add_ref)
+FAKE(sp_album_artist)
+FAKE(sp_album_cover)
+FAKE(sp_album_is_available)
+FAKE(sp_album_is_loaded)
+FAKE(sp_album_name)
+FAKE(sp_album_release)
+FAKE(sp_album_type)
+FAKE(sp_album_year)
+FAKE(sp_albumbrowse_create)
+FAKE(sp_albumbrowse_error)
+FAKE(sp_albumbrowse_num_tracks)
+FAKE(sp_albumbrowse_release)
+FAKE(sp_albumbrowse_review)
+FAKE(sp_albumbrowse_track)
+FAKE(sp_artist_add_ref)
+FAKE(sp_artist_is_loaded)
+FAKE(sp_artist_name)
+FAKE(sp_artist_portrait)
+FAKE(sp_artist_release)
+FAKE(sp_artistbrowse_album)
+FAKE(sp_artistbrowse_biography)
+FAKE(sp_artistbrowse_create)
+FAKE(sp_artistbrowse_error)
+FAKE(sp_artistbrowse_num_albums)
+FAKE(sp_artistbrowse_num_portraits)
+FAKE(sp_artistbrowse_num_similar_artists)
+FAKE(sp_artistbrowse_release)
+FAKE(sp_artistbrowse_similar_artist)
+FAKE(sp_image_add_load_callback)
+FAKE(sp_image_create)
+FAKE(sp_image_create_from_link)
+FAKE(sp_image_data)
+FAKE(sp_image_error)
+FAKE(sp_image_release)
+FAKE(sp_image_remove_load_callback)
+FAKE(sp_link_as_track)
+FAKE(sp_link_create_from_album)
+FAKE(sp_link_create_from_artist)
+FAKE(sp_link_create_from_artistbrowse_portrait)
+FAKE(sp_link_create_from_string)
+FAKE(sp_link_create_from_track)
+FAKE(sp_link_release)
+FAKE(sp_link_type)
+FAKE(sp_playlist_add_ref)
+FAKE(sp_playlist_add_tracks)
+FAKE(sp_playlist_get_description)
+FAKE(sp_playlist_get_image)
+FAKE(sp_playlist_get_offline_download_completed)
+FAKE(sp_playlist_get_offline_status)
+FAKE(sp_playlist_is_collaborative)
+FAKE(sp_playlist_is_loaded)
+FAKE(sp_playlist_name)
+FAKE(sp_playlist_owner)
+FAKE(sp_playlist_release)
+FAKE(sp_playlist_remove_callbacks)
+FAKE(sp_playlist_remove_tracks)
+FAKE(sp_playlist_rename)
+FAKE(sp_playlist_set_collaborative)
+FAKE(sp_playlist_set_offline_mode)
+FAKE(sp_playlist_track_create_time)
+FAKE(sp_playlist_track_creator)
+FAKE(sp_playlist_track_seen)
+FAKE(sp_playlist_track_set_seen)
+FAKE(sp_playlistcontainer_add_callbacks)
+FAKE(sp_playlistcontainer_add_new_playlist)
+FAKE(sp_playlistcontainer_add_ref)
+FAKE(sp_playlistcontainer_is_loaded)
+FAKE(sp_playlistcontainer_move_playlist)
+FAKE(sp_playlistcontainer_num_playlists)
+FAKE(sp_playlistcontainer_playlist)
+FAKE(sp_playlistcontainer_playlist_folder_id)
+FAKE(sp_playlistcontainer_playlist_folder_name)
+FAKE(sp_playlistcontainer_playlist_type)
+FAKE(sp_playlistcontainer_release)
+FAKE(sp_playlistcontainer_remove_callbacks)
+FAKE(sp_playlistcontainer_remove_playlist)
+FAKE(sp_search_album)
+FAKE(sp_search_artist)
+FAKE(sp_search_create)
+FAKE(sp_search_did_you_mean)
+FAKE(sp_search_error)
+FAKE(sp_search_num_albums)
+FAKE(sp_search_num_artists)
+FAKE(sp_search_num_playlists)
+FAKE(sp_search_num_tracks)
+FAKE(sp_search_playlist)
+FAKE(sp_search_playlist_name)
+FAKE(sp_search_release)
+FAKE(sp_search_track)
+FAKE(sp_search_type)
+FAKE(sp_session_connectionstate)
+FAKE(sp_session_forget_me)
+FAKE(sp_session_inbox_create)
+FAKE(sp_session_is_private_session)
+FAKE(sp_session_login)
+FAKE(sp_session_logout)
+FAKE(sp_session_player_load)
+FAKE(sp_session_player_play)
+FAKE(sp_session_player_seek)
+FAKE(sp_session_player_unload)
+FAKE(sp_session_playlistcontainer)
+FAKE(sp_session_preferred_bitrate)
+FAKE(sp_session_preferred_offline_bitrate)
+FAKE(sp_session_publishedcontainer_for_user_create)
+FAKE(sp_session_release)
+FAKE(sp_session_relogin)
+FAKE(sp_session_remembered_user)
+FAKE(sp_session_set_cache_size)
+FAKE(sp_session_set_connection_rules)
+FAKE(sp_session_set_connection_type)
+FAKE(sp_session_set_private_session)
+FAKE(sp_session_set_scrobbling)
+FAKE(sp_session_set_social_credentials)
+FAKE(sp_session_set_volume_normalization)
+FAKE(sp_session_starred_create)
+FAKE(sp_session_starred_for_user_create)
+FAKE(sp_session_user)
+FAKE(sp_toplistbrowse_album)
+FAKE(sp_toplistbrowse_artist)
+FAKE(sp_toplistbrowse_create)
+FAKE(sp_toplistbrowse_error)
+FAKE(sp_toplistbrowse_num_albums)
+FAKE(sp_toplistbrowse_num_artists)
+FAKE(sp_toplistbrowse_num_tracks)
+FAKE(sp_toplistbrowse_release)
+FAKE(sp_toplistbrowse_track)
+FAKE(sp_track_add_ref)
+FAKE(sp_track_album)
+FAKE(sp_track_artist)
+FAKE(sp_track_disc)
+FAKE(sp_track_duration)
+FAKE(sp_track_error)
+FAKE(sp_track_index)
+FAKE(sp_track_is_loaded)
+FAKE(sp_track_is_starred)
+FAKE(sp_track_name)
+FAKE(sp_track_num_artists)
+FAKE(sp_track_offline_get_status)
+FAKE(sp_track_popularity)
+FAKE(sp_track_release)
+FAKE(sp_track_set_starred)
+FAKE(sp_user_add_ref)
+FAKE(sp_user_canonical_name)
+FAKE(sp_user_display_name)
+FAKE(sp_user_is_loaded)
+FAKE(sp_user_release)
@@ -0,0 +1,30 @@
+#ifndef FAKESPOTIFY_H
+#define FAKESPOTIFY_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Number of tracks every playlist reports, sp_playlist_track() returns
+// fakespotify_handle(index)
+extern int fakespotify_playlist_tracks;
+
+// The sp_playlist_callbacks and userdata last passed to
+// sp_playlist_add_callbacks(), to play libspotify's part in tests
+extern const void *fakespotify_playlist_callbacks;
+extern void *fakespotify_playlist_userdata;
+
+// sp_link_create_from_playlist() and sp_link_as_string() give each
+// playlist handle the URI "spotify:fake:<handle in hex>".
+
+// Distinct non-null handles for tracks, albums etc. that are never
+// dereferenced; the same index always gives the same handle.
+static inline void *fakespotify_handle(int index) { return (void *)(((uintptr_t)index + 1) << 4); }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FAKESPOTIFY_H
@@ -0,0 +1,17 @@
+# Builds the library sources into the test against a fake libspotify,
+# see fakespotify.c. spotify_key.h and the libspotify headers are taken
+# from the same places as for the application.
+
+QT += testlib qml quick
+CONFIG += testcase
+
+include(../../libQtSpotify.pri)
+
+SOURCES := $$replace(SOURCES, ^\\.\\./libQtSpotify/, $$PWD/../../)
+HEADERS := $$replace(HEADERS, ^\\.\\./libQtSpotify/, $$PWD/../../)
+INCLUDEPATH := $$replace(INCLUDEPATH, ^\\.\\./, $$PWD/../../../)
+LIBS -= -lspotify
+
+INCLUDEPATH += $$PWD
+SOURCES += $$PWD/fakespotify.c
+HEADERS += $$PWD/fakespotify.h
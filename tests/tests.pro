@@ -0,0 +1,9 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    tst_qspotifycachemanager \
+    tst_qspotifyplaylist \
+    tst_qspotifyplaylisttreemodel \
+    bench_qspotifyobjectpool \
+    bench_qspotifycurrenttrack \
+    bench_qspotifyplaylistload
@@ -0,0 +1,185 @@
+#include <QtCore/QAtomicInt>
+#include <QtCore/QThread>
+#include <QtTest/QtTest>
+
+#include <libspotify/api.h>
+
+#include "fakespotify.h"
+#include "qspotifyalbum.h"
+#include "qspotifyartist.h"
+#include "qspotifycachemanager.h"
+#include "qspotifyevents.h"
+#include "qspotifyobjectpool.h"
+#include "qspotifysession.h"
+#include "qspotifytrack.h"
+
+namespace {
+
+const int Handles = 512;
+
+struct Counts {
+    int tracks;
+    int albums;
+    int artists;
+};
+
+Counts liveObjects()
+{
+    return { QSpotifyObjectPool<QSpotifyTrack>::stats().live,
+             QSpotifyObjectPool<QSpotifyAlbum>::stats().live,
+             QSpotifyObjectPool<QSpotifyArtist>::stats().live };
+}
+
+// Looks up random tracks, albums and artists, keeps a few of them and
+// releases them again in random order. Wrong objects being handed out are
+// counted in mismatches.
+class Worker : public QThread
+{
+public:
+    Worker(quint32 seed, int rounds, QAtomicInt *mismatches)
+        : m_seed(seed), m_rounds(rounds), m_mismatches(mismatches) { }
+
+    void step()
+    {
+        QSpotifyCacheManager &cache = QSpotifyCacheManager::instance();
+        int index = next() % Handles;
+        void *handle = fakespotify_handle(index);
+        switch (next() % 3) {
+        case 0: {
+            auto track = cache.getTrack(static_cast<sp_track *>(handle));
+            if (!track || track->sptrack() != handle)
+                m_mismatches->ref();
+            m_held.append(track);
+            break;
+        }
+        case 1: {
+            auto album = cache.getAlbum(static_cast<sp_album *>(handle));
+            if (!album || album->spalbum() != handle)
+                m_mismatches->ref();
+            m_held.append(album);
+            break;
+        }
+        default: {
+            auto artist = cache.getArtist(static_cast<sp_artist *>(handle));
+            if (!artist || artist->spartist() != handle)
+                m_mismatches->ref();
+            m_held.append(artist);
+            break;
+        }
+        }
+        if (m_held.size() > 32)
+            releaseOne();
+    }
+
+    void releaseAll()
+    {
+        while (!m_held.isEmpty())
+            releaseOne();
+    }
+
+protected:
+    void run()
+    {
+        for (int i = 0; i < m_rounds; ++i)
+            step();
+        releaseAll();
+    }
+
+private:
+    quint32 next()
+    {
+        m_seed = m_seed * 1103515245u + 12345u;
+        return m_seed >> 8;
+    }
+
+    void releaseOne()
+    {
+        QSpotifyObject *obj = m_held.takeAt(next() % m_held.size());
+        if (obj)
+            obj->release();
+    }
+
+    quint32 m_seed;
+    int m_rounds;
+    QAtomicInt *m_mismatches;
+    QList<QSpotifyObject *> m_held;
+};
+
+}
+
+class tst_QSpotifyCacheManager : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void stress_data();
+    void stress();
+};
+
+void tst_QSpotifyCacheManager::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    // Objects are created and destroyed on the session's thread
+    QVERIFY(QSpotifySession::instance()->isValid());
+}
+
+void tst_QSpotifyCacheManager::stress_data()
+{
+    QTest::addColumn<int>("maxRetained");
+
+    QTest::newRow("no retention") << 0;
+    QTest::newRow("evicting") << 64;
+    QTest::newRow("retaining all") << 3 * Handles;
+}
+
+// Workers race to create, revive and release the same objects while the
+// session's thread does the same and processes the destroy batches. Use
+// an ASan build to catch objects deleted while still referenced.
+void tst_QSpotifyCacheManager::stress()
+{
+    QFETCH(int, maxRetained);
+
+    QSpotifyCacheManager &cache = QSpotifyCacheManager::instance();
+    cache.setRetentionLimits(maxRetained, INT_MAX);
+    const Counts before = liveObjects();
+
+    QAtomicInt mismatches;
+    QList<Worker *> workers;
+    for (int i = 0; i < 8; ++i) {
+        workers.append(new Worker(i + 1, 20000, &mismatches));
+        workers.last()->start();
+    }
+
+    // Misses block the workers until this thread gets to them
+    Worker self(0, 0, &mismatches);
+    auto running = [&] {
+        for (Worker *worker : workers) {
+            if (!worker->isFinished())
+                return true;
+        }
+        return false;
+    };
+    while (running()) {
+        self.step();
+        QCoreApplication::processEvents();
+    }
+    self.releaseAll();
+    qDeleteAll(workers);
+
+    QCOMPARE(mismatches.load(), 0);
+
+    cache.clearRetained();
+    QCoreApplication::sendPostedEvents(QSpotifySession::instance(), DestroyObjectsEventType);
+    QCOMPARE(cache.retainedCount(), 0);
+    QCOMPARE(cache.statistics().value(QLatin1String("pendingDestroy")).toInt(), 0);
+
+    // Leaked objects stay alive, double frees drive the counts below
+    const Counts after = liveObjects();
+    QCOMPARE(after.tracks, before.tracks);
+    QCOMPARE(after.albums, before.albums);
+    QCOMPARE(after.artists, before.artists);
+}
+
+QTEST_MAIN(tst_QSpotifyCacheManager)
+
+#include "tst_qspotifycachemanager.moc"
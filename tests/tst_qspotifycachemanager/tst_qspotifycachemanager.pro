@@ -0,0 +1,5 @@
+TARGET = tst_qspotifycachemanager
+
+include(../shared/shared.pri)
+
+SOURCES += tst_qspotifycachemanager.cpp
@@ -0,0 +1,117 @@
+#include <QtTest/QtTest>
+
+#include <libspotify/api.h>
+
+#include "fakespotify.h"
+#include "qspotifycachemanager.h"
+#include "qspotifyevents.h"
+#include "qspotifyplaylist.h"
+#include "qspotifysession.h"
+#include "qspotifytracklist.h"
+
+namespace {
+
+sp_track *handle(int index)
+{
+    return static_cast<sp_track *>(fakespotify_handle(index));
+}
+
+const sp_playlist_callbacks *callbacks()
+{
+    return static_cast<const sp_playlist_callbacks *>(fakespotify_playlist_callbacks);
+}
+
+}
+
+// Starred lists show libspotify's positions 0, 1, 2 as rows 2, 1, 0;
+// changes reported by libspotify have to land on the right rows.
+class tst_QSpotifyPlaylist : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void starredRemoved();
+    void starredAdded();
+    void starredMoved();
+
+private:
+    QVector<sp_track *> rows() const;
+
+    sp_playlist *m_sp{};
+    QSpotifyPlaylist *m_playlist{};
+};
+
+void tst_QSpotifyPlaylist::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QVERIFY(QSpotifySession::instance()->isValid());
+    m_sp = static_cast<sp_playlist *>(fakespotify_handle(1000));
+}
+
+void tst_QSpotifyPlaylist::init()
+{
+    fakespotify_playlist_tracks = 3;
+    m_playlist = new QSpotifyPlaylist(QSpotifyPlaylist::Starred, m_sp, false);
+    m_playlist->init();
+    QVERIFY(callbacks());
+    QCOMPARE(fakespotify_playlist_userdata, static_cast<void *>(m_playlist));
+    QCOMPARE(rows(), QVector<sp_track *>() << handle(2) << handle(1) << handle(0));
+}
+
+void tst_QSpotifyPlaylist::cleanup()
+{
+    m_playlist->release();
+    m_playlist = nullptr;
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+    QCoreApplication::sendPostedEvents(QSpotifySession::instance(), DestroyObjectsEventType);
+}
+
+QVector<sp_track *> tst_QSpotifyPlaylist::rows() const
+{
+    QVector<sp_track *> result;
+    const QSpotifyTrackRecords &records = m_playlist->tracks()->records();
+    for (int row = 0; row < records.count(); ++row)
+        result.append(records.track(row));
+    return result;
+}
+
+void tst_QSpotifyPlaylist::starredRemoved()
+{
+    QVector<sp_track *> removed;
+    connect(m_playlist, &QSpotifyPlaylist::tracksRemoved, [&](QVector<sp_track *> tracks) { removed = tracks; });
+
+    const int positions[] = { 0 };
+    fakespotify_playlist_tracks = 2;
+    callbacks()->tracks_removed(m_sp, positions, 1, m_playlist);
+    QCoreApplication::sendPostedEvents(m_playlist);
+
+    QCOMPARE(removed, QVector<sp_track *>() << handle(0));
+    QCOMPARE(rows(), QVector<sp_track *>() << handle(2) << handle(1));
+}
+
+void tst_QSpotifyPlaylist::starredAdded()
+{
+    // Starring appends in libspotify, newest first in the rows
+    sp_track *const tracks[] = { handle(3) };
+    fakespotify_playlist_tracks = 4;
+    callbacks()->tracks_added(m_sp, tracks, 1, 3, m_playlist);
+    QCoreApplication::sendPostedEvents(m_playlist);
+
+    QCOMPARE(rows(), QVector<sp_track *>() << handle(3) << handle(2) << handle(1) << handle(0));
+}
+
+void tst_QSpotifyPlaylist::starredMoved()
+{
+    // Position 0 to the end: 1, 2, 0 in libspotify
+    const int positions[] = { 0 };
+    callbacks()->tracks_moved(m_sp, positions, 1, 3, m_playlist);
+    QCoreApplication::sendPostedEvents(m_playlist);
+
+    QCOMPARE(rows(), QVector<sp_track *>() << handle(0) << handle(2) << handle(1));
+}
+
+QTEST_MAIN(tst_QSpotifyPlaylist)
+
+#include "tst_qspotifyplaylist.moc"
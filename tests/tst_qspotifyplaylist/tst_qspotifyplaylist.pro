@@ -0,0 +1,5 @@
+TARGET = tst_qspotifyplaylist
+
+include(../shared/shared.pri)
+
+SOURCES += tst_qspotifyplaylist.cpp
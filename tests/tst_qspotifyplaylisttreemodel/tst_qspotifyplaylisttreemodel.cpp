@@ -0,0 +1,259 @@
+#include <QtTest/QtTest>
+#if QT_VERSION >= QT_VERSION_CHECK(5, 11, 0)
+#include <QtTest/QAbstractItemModelTester>
+#endif
+
+#include <libspotify/api.h>
+
+#include "fakespotify.h"
+#include "qspotifyplaylist.h"
+#include "qspotifyplaylistsnapshot.h"
+#include "qspotifysession.h"
+#include "listmodels/qspotifyplaylistflatmodel.h"
+#include "listmodels/qspotifyplaylisttreemodel.h"
+
+typedef QList<QSpotifyPlaylist *> Entries;
+
+// Playlists are matched with the snapshot by their fake URIs, the only
+// folder by its id 0. Nothing is ever loaded, so matched rows keep
+// showing their snapshot names.
+class tst_QSpotifyPlaylistTreeModel : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void changesWhileSnapshotShown();
+    void reconcile();
+    void entryMoved();
+
+private:
+    QSpotifyPlaylist *create(QSpotifyPlaylist::Type type);
+    QSpotifyPlaylistSnapshot::Entry entry(QSpotifyPlaylist *playlist, const QString &name) const;
+    // The snapshot: A, F { B, C }, D, E
+    void showSnapshot();
+    // Reordered, E removed and G added: D, F { C, B, G }, A
+    Entries reconciled() const;
+    QObject *playlistAt(const QModelIndex &idx) const;
+    QList<QObject *> flatPlaylists() const;
+    QStringList flatNames() const;
+
+    QSpotifyPlaylistTreeModel *m_tree{};
+    QSpotifyPlaylistFlatModel *m_flat{};
+    QSpotifyPlaylist *m_a{}, *m_b{}, *m_c{}, *m_d{}, *m_e{}, *m_g{};
+    QSpotifyPlaylist *m_folder{}, *m_folderEnd{};
+    Entries m_playlists;
+};
+
+void tst_QSpotifyPlaylistTreeModel::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QVERIFY(QSpotifySession::instance()->isValid());
+    fakespotify_playlist_tracks = 0;
+}
+
+void tst_QSpotifyPlaylistTreeModel::init()
+{
+    m_a = create(QSpotifyPlaylist::Playlist);
+    m_b = create(QSpotifyPlaylist::Playlist);
+    m_c = create(QSpotifyPlaylist::Playlist);
+    m_d = create(QSpotifyPlaylist::Playlist);
+    m_e = create(QSpotifyPlaylist::Playlist);
+    m_g = create(QSpotifyPlaylist::Playlist);
+    m_folder = create(QSpotifyPlaylist::Folder);
+    m_folderEnd = create(QSpotifyPlaylist::FolderEnd);
+
+    m_tree = new QSpotifyPlaylistTreeModel;
+    m_flat = new QSpotifyPlaylistFlatModel(m_tree);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 11, 0)
+    new QAbstractItemModelTester(m_tree, QAbstractItemModelTester::FailureReportingMode::QtTest, m_tree);
+    new QAbstractItemModelTester(m_flat, QAbstractItemModelTester::FailureReportingMode::QtTest, m_flat);
+#endif
+}
+
+void tst_QSpotifyPlaylistTreeModel::cleanup()
+{
+    delete m_flat;
+    delete m_tree;
+    for (QSpotifyPlaylist *playlist : m_playlists)
+        playlist->release();
+    m_playlists.clear();
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+}
+
+QSpotifyPlaylist *tst_QSpotifyPlaylistTreeModel::create(QSpotifyPlaylist::Type type)
+{
+    auto sp = static_cast<sp_playlist *>(fakespotify_handle(100 + m_playlists.count()));
+    auto playlist = new QSpotifyPlaylist(type, sp, false);
+    playlist->init();
+    m_playlists.append(playlist);
+    return playlist;
+}
+
+QSpotifyPlaylistSnapshot::Entry tst_QSpotifyPlaylistTreeModel::entry(QSpotifyPlaylist *playlist, const QString &name) const
+{
+    QSpotifyPlaylistSnapshot::Entry e;
+    e.key = QSpotifyPlaylistSnapshot::key(playlist);
+    e.type = playlist->type();
+    e.name = name;
+    return e;
+}
+
+void tst_QSpotifyPlaylistTreeModel::showSnapshot()
+{
+    QList<QSpotifyPlaylistSnapshot::Entry> entries;
+    entries << entry(m_a, "A") << entry(m_folder, "F") << entry(m_b, "B") << entry(m_c, "C")
+            << entry(m_folderEnd, QString()) << entry(m_d, "D") << entry(m_e, "E");
+    for (const auto &e : entries) {
+        if (e.type == QSpotifyPlaylist::Playlist)
+            QVERIFY(e.key.startsWith("spotify:fake:"));
+    }
+    m_tree->showSnapshot(entries);
+    QVERIFY(m_tree->isSnapshot());
+    QCOMPARE(flatNames(), QStringList() << "A" << "B" << "C" << "D" << "E");
+}
+
+Entries tst_QSpotifyPlaylistTreeModel::reconciled() const
+{
+    return Entries() << m_d << m_folder << m_c << m_b << m_g << m_folderEnd << m_a;
+}
+
+QObject *tst_QSpotifyPlaylistTreeModel::playlistAt(const QModelIndex &idx) const
+{
+    return idx.data(QSpotifyPlaylistTreeModel::PlaylistRole).value<QObject *>();
+}
+
+QList<QObject *> tst_QSpotifyPlaylistTreeModel::flatPlaylists() const
+{
+    QList<QObject *> result;
+    for (int row = 0; row < m_flat->rowCount(); ++row)
+        result.append(playlistAt(m_flat->index(row, 0)));
+    return result;
+}
+
+QStringList tst_QSpotifyPlaylistTreeModel::flatNames() const
+{
+    QStringList result;
+    for (int row = 0; row < m_flat->rowCount(); ++row)
+        result.append(m_flat->index(row, 0).data(QSpotifyPlaylistTreeModel::NameRole).toString());
+    return result;
+}
+
+// Until the container is loaded its entries are incomplete
+void tst_QSpotifyPlaylistTreeModel::changesWhileSnapshotShown()
+{
+    showSnapshot();
+    QSignalSpy inserted(m_tree, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    QSignalSpy removed(m_tree, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+    QSignalSpy reset(m_tree, SIGNAL(modelReset()));
+
+    m_tree->entryInserted(Entries() << m_g, 0);
+    m_tree->entryMoved(Entries() << m_g, 0);
+    m_tree->entryRemoved(Entries(), m_g);
+
+    QVERIFY(m_tree->isSnapshot());
+    QCOMPARE(inserted.count(), 0);
+    QCOMPARE(removed.count(), 0);
+    QCOMPARE(reset.count(), 0);
+    QCOMPARE(flatNames(), QStringList() << "A" << "B" << "C" << "D" << "E");
+    QCOMPARE(playlistAt(m_tree->index(0, 0)), static_cast<QObject *>(nullptr));
+}
+
+void tst_QSpotifyPlaylistTreeModel::reconcile()
+{
+    showSnapshot();
+    QPersistentModelIndex a = m_tree->index(0, 0);
+    QPersistentModelIndex folder = m_tree->index(1, 0);
+    QPersistentModelIndex b = m_tree->index(0, 0, folder);
+    QPersistentModelIndex e = m_tree->index(3, 0);
+    QPersistentModelIndex flatB = m_flat->index(1, 0);
+    QPersistentModelIndex flatE = m_flat->index(4, 0);
+
+    QSignalSpy treeInserted(m_tree, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    QSignalSpy treeRemoved(m_tree, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+    QSignalSpy treeMoved(m_tree, SIGNAL(rowsMoved(QModelIndex,int,int,QModelIndex,int)));
+    QSignalSpy treeReset(m_tree, SIGNAL(modelReset()));
+    QSignalSpy flatInserted(m_flat, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    QSignalSpy flatRemoved(m_flat, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+    QSignalSpy flatMoved(m_flat, SIGNAL(rowsMoved(QModelIndex,int,int,QModelIndex,int)));
+    QSignalSpy flatReset(m_flat, SIGNAL(modelReset()));
+
+    m_tree->reset(reconciled());
+    QVERIFY(!m_tree->isSnapshot());
+
+    // Only what changed: G inserted into the folder, E removed, the rest moved
+    QCOMPARE(treeReset.count(), 0);
+    QCOMPARE(treeInserted.count(), 1);
+    QCOMPARE(treeInserted.at(0).at(0).value<QModelIndex>(), QModelIndex(folder));
+    QCOMPARE(treeInserted.at(0).at(1).toInt(), 2);
+    QCOMPARE(treeRemoved.count(), 1);
+    QCOMPARE(treeRemoved.at(0).at(0).value<QModelIndex>(), QModelIndex());
+    QCOMPARE(treeRemoved.at(0).at(1).toInt(), 3);
+    QVERIFY(treeMoved.count() > 0);
+
+    QCOMPARE(m_tree->rowCount(), 3);
+    QCOMPARE(playlistAt(m_tree->index(0, 0)), static_cast<QObject *>(m_d));
+    QCOMPARE(playlistAt(m_tree->index(1, 0)), static_cast<QObject *>(m_folder));
+    QCOMPARE(playlistAt(m_tree->index(2, 0)), static_cast<QObject *>(m_a));
+    QCOMPARE(m_tree->rowCount(folder), 3);
+    QCOMPARE(playlistAt(m_tree->index(0, 0, folder)), static_cast<QObject *>(m_c));
+    QCOMPARE(playlistAt(m_tree->index(1, 0, folder)), static_cast<QObject *>(m_b));
+    QCOMPARE(playlistAt(m_tree->index(2, 0, folder)), static_cast<QObject *>(m_g));
+
+    // Matched rows were moved, not recreated
+    QCOMPARE(a.row(), 2);
+    QCOMPARE(playlistAt(a), static_cast<QObject *>(m_a));
+    QCOMPARE(b.row(), 1);
+    QCOMPARE(b.parent(), QModelIndex(folder));
+    QVERIFY(!e.isValid());
+    QCOMPARE(m_tree->indexOf(m_b), QModelIndex(b));
+    // Still the snapshot's names, G only has its own
+    QCOMPARE(b.data(QSpotifyPlaylistTreeModel::NameRole).toString(), QString("B"));
+
+    QCOMPARE(flatReset.count(), 0);
+    QCOMPARE(flatInserted.count(), 1);
+    QCOMPARE(flatRemoved.count(), 1);
+    QVERIFY(flatMoved.count() > 0);
+    QCOMPARE(flatPlaylists(), QList<QObject *>() << m_d << m_c << m_b << m_g << m_a);
+    QCOMPARE(flatNames(), QStringList() << "D" << "C" << "B" << QString() << "A");
+    QCOMPARE(flatB.row(), 2);
+    QVERIFY(!flatE.isValid());
+}
+
+void tst_QSpotifyPlaylistTreeModel::entryMoved()
+{
+    m_tree->reset(reconciled());
+    QVERIFY(!m_tree->isSnapshot());
+    QPersistentModelIndex a = m_tree->indexOf(m_a);
+    QPersistentModelIndex folder = m_tree->indexOf(m_folder);
+    QPersistentModelIndex flatA = m_flat->index(4, 0);
+    QCOMPARE(playlistAt(flatA), static_cast<QObject *>(m_a));
+
+    QSignalSpy treeMoved(m_tree, SIGNAL(rowsMoved(QModelIndex,int,int,QModelIndex,int)));
+    QSignalSpy treeReset(m_tree, SIGNAL(modelReset()));
+    QSignalSpy flatMoved(m_flat, SIGNAL(rowsMoved(QModelIndex,int,int,QModelIndex,int)));
+    QSignalSpy flatReset(m_flat, SIGNAL(modelReset()));
+
+    // A to the top of the folder: D, F { A, C, B, G }
+    m_tree->entryMoved(Entries() << m_d << m_folder << m_a << m_c << m_b << m_g << m_folderEnd, 2);
+
+    QCOMPARE(treeReset.count(), 0);
+    QCOMPARE(treeMoved.count(), 1);
+    QCOMPARE(treeMoved.at(0).at(0).value<QModelIndex>(), QModelIndex());
+    QCOMPARE(treeMoved.at(0).at(1).toInt(), 2);
+    QCOMPARE(treeMoved.at(0).at(3).value<QModelIndex>(), QModelIndex(folder));
+    QCOMPARE(treeMoved.at(0).at(4).toInt(), 0);
+    QCOMPARE(m_tree->rowCount(), 2);
+    QCOMPARE(a.parent(), QModelIndex(folder));
+    QCOMPARE(a.row(), 0);
+
+    QCOMPARE(flatReset.count(), 0);
+    QCOMPARE(flatMoved.count(), 1);
+    QCOMPARE(flatPlaylists(), QList<QObject *>() << m_d << m_a << m_c << m_b << m_g);
+    QCOMPARE(flatA.row(), 1);
+}
+
+QTEST_MAIN(tst_QSpotifyPlaylistTreeModel)
+
+#include "tst_qspotifyplaylisttreemodel.moc"
@@ -0,0 +1,5 @@
+TARGET = tst_qspotifyplaylisttreemodel
+
+include(../shared/shared.pri)
+
+SOURCES += tst_qspotifyplaylisttreemodel.cpp